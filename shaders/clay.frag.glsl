@@ -2,9 +2,9 @@
 
 layout (location = 0) out vec4 outColour;
 
-in vec3 position;
-in vec3 normal;
-in vec2 uv;
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 uv;
 
 
 void main() {
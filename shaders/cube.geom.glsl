@@ -0,0 +1,54 @@
+#version 450 core
+
+// fallback for drivers that can't write gl_Layer from the vertex stage
+// -- 1 invocation per cube face
+layout (triangles, invocations = 6) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+layout (location = 0) in vec3 vs_position[];
+layout (location = 1) in vec3 vs_normal[];
+layout (location = 2) in vec2 vs_uv[];
+layout (location = 3) flat in uint vs_faces[];  // CubeFaces the instance may touch
+
+layout (location = 0) out vec3 position;
+layout (location = 1) out vec3 normal;
+layout (location = 2) out vec2 uv;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+// Frame uniforms from shaders/frame.glsl
+
+
+void main() {
+    if (gl_InvocationID >= num_faces)
+        return;
+    int face = faces[gl_InvocationID / 4][gl_InvocationID % 4];
+    if (((vs_faces[0] >> face) & 1u) == 0u)
+        return;  // culled from this face on the CPU
+    vec4 clip[3];
+    for (int i = 0; i < 3; i++)
+        clip[i] = face_view_projection[face] * vec4(vs_position[i], 1.0);
+
+    // per-face culling: skip triangles entirely outside 1 side of the frustum
+    bvec4 outside = bvec4(true);
+    for (int i = 0; i < 3; i++) {
+        vec4 w = vec4(clip[i].w);
+        bvec4 corner_outside = lessThan(w + vec4(-clip[i].x, clip[i].x, -clip[i].y, clip[i].y), vec4(0));
+        outside = bvec4(ivec4(outside) & ivec4(corner_outside));
+    }
+    if (any(outside))
+        return;
+
+    for (int i = 0; i < 3; i++) {
+        position = vs_position[i];
+        normal = vs_normal[i];
+        uv = vs_uv[i];
+        gl_Position = clip[i];
+        gl_Layer = face;
+        gl_ViewportIndex = face;  // per face scissor
+        EmitVertex();
+    }
+    EndPrimitive();
+}
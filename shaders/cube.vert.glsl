@@ -0,0 +1,36 @@
+#version 450 core
+
+#ifdef PACKED_VERTEX
+// PackedVertex; see src/packed_vertex.h
+layout (location = 0) in vec3 vertexPosition;  // unorm16 across the mesh bounds
+layout (location = 1) in vec2 vertexNormal;    // octahedral, snorm16
+#else
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 1) in vec3 vertexNormal;
+#endif
+layout (location = 2) in vec2 vertexUv;  // half floats if packed
+// index into instance_transforms | CubeFaces it may touch << 24; see src/cull.h
+layout (location = 3) in uint vertexInstance;
+
+// faces are picked in cube.geom.glsl
+layout (location = 0) out vec3 vs_position;
+layout (location = 1) out vec3 vs_normal;
+layout (location = 2) out vec2 vs_uv;
+layout (location = 3) flat out uint vs_faces;  // CubeFaces the instance may touch; see src/cull.h
+
+
+// Frame uniforms, VERTEX_POSITION & VERTEX_NORMAL from shaders/frame.glsl
+
+// model -> world, per instance; Scene.instance_buffer
+layout (std430, binding = 1) readonly buffer Instances {
+    mat4 instance_transforms[];
+};
+
+
+void main() {
+    mat4 model = instance_transforms[vertexInstance & 0xFFFFFFu];
+    vs_position = (model * vec4(VERTEX_POSITION, 1.0)).xyz;
+    vs_normal = mat3(model) * VERTEX_NORMAL;
+    vs_uv = vertexUv;
+    vs_faces = vertexInstance >> 24;
+}
@@ -0,0 +1,63 @@
+#version 450 core
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+// gl_Layer from the vertex stage; either extension will do
+// NOTE: enable, not require; the one the driver lacks is only a warning
+// -- & #extension lines stay first, ahead of the ShaderManager's defines
+
+#ifdef PACKED_VERTEX
+// PackedVertex; see src/packed_vertex.h
+layout (location = 0) in vec3 vertexPosition;  // unorm16 across the mesh bounds
+layout (location = 1) in vec2 vertexNormal;    // octahedral, snorm16
+#else
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 1) in vec3 vertexNormal;
+#endif
+layout (location = 2) in vec2 vertexUv;  // half floats if packed
+// index into instance_transforms | the 1 CubeFace to draw it on << 24
+layout (location = 3) in uint vertexInstance;
+
+layout (location = 0) out vec3 position;
+layout (location = 1) out vec3 normal;
+layout (location = 2) out vec2 uv;
+
+// NOTE: redeclared for separable programs; see src/shader_manager.h
+// -- either extension puts gl_Layer (& gl_ViewportIndex) in the block
+out gl_PerVertex {
+    vec4 gl_Position;
+    float gl_CullDistance[4];
+    int gl_Layer;
+#if defined(GL_ARB_shader_viewport_layer_array)
+    int gl_ViewportIndex;
+#endif
+};
+
+// Frame uniforms, VERTEX_POSITION & VERTEX_NORMAL from shaders/frame.glsl
+
+// model -> world, per instance; Scene.instance_buffer
+layout (std430, binding = 1) readonly buffer Instances {
+    mat4 instance_transforms[];
+};
+
+
+void main() {
+    mat4 model = instance_transforms[vertexInstance & 0xFFFFFFu];
+    position = (model * vec4(VERTEX_POSITION, 1.0)).xyz;
+    normal = mat3(model) * VERTEX_NORMAL;
+    uv = vertexUv;
+
+    // 1 copy of each instance per face it's visible on
+    int face = findLSB(vertexInstance >> 24);
+    gl_Position = face_view_projection[face] * vec4(position, 1.0);
+    gl_Layer = face;
+#if defined(GL_ARB_shader_viewport_layer_array)
+    gl_ViewportIndex = face;  // per face scissor
+#endif
+
+    // per-face culling: triangles w/ every corner outside one side of this
+    // face's frustum are dropped before rasterisation
+    gl_CullDistance[0] = gl_Position.w - gl_Position.x;
+    gl_CullDistance[1] = gl_Position.w + gl_Position.x;
+    gl_CullDistance[2] = gl_Position.w - gl_Position.y;
+    gl_CullDistance[3] = gl_Position.w + gl_Position.y;
+}
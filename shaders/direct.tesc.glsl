@@ -0,0 +1,81 @@
+#version 450 core
+
+// subdivide each triangle so no edge segment spans more than tess_angle
+// -- Panini bends straight lines; only the new vertices land on the curve
+layout (vertices = 3) out;
+
+layout (location = 0) in vec3 vs_position[];
+layout (location = 1) in vec3 vs_normal[];
+layout (location = 2) in vec2 vs_uv[];
+
+layout (location = 0) out vec3 tc_position[];
+layout (location = 1) out vec3 tc_normal[];
+layout (location = 2) out vec2 tc_uv[];
+
+// Frame uniforms from shaders/frame.glsl
+
+
+// NOTE: keep in sync w/ direct.tese.glsl
+vec2 panini_plane(vec3 eye) {
+    float d = panini.x;
+    float r = max(length(eye.xz), 1e-6);
+    float sin_lon = eye.x / r;
+    float cos_lon = -eye.z / r;
+    float s = (d + 1) / (d + cos_lon);
+    float y_scale = max(mix(1 / s, cos_lon, panini.y), 1e-4);
+    return vec2(s * sin_lon, eye.y / r / y_scale);
+}
+
+
+float edge_level(vec3 a, vec3 b) {
+    float angle = acos(clamp(dot(normalize(a), normalize(b)), -1, 1));
+    return clamp(ceil(angle / tess_angle), 1, gl_MaxTessGenLevel);
+}
+
+
+// does edge a -> b pass behind the eye, where longitude wraps from +180 to -180?
+bool crosses_seam(vec3 a, vec3 b) {
+    if (a.x * b.x >= 0)
+        return false;
+    float t = a.x / (a.x - b.x);
+    return mix(a.z, b.z, t) > 0;
+}
+
+
+void main() {
+    tc_position[gl_InvocationID] = vs_position[gl_InvocationID];
+    tc_normal[gl_InvocationID] = vs_normal[gl_InvocationID];
+    tc_uv[gl_InvocationID] = vs_uv[gl_InvocationID];
+
+    if (gl_InvocationID != 0)
+        return;
+
+    // camera space; panini_plane & the seam are relative to the eye
+    vec3 p0 = (view * vec4(vs_position[0], 1.0)).xyz;
+    vec3 p1 = (view * vec4(vs_position[1], 1.0)).xyz;
+    vec3 p2 = (view * vec4(vs_position[2], 1.0)).xyz;
+
+    // cull: outside 1 side of the screen, or wrapping behind the eye
+    // NOTE: wrapping triangles can't be drawn w/o splitting; the cube path can
+    vec2 s0 = panini_plane(p0) / panini.zw;
+    vec2 s1 = panini_plane(p1) / panini.zw;
+    vec2 s2 = panini_plane(p2) / panini.zw;
+    bool offscreen = (s0.x > 1 && s1.x > 1 && s2.x > 1)
+                  || (s0.x < -1 && s1.x < -1 && s2.x < -1)
+                  || (s0.y > 1 && s1.y > 1 && s2.y > 1)
+                  || (s0.y < -1 && s1.y < -1 && s2.y < -1);
+    bool wraps = crosses_seam(p0, p1) || crosses_seam(p1, p2) || crosses_seam(p2, p0);
+    if (offscreen || wraps) {
+        gl_TessLevelOuter[0] = 0;
+        gl_TessLevelOuter[1] = 0;
+        gl_TessLevelOuter[2] = 0;
+        gl_TessLevelInner[0] = 0;
+        return;
+    }
+
+    // outer level i is the edge opposite vertex i
+    gl_TessLevelOuter[0] = edge_level(p1, p2);
+    gl_TessLevelOuter[1] = edge_level(p2, p0);
+    gl_TessLevelOuter[2] = edge_level(p0, p1);
+    gl_TessLevelInner[0] = max(gl_TessLevelOuter[0], max(gl_TessLevelOuter[1], gl_TessLevelOuter[2]));
+}
@@ -0,0 +1,53 @@
+#version 450 core
+
+// NOTE: ccw in the (u, v, w) domain emits triangles in the patch's own
+// vertex order, so glFrontFace(GL_CW) culling still works
+layout (triangles, equal_spacing, ccw) in;
+
+layout (location = 0) in vec3 tc_position[];
+layout (location = 1) in vec3 tc_normal[];
+layout (location = 2) in vec2 tc_uv[];
+
+layout (location = 0) out vec3 position;
+layout (location = 1) out vec3 normal;
+layout (location = 2) out vec2 uv;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+// Frame uniforms from shaders/frame.glsl
+
+
+// NOTE: keep in sync w/ direct.tesc.glsl
+// -- inverse of the mapping in panini_lut.comp.glsl & panini_direction in src/panini.c
+vec2 panini_plane(vec3 eye) {
+    float d = panini.x;
+    float r = max(length(eye.xz), 1e-6);
+    float sin_lon = eye.x / r;
+    float cos_lon = -eye.z / r;
+    float s = (d + 1) / (d + cos_lon);
+    float y_scale = max(mix(1 / s, cos_lon, panini.y), 1e-4);
+    return vec2(s * sin_lon, eye.y / r / y_scale);
+}
+
+
+// w is the distance to the eye; depth is hyperbolic in it, like a perspective matrix
+vec4 panini_projection(vec3 eye) {
+    float near = 0.1;
+    float far = 1024.0;
+    float dist = length(eye);
+    float z = (far + near) / (far - near) * dist - 2 * far * near / (far - near);
+    return vec4(panini_plane(eye) / panini.zw * dist, z, dist);
+}
+
+
+void main() {
+    vec3 b = gl_TessCoord;
+    position = b.x * tc_position[0] + b.y * tc_position[1] + b.z * tc_position[2];
+    normal = b.x * tc_normal[0] + b.y * tc_normal[1] + b.z * tc_normal[2];
+    uv = b.x * tc_uv[0] + b.y * tc_uv[1] + b.z * tc_uv[2];
+
+    // NOTE: view is affine, so transforming after interpolating is exact
+    gl_Position = panini_projection((view * vec4(position, 1.0)).xyz);
+}
@@ -0,0 +1,33 @@
+// shared by every scene shader; no #version
+// -- added after each stage's #version by the ShaderManager; see scene_defines
+
+// per frame uniforms; FrameUniforms in src/render_gl.h
+// NOTE: keep in sync w/ render_gl.h
+layout (std140, binding = 0) uniform Frame {
+    mat4 view;        // world -> camera
+    mat4 projection;  // 90deg fov on both axes
+    mat4 face_view_projection[6];  // world -> clip, per CubeFace
+    vec4 panini;      // d, compression, half width & half height
+    ivec4 faces[2];   // CubeFace of each used face; the first num_faces
+    int num_faces;
+    float tess_angle;  // max angle across a subdivided edge, in radians
+    vec4 position_offset;  // PACKED_VERTEX position decode
+    vec4 position_scale;
+};
+
+
+// vertex stages read attribs through these
+#ifdef PACKED_VERTEX
+// NOTE: same as octahedral_decode in src/packed_vertex.c
+vec3 decode_normal(vec2 e) {
+    vec3 n = vec3(e, 1 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0)));
+    return normalize(n);
+}
+#define VERTEX_POSITION  (position_offset.xyz + position_scale.xyz * vertexPosition)
+#define VERTEX_NORMAL    decode_normal(vertexNormal)
+#else
+#define VERTEX_POSITION  vertexPosition
+#define VERTEX_NORMAL    vertexNormal
+#endif
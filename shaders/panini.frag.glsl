@@ -0,0 +1,14 @@
+#version 450 core
+
+layout (location = 0) out vec4 outColour;
+
+layout (binding = 0) uniform samplerCube cube;
+// direction per pixel; baked by update_panini_lut (panini_lut.comp.glsl)
+layout (binding = 1) uniform sampler2D lut;
+
+
+void main() {
+    // NOTE: LUT is exactly the output resolution; no filtering
+    vec3 dir = texelFetch(lut, ivec2(gl_FragCoord.xy), 0).xyz;
+    outColour = texture(cube, dir);
+}
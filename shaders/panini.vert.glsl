@@ -0,0 +1,17 @@
+#version 450 core
+
+// [-1, +1] across the screen
+layout (location = 0) out vec2 screen;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+
+void main() {
+    // 1 triangle covering the screen, no vertex buffer
+    // -- clockwise, to match glFrontFace(GL_CW)
+    vec2 corner = vec2(gl_VertexID & 2, (gl_VertexID << 1) & 2);
+    screen = corner * 2 - 1;
+    gl_Position = vec4(screen, 0, 1);
+}
@@ -0,0 +1,27 @@
+#version 450 core
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+// 1 texel per output pixel; xyz = cube map direction
+layout (binding = 0, rgba16f) uniform writeonly image2D lut;
+// d, compression, half width & half height of the image plane
+layout (location = 0) uniform vec4 panini;
+
+
+// NOTE: same mapping as panini_column in src/panini.c; no trig
+void main() {
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(lut);
+    if (any(greaterThanEqual(pixel, size)))
+        return;  // partial group at the edge
+
+    vec2 screen = (vec2(pixel) + 0.5) / vec2(size) * 2 - 1;
+    float d = panini.x;
+    vec2 plane = screen * panini.zw;
+    float k = plane.x * plane.x / ((d + 1) * (d + 1));
+    float cos_lon = (-k * d + sqrt(max(1 + k * (1 - d * d), 0))) / (k + 1);
+    float inv_s = (d + cos_lon) / (d + 1);
+    float y_scale = mix(inv_s, cos_lon, panini.y);
+    vec3 dir = vec3(plane.x * inv_s, plane.y * y_scale, -cos_lon);
+    imageStore(lut, pixel, vec4(dir, 0));
+}
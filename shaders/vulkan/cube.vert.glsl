@@ -0,0 +1,69 @@
+#version 450 core
+// gl_Layer & gl_ViewportIndex from the vertex stage; Vulkan 1.2 shaderOutputLayer & shaderOutputViewportIndex
+#extension GL_ARB_shader_viewport_layer_array : require
+
+#ifdef PACKED_VERTEX
+// PackedVertex; see src/packed_vertex.h
+layout (location = 0) in vec3 vertexPosition;  // unorm16 across the mesh bounds
+layout (location = 1) in vec2 vertexNormal;    // octahedral, snorm16
+#else
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 1) in vec3 vertexNormal;
+#endif
+layout (location = 2) in vec2 vertexUv;  // half floats if packed
+// index into instance_transforms | the 1 CubeFace to draw it on << 24
+layout (location = 3) in uint vertexInstance;
+
+// into shaders/clay.frag.glsl, as is
+layout (location = 0) out vec3 position;
+layout (location = 1) out vec3 normal;
+layout (location = 2) out vec2 uv;
+
+// per frame uniforms; FrameUniforms in src/render_vulkan.h
+// NOTE: at a dynamic offset; 1 ring slot per frame in flight
+layout (std140, set = 0, binding = 0) uniform Frame {
+    mat4 face_view_projection[6];  // world -> clip (z in [0, w]), per CubeFace
+    vec4 position_offset;  // PACKED_VERTEX position decode
+    vec4 position_scale;
+};
+
+// model -> world, per instance; Scene.instance_buffer
+layout (std430, set = 0, binding = 1) readonly buffer Instances {
+    mat4 instance_transforms[];
+};
+
+
+#ifdef PACKED_VERTEX
+// NOTE: same as octahedral_decode in src/packed_vertex.c
+vec3 decode_normal(vec2 e) {
+    vec3 n = vec3(e, 1 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0)));
+    return normalize(n);
+}
+#define VERTEX_POSITION  (position_offset.xyz + position_scale.xyz * vertexPosition)
+#define VERTEX_NORMAL    decode_normal(vertexNormal)
+#else
+#define VERTEX_POSITION  vertexPosition
+#define VERTEX_NORMAL    vertexNormal
+#endif
+
+
+void main() {
+    mat4 model = instance_transforms[vertexInstance & 0xFFFFFFu];
+    position = (model * vec4(VERTEX_POSITION, 1.0)).xyz;
+    normal = mat3(model) * VERTEX_NORMAL;
+    uv = vertexUv;
+
+    // 1 copy of each instance per face it's visible on
+    int face = findLSB(vertexInstance >> 24);
+    gl_Position = face_view_projection[face] * vec4(position, 1.0);
+    gl_Layer = face;
+    gl_ViewportIndex = face;  // per face scissor
+
+    // per face culling; same planes as cube_layer.vert.glsl
+    gl_CullDistance[0] = gl_Position.w - gl_Position.x;
+    gl_CullDistance[1] = gl_Position.w + gl_Position.x;
+    gl_CullDistance[2] = gl_Position.w - gl_Position.y;
+    gl_CullDistance[3] = gl_Position.w + gl_Position.y;
+}
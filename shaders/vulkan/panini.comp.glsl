@@ -0,0 +1,31 @@
+#version 450 core
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (set = 0, binding = 0) uniform samplerCube cube;
+// rows top to bottom; blitted to the swapchain or copied out as is
+layout (set = 0, binding = 1, rgba8) uniform writeonly image2D outputImage;
+// d, compression, half width & half height of the image plane
+layout (push_constant) uniform Panini {
+    vec4 panini;
+};
+
+
+// NOTE: same mapping as panini_lut.comp.glsl, w/o the LUT in between
+void main() {
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(outputImage);
+    if (any(greaterThanEqual(pixel, size)))
+        return;  // partial group at the edge
+
+    vec2 screen = (vec2(pixel) + 0.5) / vec2(size) * 2 - 1;
+    screen.y = -screen.y;  // row 0 is the top
+    float d = panini.x;
+    vec2 plane = screen * panini.zw;
+    float k = plane.x * plane.x / ((d + 1) * (d + 1));
+    float cos_lon = (-k * d + sqrt(max(1 + k * (1 - d * d), 0))) / (k + 1);
+    float inv_s = (d + cos_lon) / (d + 1);
+    float y_scale = mix(inv_s, cos_lon, panini.y);
+    vec3 dir = vec3(plane.x * inv_s, plane.y * y_scale, -cos_lon);
+    imageStore(outputImage, pixel, textureLod(cube, dir, 0));
+}
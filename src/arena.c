@@ -0,0 +1,112 @@
+// Using C23 Standard
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+
+#define ARENA_ALIGN         16
+#define ARENA_HEADER_SIZE   ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define ARENA_DEFAULT_BLOCK (64 * 1024)
+
+
+static inline size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+
+static inline uint8_t *block_data(ArenaBlock *block) {
+    return (uint8_t*)block + ARENA_HEADER_SIZE;
+}
+
+
+void init_arena(Arena *arena, size_t reserve) {
+    arena->head = NULL;
+    arena->next_block_size = (reserve > 0) ? align_up(reserve) : ARENA_DEFAULT_BLOCK;
+}
+
+
+void free_arena(Arena *arena) {
+    ArenaBlock *block = arena->head;
+    while (block != NULL) {
+        ArenaBlock *prev = block->prev;
+        free(block);
+        block = prev;
+    }
+    arena->head = NULL;
+}
+
+
+static ArenaBlock *new_block(Arena *arena, size_t min_size) {
+    size_t size = arena->next_block_size;
+    while (size < min_size)
+        size *= 2;
+    ArenaBlock *block = malloc(ARENA_HEADER_SIZE + size);
+    if (block == NULL) {
+        fprintf(stderr, "arena out of memory (%zu bytes)\n", size);
+        return NULL;
+    }
+    block->prev = arena->head;
+    block->size = size;
+    block->used = 0;
+    arena->head = block;
+    arena->next_block_size = size * 2;
+    return block;
+}
+
+
+void *arena_alloc(Arena *arena, size_t size) {
+    size = align_up(size);
+    ArenaBlock *block = arena->head;
+    if (block == NULL || block->size - block->used < size) {
+        block = new_block(arena, size);
+        if (block == NULL)
+            return NULL;
+    }
+    void *ptr = block_data(block) + block->used;
+    block->used += size;
+    return ptr;
+}
+
+
+void *arena_resize(Arena *arena, void *ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL)
+        return arena_alloc(arena, new_size);
+    old_size = align_up(old_size);
+    new_size = align_up(new_size);
+    if (new_size <= old_size)
+        return ptr;
+    // last allocation in the newest block can grow in place
+    ArenaBlock *block = arena->head;
+    if (block != NULL
+     && (uint8_t*)ptr + old_size == block_data(block) + block->used
+     && block->size - block->used >= new_size - old_size) {
+        block->used += new_size - old_size;
+        return ptr;
+    }
+    // NOTE: the old allocation is abandoned until free_arena
+    void *new_ptr = arena_alloc(arena, new_size);
+    if (new_ptr == NULL)
+        return NULL;
+    memcpy(new_ptr, ptr, old_size);
+    return new_ptr;
+}
+
+
+int arena_grow(Arena *arena, void **array, int *max_count, int min_count, size_t stride) {
+    if (min_count <= *max_count)
+        return 0;
+    // NOTE: first allocation is exact, so pre-sized buffers don't waste space
+    size_t new_count = (*max_count > 0) ? *max_count : min_count;
+    while (new_count < (size_t)min_count)
+        new_count *= 2;
+    if (new_count > INT32_MAX)
+        return 1;  // counts are stored as int
+    void *new_array = arena_resize(arena, *array, *max_count * stride, new_count * stride);
+    if (new_array == NULL)
+        return 2;  // out of memory
+    *array = new_array;
+    *max_count = (int)new_count;
+    return 0;
+}
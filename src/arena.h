@@ -0,0 +1,33 @@
+// Using C23 Standard
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+// one malloc'd chunk of an arena
+typedef struct ArenaBlock_s {
+    struct ArenaBlock_s *prev;
+    size_t  size;  // bytes available after the header
+    size_t  used;
+} ArenaBlock;
+
+
+// bump allocator; everything in an arena is released by one free_arena
+// -- blocks double in size as the arena fills up
+typedef struct Arena_s {
+    ArenaBlock *head;  // newest block, allocations come from here
+    size_t      next_block_size;
+} Arena;
+
+
+// NOTE: reserve is a hint for the size of the first block (0 for default)
+void init_arena(Arena *arena, size_t reserve);
+void free_arena(Arena *arena);
+// NOTE: allocations are 16 byte aligned & not zeroed
+void *arena_alloc(Arena *arena, size_t size);
+// extends in place if ptr was the last allocation & fits, otherwise copies
+void *arena_resize(Arena *arena, void *ptr, size_t old_size, size_t new_size);
+// grow *array (of *max_count elements) to hold at least min_count elements
+// -- capacity doubles after the first allocation, so n appends cost O(n) copies
+int arena_grow(Arena *arena, void **array, int *max_count, int min_count, size_t stride);
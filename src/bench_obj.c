@@ -0,0 +1,160 @@
+// Using C23 Standard
+// POSIX (getrusage, fork)
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "geometry.h"
+#include "timing.h"
+
+
+// read_obj throughput; run on gen_obj output or real assets
+// -- reports the median of N runs, after 1 warm up run (page cache)
+
+
+#define MAX_RUNS  64
+
+
+typedef struct BenchOptions_s {
+    int         num_runs;
+    ObjOptions  obj;
+} BenchOptions;
+
+
+static double median(double *values, int count) {
+    sort_times(values, count);
+    return (count % 2 == 1)
+        ? values[count / 2]
+        : (values[count / 2 - 1] + values[count / 2]) * 0.5;
+}
+
+
+// NOTE: KiB on Linux, bytes on macOS; 0 w/o POSIX
+static long peak_rss_kib() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+
+int bench_file(char* path, BenchOptions *options) {
+    ObjStats stats;
+    options->obj.stats = &stats;
+
+    double map[MAX_RUNS], prescan[MAX_RUNS], parse[MAX_RUNS];
+    double merge[MAX_RUNS], emit[MAX_RUNS], total[MAX_RUNS];
+    int num_vertices = 0;
+    for (int i = -1; i < options->num_runs; i++) {
+        Arena arena;
+        init_arena(&arena, 0);
+        Geometry geo = {
+            .num_vertices = 0,
+            .max_vertices = 0,
+            .num_indices = 0,
+            .max_indices = 0,
+            .vertices = NULL,
+            .indices = NULL,
+            .arena = &arena,
+            .num_lods = 0};
+        int result = read_obj_options(path, &options->obj, &geo);
+        num_vertices = geo.num_vertices;
+        free_arena(&arena);
+        if (result != 0) {
+            fprintf(stderr, "%s: parse failed\n", path);
+            return 1;
+        }
+        if (i < 0)
+            continue;  // warm up
+        map[i] = stats.map;
+        prescan[i] = stats.prescan;
+        parse[i] = stats.parse;
+        merge[i] = stats.merge;
+        emit[i] = stats.emit;
+        total[i] = stats.total;
+    }
+
+    int n = options->num_runs;
+    double seconds = median(total, n);
+    double megabytes = stats.file_length / (1024.0 * 1024.0);
+    printf("%-32s %8.1f %10d %10d %3d %8.1f %8.2f %8ld | %7.1f %7.1f %7.1f %7.1f %7.1f %7.1f\n",
+        path, megabytes, stats.num_faces, num_vertices, stats.num_threads,
+        megabytes / seconds, stats.num_faces / seconds * 1e-6,
+        peak_rss_kib() / 1024,
+        median(map, n) * 1e3, median(prescan, n) * 1e3, median(parse, n) * 1e3,
+        median(merge, n) * 1e3, median(emit, n) * 1e3, seconds * 1e3);
+    return 0;
+}
+
+
+void print_usage(char* argv_0) {
+    printf("usage: %s [--runs N] [--weld] [--threads N] folder/file.obj ...\n", argv_0);
+    printf("    --runs N      timed runs per file, median is reported (default 5)\n");
+    printf("    --weld        deduplicate (v, vt, vn) corners\n");
+    printf("    --threads N   parser threads (0 = 1 per core, 1 = serial)\n");
+}
+
+
+int main(int argc, char* argv[]) {
+    BenchOptions options = {
+        .num_runs = 5,
+        .obj = {.weld = false, .optimise = false, .lods = 0, .num_threads = 0, .stats = NULL, .cancel = NULL}};
+    int first_path = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            options.num_runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--weld") == 0) {
+            options.obj.weld = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.obj.num_threads = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            first_path = i;
+            break;
+        } else {
+            break;
+        }
+    }
+    if (first_path == 0 || options.num_runs < 1 || options.num_runs > MAX_RUNS) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    printf("%-32s %8s %10s %10s %3s %8s %8s %8s | %7s %7s %7s %7s %7s %7s\n",
+        "file", "MB", "faces", "vertices", "thr", "MB/s", "Mface/s", "RSS MB",
+        "map", "prescan", "parse", "merge", "emit", "total");
+    printf("%-32s %8s %10s %10s %3s %8s %8s %8s | %47s\n",
+        "", "", "", "", "", "", "", "peak", "median ms");
+
+    int failures = 0;
+    for (int i = first_path; i < argc; i++) {
+#ifndef _WIN32
+        // NOTE: 1 process per file, so peak RSS isn't carried over from bigger files
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+            exit(bench_file(argv[i], &options));
+        int status = 1;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failures++;
+#else
+        if (bench_file(argv[i], &options) != 0)
+            failures++;
+#endif
+    }
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+// Using C23 Standard
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bvh.h"
+
+
+Aabb Aabb_empty() {
+    return (Aabb){
+        .min = {FLT_MAX, FLT_MAX, FLT_MAX},
+        .max = {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+}
+
+
+Aabb Aabb_union(Aabb a, Aabb b) {
+    return (Aabb){
+        .min = {
+            (a.min.x < b.min.x) ? a.min.x : b.min.x,
+            (a.min.y < b.min.y) ? a.min.y : b.min.y,
+            (a.min.z < b.min.z) ? a.min.z : b.min.z},
+        .max = {
+            (a.max.x > b.max.x) ? a.max.x : b.max.x,
+            (a.max.y > b.max.y) ? a.max.y : b.max.y,
+            (a.max.z > b.max.z) ? a.max.z : b.max.z}};
+}
+
+
+Aabb Aabb_transform(const Mat4 *m, Aabb box) {
+    // centre & half extents (Arvo); the extents go through |m|
+    float centre[3] = {
+        (box.min.x + box.max.x) * 0.5f,
+        (box.min.y + box.max.y) * 0.5f,
+        (box.min.z + box.max.z) * 0.5f};
+    float extent[3] = {
+        (box.max.x - box.min.x) * 0.5f,
+        (box.max.y - box.min.y) * 0.5f,
+        (box.max.z - box.min.z) * 0.5f};
+    float out_centre[3], out_extent[3];
+    for (int row = 0; row < 3; row++) {
+        out_centre[row] = m->m[3][row];
+        out_extent[row] = 0.0f;
+        for (int col = 0; col < 3; col++) {
+            float a = m->m[col][row];
+            out_centre[row] += a * centre[col];
+            out_extent[row] += ((a < 0.0f) ? -a : a) * extent[col];
+        }
+    }
+    return (Aabb){
+        .min = {out_centre[0] - out_extent[0], out_centre[1] - out_extent[1], out_centre[2] - out_extent[2]},
+        .max = {out_centre[0] + out_extent[0], out_centre[1] + out_extent[1], out_centre[2] + out_extent[2]}};
+}
+
+
+// 0 for empty boxes
+static float surface_area(Aabb box) {
+    float dx = box.max.x - box.min.x;
+    float dy = box.max.y - box.min.y;
+    float dz = box.max.z - box.min.z;
+    if (dx < 0.0f || dy < 0.0f || dz < 0.0f)
+        return 0.0f;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+
+typedef struct BvhBuild_s {
+    Bvh   *bvh;
+    Aabb  *bounds;     // per item
+    Vec3  *centroids;  // per item
+} BvhBuild;
+
+
+// NOTE: binning & partitioning must agree exactly, so both use this
+static inline int bin_index(Vec3 centroid, int axis, float min, float scale) {
+    int bin = (int)(((&centroid.x)[axis] - min) * scale);
+    return (bin < 0) ? 0 : (bin >= BVH_BINS) ? BVH_BINS - 1 : bin;
+}
+
+
+static void build_node(BvhBuild *build, int index, int first, int count, int depth) {
+    Bvh *bvh = build->bvh;
+    BvhNode *node = &bvh->nodes[index];
+    Aabb bounds = Aabb_empty();
+    Aabb centroid_bounds = Aabb_empty();
+    for (int i = first; i < first + count; i++) {
+        int item = bvh->items[i];
+        bounds = Aabb_union(bounds, build->bounds[item]);
+        Vec3 c = build->centroids[item];
+        centroid_bounds = Aabb_union(centroid_bounds, (Aabb){c, c});
+    }
+    node->bounds = bounds;
+    node->first = first;
+    node->count = count;
+    if (count <= BVH_MAX_LEAF || depth >= BVH_MAX_DEPTH)
+        return;
+
+    // binned SAH; cost of a split is sum(area * items) over both sides
+    float best_cost = FLT_MAX;
+    int best_axis = -1;
+    int best_split = 0;  // bins <= best_split go left
+    for (int axis = 0; axis < 3; axis++) {
+        float min = (&centroid_bounds.min.x)[axis];
+        float max = (&centroid_bounds.max.x)[axis];
+        if (max <= min)
+            continue;  // flat; nothing to split
+        float scale = BVH_BINS / (max - min);
+        Aabb bin_bounds[BVH_BINS];
+        int bin_counts[BVH_BINS];
+        for (int b = 0; b < BVH_BINS; b++) {
+            bin_bounds[b] = Aabb_empty();
+            bin_counts[b] = 0;
+        }
+        for (int i = first; i < first + count; i++) {
+            int item = bvh->items[i];
+            int b = bin_index(build->centroids[item], axis, min, scale);
+            bin_bounds[b] = Aabb_union(bin_bounds[b], build->bounds[item]);
+            bin_counts[b]++;
+        }
+        // sweep right to left, then left to right
+        float right_area[BVH_BINS];
+        int right_count[BVH_BINS];
+        Aabb sweep = Aabb_empty();
+        int swept = 0;
+        for (int b = BVH_BINS - 1; b > 0; b--) {
+            sweep = Aabb_union(sweep, bin_bounds[b]);
+            swept += bin_counts[b];
+            right_area[b] = surface_area(sweep);
+            right_count[b] = swept;
+        }
+        sweep = Aabb_empty();
+        swept = 0;
+        for (int b = 0; b < BVH_BINS - 1; b++) {
+            sweep = Aabb_union(sweep, bin_bounds[b]);
+            swept += bin_counts[b];
+            if (swept == 0 || right_count[b + 1] == 0)
+                continue;
+            float cost = swept * surface_area(sweep) + right_count[b + 1] * right_area[b + 1];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = b;
+            }
+        }
+    }
+    if (best_axis == -1)
+        return;  // every centroid coincides; 1 big leaf
+
+    // partition items in place
+    float min = (&centroid_bounds.min.x)[best_axis];
+    float scale = BVH_BINS / ((&centroid_bounds.max.x)[best_axis] - min);
+    int left = first;
+    int right = first + count - 1;
+    while (left <= right) {
+        if (bin_index(build->centroids[bvh->items[left]], best_axis, min, scale) <= best_split) {
+            left++;
+        } else {
+            int swap = bvh->items[left];
+            bvh->items[left] = bvh->items[right];
+            bvh->items[right--] = swap;
+        }
+    }
+    int left_count = left - first;
+
+    int child = bvh->num_nodes;
+    bvh->num_nodes += 2;
+    node->first = child;
+    node->count = 0;
+    build_node(build, child, first, left_count, depth + 1);
+    build_node(build, child + 1, left, count - left_count, depth + 1);
+}
+
+
+int build_bvh(Bvh *bvh, int num_items, Aabb *bounds) {
+    *bvh = (Bvh){0};
+    if (num_items == 0)
+        return 0;
+    // NOTE: a binary tree w/ n leaves has 2n - 1 nodes; every leaf has >= 1 item
+    bvh->nodes = malloc(sizeof(BvhNode) * (2 * num_items - 1));
+    bvh->items = malloc(sizeof(int) * num_items);
+    Vec3 *centroids = malloc(sizeof(Vec3) * num_items);
+    if (bvh->nodes == NULL || bvh->items == NULL || centroids == NULL) {
+        fprintf(stderr, "out of memory for a BVH of %d items\n", num_items);
+        free(centroids);
+        free_bvh(bvh);
+        return 1;
+    }
+    for (int i = 0; i < num_items; i++) {
+        bvh->items[i] = i;
+        centroids[i] = (Vec3){
+            (bounds[i].min.x + bounds[i].max.x) * 0.5f,
+            (bounds[i].min.y + bounds[i].max.y) * 0.5f,
+            (bounds[i].min.z + bounds[i].max.z) * 0.5f};
+    }
+    bvh->num_items = num_items;
+    bvh->num_nodes = 1;
+
+    BvhBuild build = {.bvh = bvh, .bounds = bounds, .centroids = centroids};
+    build_node(&build, 0, 0, num_items, 0);
+    free(centroids);
+    return 0;
+}
+
+
+void free_bvh(Bvh *bvh) {
+    free(bvh->nodes);
+    free(bvh->items);
+    *bvh = (Bvh){0};
+}
@@ -0,0 +1,48 @@
+// Using C23 Standard
+#pragma once
+
+#include "matrix.h"
+#include "vector.h"
+
+
+// axis aligned bounding box
+typedef struct Aabb_s {
+    Vec3  min;
+    Vec3  max;
+} Aabb;
+
+
+// nodes are 32 bytes; 2 per cache line
+typedef struct BvhNode_s {
+    Aabb  bounds;
+    int   first;  // inner: left child (right is first + 1); leaf: into Bvh.items
+    int   count;  // items in a leaf; 0 for inner nodes
+} BvhNode;
+
+
+// bounding volume hierarchy over any list of Aabbs (e.g. scene instances)
+// -- binned SAH build; nodes[0] is the root
+typedef struct Bvh_s {
+    int       num_nodes;
+    BvhNode  *nodes;
+    int       num_items;
+    int      *items;  // item indices, in leaf order
+} Bvh;
+
+
+// leaves hold at most this many items, unless their centroids coincide
+#define BVH_MAX_LEAF   4
+// SAH bins per axis
+#define BVH_BINS       16
+// deeper subtrees are cut off into leaves; keeps traversal stacks fixed size
+#define BVH_MAX_DEPTH  48
+
+
+Aabb Aabb_empty();
+Aabb Aabb_union(Aabb a, Aabb b);
+// box around m * box; exact for the box's corners, loose for what's inside
+Aabb Aabb_transform(const Mat4 *m, Aabb box);
+
+// 0 on success, 1 if out of memory
+int build_bvh(Bvh *bvh, int num_items, Aabb *bounds);
+void free_bvh(Bvh *bvh);
@@ -14,20 +14,8 @@ void init_camera(Camera *camera) {
 }
 
 
-// TODO: perspective view matrix (to multiply against camera)
-/*
-    mat4 view_matrix;
-    float near = 0.1;
-    float far = 1024.0;
-    float r = far - near;
-    float a = -far / r;
-    float b = -far * near / r;
-    // NOTE: 90deg fov on both axes, best for square viewport (cube texture)
-    view_matrix[0] = vec4(1, 0, 0,  0);
-    view_matrix[1] = vec4(0, 1, 0,  0);
-    view_matrix[2] = vec4(0, 0, a, -1);
-    view_matrix[3] = vec4(0, 0, b,  0);
-*/
+// NOTE: projection is Mat4_perspective(90, 1, 0.1, 1024) for cube map faces
+// -- 90deg fov on both axes, best for square viewport (cube texture)
 
 
 // TODO: SDL2 events -> InputState {left_stick, right_stick};
@@ -35,24 +23,21 @@ void init_camera(Camera *camera) {
 // -- camera.forward + left_stick -> wish
 
 
-void update_matrix(Camera camera, float *matrix[4][4]) {
-    *matrix[0][0] = camera.right.x;
-    *matrix[0][1] = camera.right.y;
-    *matrix[0][2] = camera.right.z;
-    *matrix[0][3] = 0;
-
-    *matrix[1][0] = camera.up.x;
-    *matrix[1][1] = camera.up.y;
-    *matrix[1][2] = camera.up.z;
-    *matrix[1][3] = 0;
+void update_matrix(Camera *camera, Mat4 *matrix) {
+    Vec3 columns[4] = {camera->right, camera->up, camera->forward, camera->position};
+    for (int i = 0; i < 4; i++) {
+        matrix->m[i][0] = columns[i].x;
+        matrix->m[i][1] = columns[i].y;
+        matrix->m[i][2] = columns[i].z;
+        matrix->m[i][3] = i == 3 ? 1 : 0;
+    }
+}
 
-    *matrix[2][0] = camera.forward.x;
-    *matrix[2][1] = camera.forward.y;
-    *matrix[2][2] = camera.forward.z;
-    *matrix[2][3] = 0;
 
-    *matrix[3][0] = camera.position.x;
-    *matrix[3][1] = camera.position.y;
-    *matrix[3][2] = camera.position.z;
-    *matrix[3][3] = 1;
+void update_view_matrix(Camera *camera, Mat4 *matrix) {
+    Vec3 target = {
+        camera->position.x + camera->forward.x,
+        camera->position.y + camera->forward.y,
+        camera->position.z + camera->forward.z};
+    *matrix = Mat4_look_at(camera->position, target, camera->up);
 }
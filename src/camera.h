@@ -1,6 +1,7 @@
 // Using C23 Standard
 #pragma once
 
+#include "matrix.h"
 #include "vector.h"
 
 
@@ -10,9 +11,9 @@ typedef struct Camera_s {
 } Camera;
 
 
-// TODO: mat4 type
-
-
 void init_camera(Camera *camera);
 // void update_camera(Vec2 left_stick, Vec2 right_stick, Camera *camera);
-void update_matrix(Camera camera, float *matrix[4][4]);
+// camera -> world; columns are right, up, forward & position
+void update_matrix(Camera *camera, Mat4 *matrix);
+// world -> view (GL; looking down -Z), for Mat4_perspective
+void update_view_matrix(Camera *camera, Mat4 *matrix);
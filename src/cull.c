@@ -0,0 +1,197 @@
+// Using C23 Standard
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "cull.h"
+
+
+void cube_frusta(CubeFrusta *frusta, const Mat4 face_view_projection[6], int faces, const int scissors[6][4], int size, Vec3 eye, float far) {
+    for (int face = 0; face < 6; face++) {
+        float *x = frusta->x[face];
+        float *y = frusta->y[face];
+        float *z = frusta->z[face];
+        float *w = frusta->w[face];
+        if (!(faces >> face & 1)) {
+            // 0 >= 1 is never true; outside, whatever the box
+            for (int i = 0; i < 4; i++) {
+                x[i] = y[i] = z[i] = 0.0f;
+                w[i] = -1.0f;
+            }
+            continue;
+        }
+        // scissor -> NDC; left, right, bottom & top
+        const int *scissor = scissors[face];
+        float l = 2.0f * scissor[0] / size - 1.0f;
+        float r = 2.0f * (scissor[0] + scissor[2]) / size - 1.0f;
+        float b = 2.0f * scissor[1] / size - 1.0f;
+        float t = 2.0f * (scissor[1] + scissor[3]) / size - 1.0f;
+        // Gribb & Hartmann; clip x >= l * w etc. as planes on the rows of m
+        const Mat4 *m = &face_view_projection[face];
+        for (int col = 0; col < 4; col++) {
+            float row_x = m->m[col][0];
+            float row_y = m->m[col][1];
+            float row_w = m->m[col][3];
+            float planes[4] = {
+                row_x - l * row_w,
+                r * row_w - row_x,
+                row_y - b * row_w,
+                t * row_w - row_y};
+            float *dest = (col == 0) ? x : (col == 1) ? y : (col == 2) ? z : w;
+            for (int i = 0; i < 4; i++)
+                dest[i] = planes[i];
+        }
+    }
+    frusta->faces = faces;
+    frusta->eye = eye;
+    frusta->far = far;
+}
+
+
+int cull_box(const CubeFrusta *frusta, const Aabb *box, int mask, int *inside) {
+    float c[3] = {
+        (box->min.x + box->max.x) * 0.5f,
+        (box->min.y + box->max.y) * 0.5f,
+        (box->min.z + box->max.z) * 0.5f};
+    float e[3] = {
+        (box->max.x - box->min.x) * 0.5f,
+        (box->max.y - box->min.y) * 0.5f,
+        (box->max.z - box->min.z) * 0.5f};
+
+    // far; the nearest & furthest points of the box from the eye
+    const float *eye = &frusta->eye.x;
+    float near_sq = 0.0f;
+    float far_sq = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float d = c[i] - eye[i];
+        d = (d < 0.0f) ? -d : d;
+        float nearest = (d > e[i]) ? d - e[i] : 0.0f;
+        near_sq += nearest * nearest;
+        far_sq += (d + e[i]) * (d + e[i]);
+    }
+    float far_limit = frusta->far * frusta->far;
+    *inside = 0;
+    if (near_sq > far_limit)
+        return 0;
+
+    // per plane: centre distance +/- the box's projected radius
+    // -- outside if distance + radius < 0; inside if distance - radius >= 0
+    // -- 4 bits (planes) per face in each mask
+    int outside_bits = 0;
+    int inside_bits = 0;
+#if defined(__AVX__)
+    __m256 cx = _mm256_set1_ps(c[0]), cy = _mm256_set1_ps(c[1]), cz = _mm256_set1_ps(c[2]);
+    __m256 ex = _mm256_set1_ps(e[0]), ey = _mm256_set1_ps(e[1]), ez = _mm256_set1_ps(e[2]);
+    __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 zero = _mm256_setzero_ps();
+    for (int face = 0; face < 6; face += 2) {
+        __m256 x = _mm256_load_ps(frusta->x[face]);
+        __m256 y = _mm256_load_ps(frusta->y[face]);
+        __m256 z = _mm256_load_ps(frusta->z[face]);
+        __m256 distance = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(x, cx), _mm256_mul_ps(y, cy)),
+            _mm256_add_ps(_mm256_mul_ps(z, cz), _mm256_load_ps(frusta->w[face])));
+        __m256 radius = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(_mm256_andnot_ps(sign, x), ex), _mm256_mul_ps(_mm256_andnot_ps(sign, y), ey)),
+            _mm256_mul_ps(_mm256_andnot_ps(sign, z), ez));
+        outside_bits |= _mm256_movemask_ps(_mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_LT_OQ)) << (face * 4);
+        inside_bits |= _mm256_movemask_ps(_mm256_cmp_ps(_mm256_sub_ps(distance, radius), zero, _CMP_GE_OQ)) << (face * 4);
+    }
+#elif defined(__SSE2__)
+    __m128 cx = _mm_set1_ps(c[0]), cy = _mm_set1_ps(c[1]), cz = _mm_set1_ps(c[2]);
+    __m128 ex = _mm_set1_ps(e[0]), ey = _mm_set1_ps(e[1]), ez = _mm_set1_ps(e[2]);
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 zero = _mm_setzero_ps();
+    for (int face = 0; face < 6; face++) {
+        __m128 x = _mm_load_ps(frusta->x[face]);
+        __m128 y = _mm_load_ps(frusta->y[face]);
+        __m128 z = _mm_load_ps(frusta->z[face]);
+        __m128 distance = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(x, cx), _mm_mul_ps(y, cy)),
+            _mm_add_ps(_mm_mul_ps(z, cz), _mm_load_ps(frusta->w[face])));
+        __m128 radius = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign, x), ex), _mm_mul_ps(_mm_andnot_ps(sign, y), ey)),
+            _mm_mul_ps(_mm_andnot_ps(sign, z), ez));
+        outside_bits |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), zero)) << (face * 4);
+        inside_bits |= _mm_movemask_ps(_mm_cmpge_ps(_mm_sub_ps(distance, radius), zero)) << (face * 4);
+    }
+#else
+    for (int face = 0; face < 6; face++) {
+        for (int i = 0; i < 4; i++) {
+            float x = frusta->x[face][i];
+            float y = frusta->y[face][i];
+            float z = frusta->z[face][i];
+            // NOTE: same order of operations as the SIMD paths
+            float distance = (x * c[0] + y * c[1]) + (z * c[2] + frusta->w[face][i]);
+            float radius = ((x < 0 ? -x : x) * e[0] + (y < 0 ? -y : y) * e[1]) + (z < 0 ? -z : z) * e[2];
+            outside_bits |= (distance + radius < 0.0f) << (face * 4 + i);
+            inside_bits |= (distance - radius >= 0.0f) << (face * 4 + i);
+        }
+    }
+#endif
+
+    int visible = 0;
+    int contained = 0;
+    mask &= frusta->faces;
+    for (int face = 0; face < 6; face++) {
+        if (!(mask >> face & 1))
+            continue;
+        if ((outside_bits >> (face * 4) & 0xF) == 0)
+            visible |= 1 << face;
+        if ((inside_bits >> (face * 4) & 0xF) == 0xF)
+            contained |= 1 << face;
+    }
+    *inside = (far_sq <= far_limit) ? contained : 0;
+    return visible;
+}
+
+
+typedef struct CullEntry_s {
+    int  node;
+    int  faces;   // the node may touch these
+    int  inside;  // & is entirely within these; no need to test them again
+} CullEntry;
+
+
+int cull_bvh(const Bvh *bvh, const Aabb *item_bounds, const CubeFrusta *frusta, uint32_t *visible) {
+    if (bvh->num_nodes == 0 || frusta->faces == 0)
+        return 0;
+    // NOTE: depth first; 1 pending sibling per level at most
+    CullEntry stack[BVH_MAX_DEPTH + 2];
+    int top = 0;
+    stack[top++] = (CullEntry){.node = 0, .faces = frusta->faces, .inside = 0};
+    int num_visible = 0;
+    while (top > 0) {
+        CullEntry entry = stack[--top];
+        const BvhNode *node = &bvh->nodes[entry.node];
+        int faces = entry.faces;
+        int inside = entry.inside;
+        if (faces != inside) {
+            int new_inside;
+            faces = inside | cull_box(frusta, &node->bounds, faces & ~inside, &new_inside);
+            inside |= new_inside;
+            if (faces == 0)
+                continue;
+        }
+
+        if (node->count == 0) {
+            stack[top++] = (CullEntry){.node = node->first + 1, .faces = faces, .inside = inside};
+            stack[top++] = (CullEntry){.node = node->first, .faces = faces, .inside = inside};
+            continue;
+        }
+        for (int i = node->first; i < node->first + node->count; i++) {
+            int item = bvh->items[i];
+            int item_faces = faces;
+            if (faces != inside) {
+                int item_inside;
+                item_faces = inside | cull_box(frusta, &item_bounds[item], faces & ~inside, &item_inside);
+            }
+            if (item_faces != 0)
+                visible[num_visible++] = (uint32_t)item | (uint32_t)item_faces << CULL_FACE_SHIFT;
+        }
+    }
+    return num_visible;
+}
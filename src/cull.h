@@ -0,0 +1,42 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdint.h>
+
+#include "bvh.h"
+#include "matrix.h"
+#include "vector.h"
+
+
+// side planes of every cube face's frustum; 4 per face: left, right, bottom & top
+// -- SoA, so 1 SSE register holds 1 face's planes (2 faces per AVX register)
+// -- p is inside a plane if x * p.x + y * p.y + z * p.z + w >= 0
+// NOTE: unnormalised; sign tests don't need unit normals
+// NOTE: SSE2 & AVX paths if the compiler targets them, scalar otherwise
+typedef struct CubeFrusta_s {
+    alignas(32) float x[6][4];
+    alignas(32) float y[6][4];
+    alignas(32) float z[6][4];
+    alignas(32) float w[6][4];
+    int    faces;  // mask of CubeFaces; the rest never see anything
+    Vec3   eye;
+    float  far;  // boxes further than this from eye are culled from every face
+} CubeFrusta;
+
+
+// cull_bvh's output; an item index & the CubeFaces it may touch
+#define CULL_FACE_SHIFT  24
+#define CULL_ITEM_MASK   0xFFFFFFu
+
+
+// face_view_projection: world -> clip, per CubeFace
+// scissors: x, y, width & height in pixels of a size x size face, per CubeFace
+// -- planes hug each face's scissor, not the whole face
+void cube_frusta(CubeFrusta *frusta, const Mat4 face_view_projection[6], int faces, const int scissors[6][4], int size, Vec3 eye, float far);
+// faces (of mask) box might touch; *inside gets the faces box is entirely within
+int cull_box(const CubeFrusta *frusta, const Aabb *box, int mask, int *inside);
+// every visible item as item | faces << CULL_FACE_SHIFT; returns how many
+// -- subtrees entirely inside their faces are emitted w/o any more tests,
+//    so the cost follows what's visible, not the size of the scene
+// NOTE: visible must hold bvh->num_items
+int cull_bvh(const Bvh *bvh, const Aabb *item_bounds, const CubeFrusta *frusta, uint32_t *visible);
@@ -0,0 +1,149 @@
+// Using C23 Standard
+// POSIX (mmap, fstat)
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "file_io.h"
+
+
+// fallback for files we can't mmap (pipes, non-POSIX platforms)
+// -- one large read instead of many small ones
+static int read_whole_file(char* path, MappedFile *file) {
+    FILE *stream = fopen(path, "rb");
+    if (stream == NULL) {  // most likely file not found
+        fprintf(stderr, "failed to open file: %s\n", path);
+        return 1;
+    }
+
+    if (fseek(stream, 0, SEEK_END) != 0) {
+        fprintf(stderr, "seek failed: %s\n", path);
+        fclose(stream);
+        return 2;
+    }
+    long file_length = ftell(stream);
+    if (file_length < 0) {
+        fprintf(stderr, "ftell failed: %s\n", path);
+        fclose(stream);
+        return 2;
+    }
+    rewind(stream);
+
+    // NOTE: +1 so empty files still get a valid pointer
+    char *data = malloc(file_length + 1);
+    if (data == NULL) {
+        fprintf(stderr, "out of memory reading: %s (%ld bytes)\n", path, file_length);
+        fclose(stream);
+        return 3;
+    }
+
+    size_t bytes_read = fread(data, 1, file_length, stream);
+    fclose(stream);
+    if (bytes_read != (size_t)file_length) {
+        fprintf(stderr, "failed to read file: %s\n", path);
+        free(data);
+        return 4;
+    }
+
+    file->data = data;
+    file->length = file_length;
+    file->mapped = false;
+    return 0;
+}
+
+
+int map_file(char* path, MappedFile *file) {
+    file->data = NULL;
+    file->length = 0;
+    file->mapped = false;
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {  // most likely file not found
+        fprintf(stderr, "failed to open file: %s\n", path);
+        return 1;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        // NOTE: mmap can't map 0 bytes; let the fallback deal with it
+        close(fd);
+        return read_whole_file(path, file);
+    }
+
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping holds its own reference
+    if (data == MAP_FAILED)
+        return read_whole_file(path, file);
+
+    // NOTE: parsers walk the file front to back
+    posix_madvise(data, info.st_size, POSIX_MADV_SEQUENTIAL);
+
+    file->data = data;
+    file->length = info.st_size;
+    file->mapped = true;
+    return 0;
+#else
+    return read_whole_file(path, file);
+#endif
+}
+
+
+void unmap_file(MappedFile *file) {
+    if (file->data == NULL)
+        return;
+#ifndef _WIN32
+    if (file->mapped)
+        munmap(file->data, file->length);
+    else
+        free(file->data);
+#else
+    free(file->data);
+#endif
+    file->data = NULL;
+    file->length = 0;
+    file->mapped = false;
+}
+
+
+int file_info(char* path, int64_t *mtime, uint64_t *size) {
+#ifndef _WIN32
+    struct stat info;
+    if (stat(path, &info) != 0)
+        return 1;  // most likely file not found
+    // NOTE: w/ nanoseconds; whole seconds miss an edit in the second the cache was built
+#ifdef __APPLE__
+    *mtime = (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    *mtime = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    *size = (uint64_t)info.st_size;
+    return 0;
+#else
+    // NOTE: no mtime w/o POSIX; size only
+    FILE *stream = fopen(path, "rb");
+    if (stream == NULL)
+        return 1;
+    fseek(stream, 0, SEEK_END);
+    *mtime = 0;
+    *size = (uint64_t)ftell(stream);
+    fclose(stream);
+    return 0;
+#endif
+}
+
+
+uint64_t fnv1a_64(const void *data, size_t length, uint64_t hash) {
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 0x00000100000001B3ull;  // FNV prime
+    }
+    return hash;
+}
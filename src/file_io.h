@@ -0,0 +1,24 @@
+// Using C23 Standard
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+// whole file in memory
+// -- mmap'd where possible, otherwise read into a heap buffer
+typedef struct MappedFile_s {
+    char   *data;
+    size_t  length;
+    bool    mapped;  // false if data is malloc'd
+} MappedFile;
+
+
+int map_file(char* path, MappedFile *file);
+void unmap_file(MappedFile *file);
+// NOTE: mtime is in nanoseconds, but only as fine as the filesystem keeps it
+int file_info(char* path, int64_t *mtime, uint64_t *size);
+
+// FNV-1a; chain calls by passing the last result as hash
+#define FNV_OFFSET_BASIS  0xCBF29CE484222325ull
+uint64_t fnv1a_64(const void *data, size_t length, uint64_t hash);
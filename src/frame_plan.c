@@ -0,0 +1,297 @@
+// Using C23 Standard
+// Math (-lm)
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "frame_plan.h"
+#include "packed_vertex.h"
+
+
+int init_frame_plan(FramePlan *frame, SceneDesc *desc, Mat4 **transforms) {
+    *transforms = NULL;
+    if (desc->num_meshes == 0 || desc->num_instances == 0) {
+        fprintf(stderr, "empty scene: %d meshes, %d instances\n", desc->num_meshes, desc->num_instances);
+        return 1;
+    } else if (desc->num_instances > (int)CULL_ITEM_MASK + 1) {
+        fprintf(stderr, "too many instances: %d > %u\n", desc->num_instances, CULL_ITEM_MASK + 1);
+        return 1;
+    }
+
+    int num_levels = 0;
+    for (int i = 0; i < desc->num_meshes; i++)
+        num_levels += (desc->meshes[i].num_lods > 0) ? desc->meshes[i].num_lods : 1;
+    frame->num_meshes = desc->num_meshes;
+    frame->num_instances = desc->num_instances;
+    frame->num_levels = num_levels;
+    frame->mesh_instances = malloc(sizeof(int) * (desc->num_meshes + 1));
+    frame->mesh_levels = malloc(sizeof(int) * (desc->num_meshes + 1));
+    frame->level_indices = malloc(sizeof(int) * num_levels);
+    frame->level_errors = malloc(sizeof(float) * num_levels);
+    frame->level_entries = malloc(sizeof(int) * num_levels);
+    frame->instance_bounds = malloc(sizeof(Aabb) * desc->num_instances);
+    frame->instance_meshes = malloc(sizeof(int) * desc->num_instances);
+    frame->visible = malloc(sizeof(uint32_t) * desc->num_instances);
+    frame->visible_levels = malloc(sizeof(int) * desc->num_instances);
+    *transforms = malloc(sizeof(Mat4) * desc->num_instances);
+    if (frame->mesh_instances == NULL || frame->mesh_levels == NULL || frame->level_indices == NULL
+     || frame->level_errors == NULL || frame->level_entries == NULL || frame->instance_bounds == NULL
+     || frame->instance_meshes == NULL || frame->visible == NULL || frame->visible_levels == NULL
+     || *transforms == NULL) {
+        fprintf(stderr, "out of memory for %d meshes & %d instances\n", desc->num_meshes, desc->num_instances);
+        free(*transforms);
+        *transforms = NULL;
+        free_frame_plan(frame);
+        return 1;
+    }
+
+    int num_instances = 0;
+    int level = 0;
+    for (int i = 0; i < desc->num_meshes; i++) {
+        Geometry *geo = &desc->meshes[i];
+        // world space bounds for culling
+        VertexBounds local;
+        mesh_vertex_bounds(geo, (desc->packed != NULL) ? &desc->packed[i] : NULL, &local);
+        Aabb mesh_bounds = {
+            .min = local.offset,
+            .max = {local.offset.x + local.scale.x, local.offset.y + local.scale.y, local.offset.z + local.scale.z}};
+        frame->mesh_instances[i] = num_instances;
+        for (int j = 0; j < desc->num_instances; j++) {
+            if (desc->instances[j].mesh == i) {
+                Mat4 *transform = &(*transforms)[num_instances];
+                *transform = desc->instances[j].transform;
+                frame->instance_bounds[num_instances] = Aabb_transform(transform, mesh_bounds);
+                frame->instance_meshes[num_instances++] = i;
+            }
+        }
+        frame->mesh_levels[i] = level;
+        int num_lods = (geo->num_lods > 0) ? geo->num_lods : 1;
+        for (int j = 0; j < num_lods; j++, level++) {
+            frame->level_indices[level] = geometry_lod(geo, j).num_indices;
+            frame->level_errors[level] = (geo->num_lods > 0) ? geo->lods[j].error : 0.0f;
+        }
+    }
+    frame->mesh_instances[desc->num_meshes] = num_instances;
+    frame->mesh_levels[desc->num_meshes] = level;
+
+    // NOTE: instances are static; built once
+    if (build_bvh(&frame->bvh, num_instances, frame->instance_bounds) != 0) {
+        free(*transforms);
+        *transforms = NULL;
+        free_frame_plan(frame);
+        return 1;  // build_bvh prints its own errors
+    }
+    return 0;
+}
+
+
+void free_frame_plan(FramePlan *frame) {
+    free(frame->mesh_instances);
+    free(frame->mesh_levels);
+    free(frame->level_indices);
+    free(frame->level_errors);
+    free(frame->level_entries);
+    free(frame->instance_bounds);
+    free(frame->instance_meshes);
+    free(frame->visible);
+    free(frame->visible_levels);
+    frame->mesh_instances = NULL;
+    frame->mesh_levels = NULL;
+    frame->level_indices = NULL;
+    frame->level_errors = NULL;
+    frame->level_entries = NULL;
+    frame->instance_bounds = NULL;
+    frame->instance_meshes = NULL;
+    frame->visible = NULL;
+    frame->visible_levels = NULL;
+    free_bvh(&frame->bvh);
+}
+
+
+bool cube_plan_current(CubePlan *plan, int width, int height, PaniniParams *params) {
+    return plan->size != 0 && plan->width == width && plan->height == height
+        && same_panini_params(&plan->params, params);
+}
+
+
+void plan_cube(CubePlan *plan, int max_size, int width, int height, PaniniParams *params) {
+    CubeFaceUsage usage[6];
+    panini_cube_usage(params, width, height, usage);
+
+    float densest = 0.0f;
+    for (int i = 0; i < 6; i++) {
+        if (usage[i].used && usage[i].size > densest)
+            densest = usage[i].size;
+    }
+    int longest = (width > height) ? width : height;
+    if (max_size > longest * CUBE_MAX_SCALE)
+        max_size = longest * CUBE_MAX_SCALE;
+    int size = ((int)ceilf(densest) + CUBE_SIZE_STEP - 1) / CUBE_SIZE_STEP * CUBE_SIZE_STEP;
+    size = (size < CUBE_SIZE_STEP) ? CUBE_SIZE_STEP : (size > max_size) ? max_size : size;
+
+    plan->num_faces = 0;
+    int min_x = size, min_y = size, max_x = 0, max_y = 0;
+    for (int i = 0; i < 6; i++) {
+        int *scissor = plan->scissors[i];
+        if (!usage[i].used) {
+            scissor[0] = scissor[1] = scissor[2] = scissor[3] = 0;
+            continue;
+        }
+        plan->faces[plan->num_faces++] = i;
+        int x0 = (int)floorf(usage[i].min_s * size) - CUBE_SCISSOR_PAD;
+        int y0 = (int)floorf(usage[i].min_t * size) - CUBE_SCISSOR_PAD;
+        int x1 = (int)ceilf(usage[i].max_s * size) + CUBE_SCISSOR_PAD;
+        int y1 = (int)ceilf(usage[i].max_t * size) + CUBE_SCISSOR_PAD;
+        x0 = (x0 < 0) ? 0 : x0;
+        y0 = (y0 < 0) ? 0 : y0;
+        x1 = (x1 > size) ? size : x1;
+        y1 = (y1 > size) ? size : y1;
+        scissor[0] = x0;
+        scissor[1] = y0;
+        scissor[2] = x1 - x0;
+        scissor[3] = y1 - y0;
+        min_x = (x0 < min_x) ? x0 : min_x;
+        min_y = (y0 < min_y) ? y0 : min_y;
+        max_x = (x1 > max_x) ? x1 : max_x;
+        max_y = (y1 > max_y) ? y1 : max_y;
+    }
+    plan->bounds[0] = min_x;
+    plan->bounds[1] = min_y;
+    plan->bounds[2] = max_x - min_x;
+    plan->bounds[3] = max_y - min_y;
+
+    plan->width = width;
+    plan->height = height;
+    plan->params = *params;
+    plan->size = size;
+}
+
+
+// view space of each cube face, in GL_TEXTURE_CUBE_MAP_POSITIVE_X order
+// -- also VK_IMAGE_VIEW_TYPE_CUBE's layer order
+// -- rows are right, up & -forward of the standard cube capture cameras
+static const Mat4 cube_face_views[6] = {
+    {{{ 0, 0, -1, 0}, {0, -1,  0, 0}, {-1, 0,  0, 0}, {0, 0, 0, 1}}},   // +X
+    {{{ 0, 0,  1, 0}, {0, -1,  0, 0}, { 1, 0,  0, 0}, {0, 0, 0, 1}}},   // -X
+    {{{ 1, 0,  0, 0}, {0,  0, -1, 0}, { 0, 1,  0, 0}, {0, 0, 0, 1}}},   // +Y
+    {{{ 1, 0,  0, 0}, {0,  0,  1, 0}, { 0, -1, 0, 0}, {0, 0, 0, 1}}},   // -Y
+    {{{ 1, 0,  0, 0}, {0, -1,  0, 0}, { 0, 0, -1, 0}, {0, 0, 0, 1}}},   // +Z
+    {{{-1, 0,  0, 0}, {0, -1,  0, 0}, { 0, 0,  1, 0}, {0, 0, 0, 1}}}};  // -Z
+
+
+void frame_views(Camera *camera, FrameViews *views) {
+    views->eye = camera->position;
+    update_view_matrix(camera, &views->view);
+    views->projection = Mat4_perspective(90.0f, 1.0f, NEAR_PLANE, FAR_PLANE);
+    for (int i = 0; i < 6; i++) {
+        Mat4 face_view = Mat4_multiply(&cube_face_views[i], &views->view);
+        views->face_view_projection[i] = Mat4_multiply(&views->projection, &face_view);
+    }
+}
+
+
+// NOTE: <stdbit.h> isn't in every C23 libc yet; masks are only 6 bits anyway
+static int count_faces(uint32_t faces) {
+    int count = 0;
+    for (; faces != 0; faces &= faces - 1)
+        count++;
+    return count;
+}
+
+
+// coarsest LOD of instance's mesh w/ at most frame->lod_pixels of error on screen
+// -- error / distance is an angle; panini_scale at the instance's direction
+//    turns that into image plane units, & pixels_per_unit into pixels
+// NOTE: distance is to the nearest point of the bounds, so big instances stay sharp up close
+static int pick_level(FramePlan *frame, Mat4 *view, PaniniParams *params, uint32_t instance, float pixels_per_unit) {
+    int mesh = frame->instance_meshes[instance];
+    int level = frame->mesh_levels[mesh];
+    int last = frame->mesh_levels[mesh + 1] - 1;
+    if (level == last || frame->lod_pixels <= 0.0f)
+        return level;
+    Aabb *bounds = &frame->instance_bounds[instance];
+    Vec3 extent = {
+        bounds->max.x - bounds->min.x,
+        bounds->max.y - bounds->min.y,
+        bounds->max.z - bounds->min.z};
+    Vec4 centre = Mat4_transform(view, (Vec4){
+        (bounds->min.x + bounds->max.x) * 0.5f,
+        (bounds->min.y + bounds->max.y) * 0.5f,
+        (bounds->min.z + bounds->max.z) * 0.5f, 1.0f});
+    Vec3 direction = {centre.x, centre.y, centre.z};
+    float distance = Vec3_magnitude(direction) - 0.5f * Vec3_magnitude(extent);
+    if (distance <= NEAR_PLANE)
+        return level;
+    float pixels_per_error = panini_scale(params, direction) * pixels_per_unit / distance;
+    while (level < last && frame->level_errors[level + 1] * pixels_per_error <= frame->lod_pixels)
+        level++;
+    return level;
+}
+
+
+void cull_frame(FramePlan *frame, FrameViews *views, CubePlan *plan, PaniniParams *params, int width, bool per_face) {
+    int faces = 0;
+    for (int i = 0; i < plan->num_faces; i++)
+        faces |= 1 << plan->faces[i];
+    int num_visible = frame->num_instances;
+    if (frame->culling) {
+        CubeFrusta frusta;
+        cube_frusta(&frusta, views->face_view_projection, faces, plan->scissors, plan->size, views->eye, FAR_PLANE);
+        num_visible = cull_bvh(&frame->bvh, frame->instance_bounds, &frusta, frame->visible);
+    } else {
+        for (int i = 0; i < num_visible; i++)
+            frame->visible[i] = (uint32_t)i | (uint32_t)faces << CULL_FACE_SHIFT;
+    }
+
+    // counted per LOD; write_frame_entries sorts by them
+    int *counts = frame->level_entries;
+    for (int i = 0; i < frame->num_levels; i++)
+        counts[i] = 0;
+    float pixels_per_unit = width / (2.0f * panini_half_width(params));
+    for (int i = 0; i < num_visible; i++) {
+        uint32_t entry = frame->visible[i];
+        int level = pick_level(frame, &views->view, params, entry & CULL_ITEM_MASK, pixels_per_unit);
+        frame->visible_levels[i] = level;
+        counts[level] += per_face ? count_faces(entry >> CULL_FACE_SHIFT) : 1;
+    }
+
+    int num_draws = 0;
+    int num_entries = 0;
+    int64_t num_triangles = 0;
+    for (int i = 0; i < frame->num_levels; i++) {
+        num_draws += (counts[i] > 0) ? 1 : 0;
+        num_entries += counts[i];
+        num_triangles += (int64_t)(frame->level_indices[i] / 3) * counts[i];
+    }
+    frame->num_visible = num_visible;
+    frame->num_draws = num_draws;
+    frame->num_entries = num_entries;
+    frame->num_triangles = num_triangles;
+}
+
+
+void write_frame_entries(FramePlan *frame, bool per_face, uint32_t *entries) {
+    // counting sort by LOD; commands need each LOD's entries in 1 run
+    // NOTE: level_entries becomes where each LOD's entries end; counts are
+    // no use once the commands are written
+    int *next = frame->level_entries;
+    int first = 0;
+    for (int i = 0; i < frame->num_levels; i++) {
+        int count = next[i];
+        next[i] = first;
+        first += count;
+    }
+    for (int i = 0; i < frame->num_visible; i++) {
+        uint32_t entry = frame->visible[i];
+        uint32_t instance = entry & CULL_ITEM_MASK;
+        int *level = &next[frame->visible_levels[i]];
+        if (!per_face) {
+            entries[(*level)++] = entry;
+            continue;
+        }
+        for (int face = 0; face < 6; face++) {
+            if (entry >> (CULL_FACE_SHIFT + face) & 1)
+                entries[(*level)++] = instance | 1u << (CULL_FACE_SHIFT + face);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdint.h>
+
+#include "bvh.h"
+#include "camera.h"
+#include "cull.h"
+#include "geometry.h"
+#include "matrix.h"
+#include "packed_vertex.h"
+#include "panini.h"
+
+
+// the CPU half of each frame; the same for every renderer
+// -- render_gl.c & render_vulkan.c only turn it into their own draws
+
+
+// cube sizes are rounded up to this, so small param changes don't reallocate
+#define CUBE_SIZE_STEP  32
+// texels around each scissor; bilinear footprint & half float LUT error
+#define CUBE_SCISSOR_PAD  2
+// cap on face size, relative to the output's longest side
+// NOTE: narrow fovs do want > 1x; degenerate params (compression 1 past
+// 90deg of longitude squashes rows to nothing) want ~infinite
+#define CUBE_MAX_SCALE  4
+
+
+// NOTE: same near & far as direct.tese.glsl
+#define NEAR_PLANE  0.1f
+#define FAR_PLANE   1024.0f
+
+
+// which cube faces the cube pass renders, where & at what size
+// -- from panini_cube_usage; keyed on resolution & PaniniParams, like PaniniLut
+// NOTE: 1 size for every face; cube maps can't mix face sizes
+// -- so only the densest face gets exactly 1 texel per pixel
+typedef struct CubePlan_s {
+    // what the plan was made for; size == 0 if it never was
+    int           width;
+    int           height;
+    PaniniParams  params;
+    int           size;  // of each face, in pixels
+    int           num_faces;
+    int           faces[6];  // CubeFace of each used face; the first num_faces
+    int           scissors[6][4];  // x, y, width & height, per CubeFace
+    // all used scissors; for GL's AMD_vertex_shader_layer path, w/ 1 scissor
+    int           bounds[4];
+} CubePlan;
+
+
+// 1 placement of a mesh in the world
+typedef struct SceneInstance_s {
+    int   mesh;       // index into SceneDesc.meshes
+    Mat4  transform;  // model -> world
+} SceneInstance;
+
+
+// what populate uploads; many meshes, each drawn any number of times
+// NOTE: transforms should be rigid (rotation & translation); normals aren't renormalised
+typedef struct SceneDesc_s {
+    int             num_meshes;
+    Geometry       *meshes;
+    PackedMesh     *packed;  // NULL, or 1 per mesh; VERTEX_PACKED uploads these as is if it can
+    int             num_instances;
+    SceneInstance  *instances;
+} SceneDesc;
+
+
+// where the camera sees from this frame
+// NOTE: GL clip space (z in [-w, w]); cube_frusta expects it
+typedef struct FrameViews_s {
+    Vec3  eye;   // Camera.position
+    Mat4  view;  // world -> camera
+    Mat4  projection;  // 90deg fov on both axes, for cube faces
+    Mat4  face_view_projection[6];  // world -> clip, per CubeFace
+} FrameViews;
+
+
+// instances, their LODs & what's visible of them this frame
+// -- instances are grouped by mesh, in SceneDesc order;
+//    mesh i's are mesh_instances[i] up to mesh_instances[i + 1]
+// -- levels of detail; every mesh has 1 or more, coarser ones later;
+//    mesh i's are mesh_levels[i] up to mesh_levels[i + 1]
+// -- 1 indirect command per level; a level's instances are its visible entries
+typedef struct FramePlan_s {
+    int     num_meshes;
+    int     num_instances;
+    int     num_levels;
+    int    *mesh_instances;  // num_meshes + 1
+    int    *mesh_levels;     // num_meshes + 1
+    int    *level_indices;   // num_levels; GeometryLod.num_indices
+    float  *level_errors;    // num_levels; GeometryLod.error
+    float   lod_pixels;  // largest LOD error allowed on screen; 0 for full detail everywhere
+    // culling; instances are tested against every used cube face's frustum at once
+    bool       culling;  // false draws every instance to every used face
+    Bvh        bvh;      // over instance_bounds
+    Aabb      *instance_bounds;  // world space
+    int       *instance_meshes;
+    uint32_t  *visible;  // cull_bvh output; instance | faces << CULL_FACE_SHIFT
+    int       *visible_levels;  // LOD per visible entry
+    int       *level_entries;   // per LOD; this frame's entries of it, until write_frame_entries
+    int        num_visible;  // this frame's instances w/ any face to draw to
+    int        num_draws;    // this frame's LODs w/ anything visible
+    int        num_entries;  // this frame's entries; (instance, face) pairs or instances
+    int64_t    num_triangles;  // this frame's, summed over num_entries
+} FramePlan;
+
+
+// groups desc's instances by mesh, indexes every LOD & builds a BVH over the instances
+// -- *transforms gets desc's, in the same order; malloc'd, free it after uploading
+// NOTE: culling & lod_pixels are left as they are
+int init_frame_plan(FramePlan *frame, SceneDesc *desc, Mat4 **transforms);
+void free_frame_plan(FramePlan *frame);
+
+// false if plan was made for a different width, height or params
+bool cube_plan_current(CubePlan *plan, int width, int height, PaniniParams *params);
+// faces, scissors & a face size of at most max_size; the device's cube map limit
+void plan_cube(CubePlan *plan, int max_size, int width, int height, PaniniParams *params);
+
+void frame_views(Camera *camera, FrameViews *views);
+
+// culls instances against plan's faces, then picks each visible instance's LOD
+// -- per_face: 1 entry per visible (instance, face), for layered cube passes that
+//    pick their face from the entry. otherwise 1 entry per instance w/ all its faces
+// -- fills level_entries & the frame's counts; the indirect commands are up to the renderer
+void cull_frame(FramePlan *frame, FrameViews *views, CubePlan *plan, PaniniParams *params, int width, bool per_face);
+// this frame's entries, each LOD's in 1 run, in level order; num_entries long
+// -- per_face must match cull_frame's
+// NOTE: only ever writes entries, so it can go straight to a write only mapping
+void write_frame_entries(FramePlan *frame, bool per_face, uint32_t *entries);
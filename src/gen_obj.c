@@ -0,0 +1,296 @@
+// Using C23 Standard
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// synthetic .obj files for bench_obj
+// -- faces tile a grid of positions, so neighbours share corners like a real mesh
+// -- each face of n corners covers a strip of cells; top row left to right,
+//    then the bottom row right to left
+
+
+#define GRID_WIDTH  1024  // positions per row
+
+
+typedef enum IndexStyle_e {
+    INDEX_ABSOLUTE,  // f 1 2 3
+    INDEX_NEGATIVE,  // f -3 -2 -1
+    INDEX_MIXED,     // random per corner
+} IndexStyle;
+
+
+typedef struct GenOptions_s {
+    long        num_faces;
+    int         arity;  // corners per face; 0 for random 3..6
+    IndexStyle  index_style;
+    bool        uvs;  // vt
+    bool        normals;  // vn
+    bool        noise;  // random whitespace, comments & blank lines
+    bool        crlf;
+    uint64_t    seed;
+} GenOptions;
+
+
+typedef struct Generator_s {
+    FILE       *file;
+    GenOptions *options;
+    uint64_t    rng;
+    long        num_rows;  // rows of positions written so far
+    const char *newline;
+} Generator;
+
+
+// xorshift64*
+static uint32_t next_random(Generator *gen) {
+    gen->rng ^= gen->rng >> 12;
+    gen->rng ^= gen->rng << 25;
+    gen->rng ^= gen->rng >> 27;
+    return (uint32_t)((gen->rng * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+
+static float random_float(Generator *gen) {
+    return (next_random(gen) >> 8) * (1.0f / (1 << 24));
+}
+
+
+// separator between tokens
+static void write_space(Generator *gen) {
+    if (!gen->options->noise) {
+        fputc(' ', gen->file);
+        return;
+    }
+    static const char *spaces[] = {" ", " ", " ", "  ", "\t", " \t", "   "};
+    fputs(spaces[next_random(gen) % 7], gen->file);
+}
+
+
+static void write_newline(Generator *gen) {
+    if (gen->options->noise) {
+        switch (next_random(gen) % 32) {
+            case 0:
+                fputs(" \t", gen->file);  // trailing whitespace
+                break;
+            case 1:
+                fputs(gen->newline, gen->file);  // blank line
+                break;
+            case 2:
+                fputs(gen->newline, gen->file);
+                fputs("# comment", gen->file);
+                break;
+        }
+    }
+    fputs(gen->newline, gen->file);
+}
+
+
+// one row of GRID_WIDTH positions (+ uvs & normals) on a bumpy plane
+static void write_row(Generator *gen) {
+    long y = gen->num_rows;
+    for (int x = 0; x < GRID_WIDTH; x++) {
+        float height = random_float(gen) * 0.25f;
+        fputc('v', gen->file);
+        write_space(gen);
+        fprintf(gen->file, "%.6f", x * 0.1f);
+        write_space(gen);
+        fprintf(gen->file, "%.6f", height);
+        write_space(gen);
+        fprintf(gen->file, "%.6f", (float)-y * 0.1f);
+        write_newline(gen);
+        if (gen->options->uvs) {
+            fputs("vt", gen->file);
+            write_space(gen);
+            fprintf(gen->file, "%.6f", (float)x / GRID_WIDTH);
+            write_space(gen);
+            fprintf(gen->file, "%.6f", (float)(y % GRID_WIDTH) / GRID_WIDTH);
+            write_newline(gen);
+        }
+        if (gen->options->normals) {
+            // NOTE: not normalised; the loader doesn't care
+            fputs("vn", gen->file);
+            write_space(gen);
+            fprintf(gen->file, "%.4f", random_float(gen) * 0.2f - 0.1f);
+            write_space(gen);
+            fprintf(gen->file, "%.4f", 1.0f);
+            write_space(gen);
+            fprintf(gen->file, "%.4f", random_float(gen) * 0.2f - 0.1f);
+            write_newline(gen);
+        }
+    }
+    gen->num_rows++;
+}
+
+
+// index is 1-based & absolute; vt & vn share the position's index
+static void write_corner(Generator *gen, long index) {
+    long total = gen->num_rows * GRID_WIDTH;
+    bool negative = gen->options->index_style == INDEX_NEGATIVE
+        || (gen->options->index_style == INDEX_MIXED && next_random(gen) % 2 == 0);
+    if (negative)
+        index = index - total - 1;
+    write_space(gen);
+    fprintf(gen->file, "%ld", index);
+    if (gen->options->uvs && gen->options->normals) {
+        fprintf(gen->file, "/%ld/%ld", index, index);
+    } else if (gen->options->uvs) {
+        fprintf(gen->file, "/%ld", index);
+    } else if (gen->options->normals) {
+        fprintf(gen->file, "//%ld", index);
+    }
+}
+
+
+int generate(FILE *file, GenOptions *options) {
+    Generator gen = {
+        .file = file,
+        .options = options,
+        .rng = options->seed != 0 ? options->seed : 1,
+        .num_rows = 0,
+        .newline = options->crlf ? "\r\n" : "\n"};
+
+    fputs("# gen_obj synthetic mesh", file);
+    write_newline(&gen);
+    write_row(&gen);
+    write_row(&gen);
+
+    long row = 0;  // top row of the current strip
+    int x = 0;
+    for (long i = 0; i < options->num_faces; i++) {
+        int arity = options->arity > 0 ? options->arity : 3 + (int)(next_random(&gen) % 4);
+        int top = (arity + 1) / 2;
+        int bottom = arity - top;
+        int width = (top > 1) ? top - 1 : 1;  // cells covered
+        if (x + width >= GRID_WIDTH) {
+            x = 0;
+            row++;
+            // NOTE: rows are written as faces need them, so negative
+            // indices are relative to a file that's still growing
+            write_row(&gen);
+        }
+
+        long top_row = row * GRID_WIDTH + 1;
+        long bottom_row = top_row + GRID_WIDTH;
+        fputc('f', file);
+        for (int j = 0; j < top; j++)
+            write_corner(&gen, top_row + x + j);
+        for (int j = bottom - 1; j >= 0; j--)
+            write_corner(&gen, bottom_row + x + j);
+        write_newline(&gen);
+        x += width;
+    }
+
+    if (ferror(file)) {
+        fprintf(stderr, "write failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+
+// 1K, 10M etc.
+long parse_count(char* string) {
+    char *suffix;
+    long count = strtol(string, &suffix, 10);
+    switch (*suffix) {
+        case 'k': case 'K':
+            return count * 1000;
+        case 'm': case 'M':
+            return count * 1000 * 1000;
+        case '\0':
+            return count;
+        default:
+            return -1;
+    }
+}
+
+
+void print_usage(char* argv_0) {
+    printf("usage: %s [options] folder/file.obj\n", argv_0);
+    printf("synthetic .obj for bench_obj; writes to stdout if the path is -\n");
+    printf("    --faces N     face count; 1K, 50M etc. (default 100K)\n");
+    printf("    --arity N     corners per face; 0 for random 3..6 (default 3)\n");
+    printf("    --index STYLE absolute, negative or mixed (default absolute)\n");
+    printf("    --attribs A   v, v/vt, v//vn or v/vt/vn (default v/vt/vn)\n");
+    printf("    --noise       random whitespace, comments & blank lines\n");
+    printf("    --crlf        windows line endings\n");
+    printf("    --seed N      (default 1)\n");
+}
+
+
+int main(int argc, char* argv[]) {
+    GenOptions options = {
+        .num_faces = 100 * 1000,
+        .arity = 3,
+        .index_style = INDEX_ABSOLUTE,
+        .uvs = true,
+        .normals = true,
+        .noise = false,
+        .crlf = false,
+        .seed = 1};
+    char *path = NULL;
+    bool bad_args = false;
+    for (int i = 1; i < argc && !bad_args; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--faces") == 0 && has_value) {
+            options.num_faces = parse_count(argv[++i]);
+            bad_args = options.num_faces < 0;
+        } else if (strcmp(argv[i], "--arity") == 0 && has_value) {
+            options.arity = atoi(argv[++i]);
+            bad_args = options.arity != 0 && (options.arity < 3 || options.arity > 64);
+        } else if (strcmp(argv[i], "--index") == 0 && has_value) {
+            i++;
+            if (strcmp(argv[i], "absolute") == 0) {
+                options.index_style = INDEX_ABSOLUTE;
+            } else if (strcmp(argv[i], "negative") == 0) {
+                options.index_style = INDEX_NEGATIVE;
+            } else if (strcmp(argv[i], "mixed") == 0) {
+                options.index_style = INDEX_MIXED;
+            } else {
+                bad_args = true;
+            }
+        } else if (strcmp(argv[i], "--attribs") == 0 && has_value) {
+            i++;
+            options.uvs = strstr(argv[i], "vt") != NULL;
+            options.normals = strstr(argv[i], "vn") != NULL;
+        } else if (strcmp(argv[i], "--noise") == 0) {
+            options.noise = true;
+        } else if (strcmp(argv[i], "--crlf") == 0) {
+            options.crlf = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            options.seed = strtoull(argv[++i], NULL, 10);
+        } else if (path == NULL && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+            path = argv[i];
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args || path == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    bool to_stdout = strcmp(path, "-") == 0;
+    FILE *file = to_stdout ? stdout : fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "failed to open file: %s\n", path);
+        return 1;
+    }
+    // NOTE: big buffer; multi-GB outputs are mostly fprintf & fwrite
+    static char buffer[1 << 20];
+    setvbuf(file, buffer, _IOFBF, sizeof(buffer));
+
+    int result = generate(file, &options);
+    if (to_stdout) {
+        fflush(file);
+        return result;
+    }
+    if (fclose(file) != 0)
+        result = 1;
+    if (result != 0) {
+        remove(path);  // don't leave a truncated mesh for bench_obj
+        return 1;
+    }
+    return 0;
+}
@@ -1,27 +1,57 @@
 // Using C23 Standard
+// POSIX (sysconf)
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+// C11 threads (-pthread)
+#include <threads.h>
+#include <time.h>
+#include <unistd.h>
 
+#include "file_io.h"
 #include "geometry.h"
+#include "optimise.h"
+#include "simplify.h"
+#include "parse_number.h"
 
 
-int read_opcode(FILE *file, char* c, char *opcode) {
-    if (!fread(opcode, 1, 1, file))
+// wall clock for ObjStats
+static double obj_clock() {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+// NOTE: '\r' counts as whitespace so CRLF files parse
+static inline bool is_whitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+
+int read_opcode(Reader *reader, char *opcode) {
+    if (reader->head >= reader->end)
         return 1;  // EOF
+    *opcode = *reader->head;
     if (*opcode == '\n')
-        return 0;  // empty line
-    if (!fread(c, 1, 1, file))
+        return 0;  // empty line; newline is left for the caller
+    reader->head++;
+    if (reader->head >= reader->end)
         return 2;  // EOF
-    if (*c == ' ' || *c == '\t') {
+    char c = *reader->head;
+    if (c == ' ' || c == '\t') {
         return 0;
     } else if (*opcode == 'v') {
-        switch (*c) {
+        switch (c) {
             case 't':
             case 'n':
-                *opcode = *c;
-                if (!fread(c, 1, 1, file))
+                *opcode = c;
+                reader->head++;
+                if (reader->head >= reader->end)
                     return 3;  // EOF
-                if (!(*c == ' ' || *c == '\t'))
+                c = *reader->head;
+                if (!(c == ' ' || c == '\t'))
                     return 4;  // invalid "v[nt]" opcode
                 return 0;
                 break;
@@ -30,269 +60,930 @@ int read_opcode(FILE *file, char* c, char *opcode) {
         }
     }
     // advance to whitespace after opcode
-    while (*c != ' ' && *c != '\t') {
-        if (!fread(c, 1, 1, file))
-            return 4;  // EOF
-        // NOTE: will consume newlines; "#\n" could cause bugs
-    }
+    // NOTE: stops on newlines too, so "#\n" is just an empty comment
+    while (reader->head < reader->end
+        && *reader->head != ' ' && *reader->head != '\t' && *reader->head != '\n')
+        reader->head++;
     return 0;
 }
 
 
-int consume_whitespace(FILE *file, char *c) {
-    while (*c == ' ' || *c == '\t') {
-        if (*c == '\n')
-            return 0;  // end of line
-        if (!fread(c, 1, 1, file))
-            return 1;  // end of file
-    }
+int consume_whitespace(Reader *reader) {
+    while (reader->head < reader->end && is_whitespace(*reader->head))
+        reader->head++;
+    if (reader->head >= reader->end)
+        return 1;  // end of file
     return 0;
 }
 
 
-int consume_line(FILE *file, char *c) {
-    while (*c != '\n') {
-        if (!fread(c, 1, 1, file))
-            return 1;  // end of file
+int consume_line(Reader *reader) {
+    const char *newline = memchr(reader->head, '\n', reader->end - reader->head);
+    if (newline == NULL) {
+        reader->head = reader->end;
+        return 1;  // end of file
     }
+    reader->head = newline;
     return 0;
 }
 
 
-int read_token(FILE *file, char *c, int len_token, char* token) {
+int read_token(Reader *reader, int len_token, char* token) {
     if (len_token == 0)
         return 1;  // 0 length token
     // skip leading whitespace
-    if (*c == ' ' || *c == '\t') {
-        if (consume_whitespace(file, c) != 0)
-            return 2;  // hit eof before reaching token
-        if (*c == '\n')  // TODO: just expose the consume_whitespace error code
-            return 3;  // hit newline before reaching token
-    }
+    if (consume_whitespace(reader) != 0)
+        return 2;  // hit eof before reaching token
+    if (*reader->head == '\n')
+        return 3;  // hit newline before reaching token
     // collect non-whitespace characters into token
     int p = 0;
-    while (*c != ' ' && *c != '\t' && *c != '\n') {
-        token[p] = *c;
+    while (reader->head < reader->end
+        && !is_whitespace(*reader->head) && *reader->head != '\n') {
+        token[p] = *reader->head;
         p++;
         if (p >= len_token)
             return 4;  // undersized token
-        if (!fread(c, 1, 1, file))
-            return 5;  // end of file
+        reader->head++;
     }
     token[p] = '\0';
     return 0;
 }
 
 
-int read_float_token(FILE *file, char *c, float *dest) {
-    char token[32];
-    if (read_token(file, c, sizeof(token), token) != 0)
-        return 1;
-    *dest = atof(token);
-    // NOTE: atof has no error checking
+// true if the reader is on whitespace, a newline or EOF
+static inline bool at_token_end(Reader *reader) {
+    return reader->head >= reader->end
+        || is_whitespace(*reader->head)
+        || *reader->head == '\n';
+}
+
+
+static inline bool at_char(Reader *reader, char c) {
+    return reader->head < reader->end && *reader->head == c;
+}
+
+
+int read_float_token(Reader *reader, float *dest) {
+    if (consume_whitespace(reader) != 0)
+        return 1;  // hit eof before reaching token
+    if (*reader->head == '\n')
+        return 2;  // hit newline before reaching token
+    if (parse_float(&reader->head, reader->end, dest) != 0)
+        return 3;  // malformed number
+    if (!at_token_end(reader))
+        return 4;  // junk after the number (e.g. "1.0f")
     return 0;
 }
 
 
-// NOTE: assumes token is NULL terminated, we trust read_token
-int read_vertex_token(FILE *file, char *c, int *vi, int *vti, int *vni) {
-    // get full vertex token
-    char token[32];
-    if (read_token(file, c, sizeof(token), token) != 0)
-        return 1;  // unexpected EOF
+int read_vertex_token(Reader *reader, int *vi, int *vti, int *vni) {
+    if (consume_whitespace(reader) != 0 || *reader->head == '\n')
+        return 1;  // no token before EOF / end of line
     // defaults
     *vti = 0;
     *vni = 0;
-    int i = 0;  // index index (v, vn, vt)
-    int s = 0;  // start of subtoken
-    int e = 0;  // end of subtoken
-    bool finished = false;
-    while (!finished) {
-        // separate & parse subtoken(s)
-        if (token[e] == '/' || token[e] == '\0') {
-            if (token[e] == '\0')
-                finished = true;  // end of token
-            // subtoken -> int
-            token[e] = '\0';
-            int index = (e > s) ? atoi(&token[s]) : 0;
-            // NOTE: atoi is not checked for errors
-            s = e + 1;
-            // "yield" index
-            switch (i) {
-                case 0: *vi  = index; break;
-                case 1: *vti = index; break;
-                case 2: *vni = index; break;
-                default: return 2;  // too many separators
+    // NOTE: empty subtokens ("1//3", "1/") leave the default
+    if (parse_int(&reader->head, reader->end, vi) != 0)
+        return 3;  // empty or malformed v
+    if (at_char(reader, '/')) {
+        reader->head++;
+        if (!at_char(reader, '/') && !at_token_end(reader)) {
+            if (parse_int(&reader->head, reader->end, vti) != 0)
+                return 4;  // malformed vt
+        }
+        if (at_char(reader, '/')) {
+            reader->head++;
+            if (!at_token_end(reader)) {
+                if (parse_int(&reader->head, reader->end, vni) != 0)
+                    return 5;  // malformed vn
+            }
+        }
+    }
+    if (!at_token_end(reader))
+        return 2;  // too many separators / junk
+    return 0;
+}
+
+
+// fast paths for each layout, no branching on what comes next
+// -- return non-zero if the token doesn't match, so read_corner can retry
+static inline int read_corner_layout(Reader *reader, FaceLayout layout, ObjCorner *corner) {
+    const char **head = &reader->head;
+    const char  *end = reader->end;
+    corner->vti = 0;
+    corner->vni = 0;
+    if (parse_int(head, end, &corner->vi) != 0)
+        return 1;
+    switch (layout) {
+        case FACE_V:
+            break;
+        case FACE_V_VT:
+            if (!at_char(reader, '/'))
+                return 1;
+            (*head)++;
+            if (parse_int(head, end, &corner->vti) != 0)
+                return 1;
+            break;
+        case FACE_V_VN:
+            if (end - *head < 2 || (*head)[0] != '/' || (*head)[1] != '/')
+                return 1;
+            *head += 2;
+            if (parse_int(head, end, &corner->vni) != 0)
+                return 1;
+            break;
+        case FACE_V_VT_VN:
+            if (!at_char(reader, '/'))
+                return 1;
+            (*head)++;
+            if (parse_int(head, end, &corner->vti) != 0 || !at_char(reader, '/'))
+                return 1;
+            (*head)++;
+            if (parse_int(head, end, &corner->vni) != 0)
+                return 1;
+            break;
+        default:
+            return 1;
+    }
+    return at_token_end(reader) ? 0 : 1;
+}
+
+
+int read_corner(Reader *reader, FaceLayout *layout, ObjCorner *corner) {
+    const char *start = reader->head;
+    if (*layout != FACE_UNKNOWN) {
+        if (read_corner_layout(reader, *layout, corner) == 0)
+            return 0;
+        reader->head = start;  // layout changed; take the slow path
+    }
+    int err = read_vertex_token(reader, &corner->vi, &corner->vti, &corner->vni);
+    if (err != 0)
+        return err;
+    // remember the layout for the next corner
+    // NOTE: "1/" & "1//" etc. just stay on the slow path
+    const char *slash = memchr(start, '/', reader->head - start);
+    if (slash == NULL) {
+        *layout = FACE_V;
+    } else if (slash + 1 < reader->head && slash[1] == '/') {
+        *layout = (corner->vni != 0) ? FACE_V_VN : FACE_UNKNOWN;
+    } else if (corner->vti != 0) {
+        *layout = (memchr(slash + 1, '/', reader->head - slash - 1) == NULL) ? FACE_V_VT
+                : (corner->vni != 0) ? FACE_V_VT_VN : FACE_UNKNOWN;
+    } else {
+        *layout = FACE_UNKNOWN;
+    }
+    return 0;
+}
+
+
+static inline uint32_t hash_corner(int vi, int vti, int vni) {
+    uint32_t h = (uint32_t)vi * 0x9E3779B1u;
+    h ^= (uint32_t)vti * 0x85EBCA77u;
+    h ^= (uint32_t)vni * 0xC2B2AE3Du;
+    return h ^ (h >> 15);
+}
+
+
+static int grow_weld_table(WeldTable *table, Arena *arena, int min_entries) {
+    int max_entries = 64;
+    while (max_entries < min_entries * 2)  // keep load factor <= 0.5
+        max_entries *= 2;
+    WeldEntry *entries = arena_alloc(arena, sizeof(WeldEntry) * max_entries);
+    if (entries == NULL)
+        return 1;  // out of memory
+    for (int i = 0; i < max_entries; i++)
+        entries[i].vi = 0;  // empty slot
+    // rehash
+    uint32_t mask = max_entries - 1;
+    for (int i = 0; i < table->max_entries; i++) {
+        WeldEntry entry = table->entries[i];
+        if (entry.vi == 0)
+            continue;
+        uint32_t slot = hash_corner(entry.vi, entry.vti, entry.vni) & mask;
+        while (entries[slot].vi != 0)
+            slot = (slot + 1) & mask;
+        entries[slot] = entry;
+    }
+    // NOTE: old entries are left in the arena
+    table->entries = entries;
+    table->max_entries = max_entries;
+    return 0;
+}
+
+
+int init_weld_table(WeldTable *table, Arena *arena, int expected_vertices) {
+    table->num_entries = 0;
+    table->max_entries = 0;
+    table->entries = NULL;
+    return grow_weld_table(table, arena, expected_vertices);
+}
+
+
+int add_corner(ObjFile *obj, Geometry *geo, int vi, int vti, int vni, uint32_t *index) {
+    // welded: reuse the vertex if we've already seen this (vi, vti, vni)
+    WeldEntry *entry = NULL;
+    if (obj->weld != NULL) {
+        WeldTable *table = obj->weld;
+        if ((table->num_entries + 1) * 2 > table->max_entries) {
+            if (grow_weld_table(table, obj->arena, table->num_entries + 1) != 0)
+                return 2;  // out of memory (weld table)
+        }
+        uint32_t mask = table->max_entries - 1;
+        uint32_t slot = hash_corner(vi, vti, vni) & mask;
+        while (table->entries[slot].vi != 0) {
+            entry = &table->entries[slot];
+            if (entry->vi == vi && entry->vti == vti && entry->vni == vni) {
+                *index = entry->vertex;
+                return 0;
             }
-            i++;
+            slot = (slot + 1) & mask;
         }
-        e++;
+        entry = &table->entries[slot];
+    }
+
+    // append vertex to geo
+    if (reserve_geometry(geo, 1, 0) != 0)
+        return 1;  // out of memory (geo.vertices)
+    Vertex vertex = {
+        .position = obj->positions[vi],
+        .normal = obj->normals[vni],
+        .uv = obj->uvs[vti]};
+    *index = geo->num_vertices;
+    geo->vertices[geo->num_vertices] = vertex;
+    geo->num_vertices++;
+
+    if (entry != NULL) {
+        *entry = (WeldEntry){.vi = vi, .vti = vti, .vni = vni, .vertex = *index};
+        obj->weld->num_entries++;
+    }
+    return 0;
+}
+
+
+int resolve_corner(int num_positions, int num_uvs, int num_normals, ObjCorner *corner) {
+    // remap negative indices
+    corner->vi  = (corner->vi  < 0) ? corner->vi  + num_positions : corner->vi;
+    corner->vti = (corner->vti < 0) ? corner->vti + num_uvs       : corner->vti;
+    corner->vni = (corner->vni < 0) ? corner->vni + num_normals   : corner->vni;
+    // bounds check indices
+    if (corner->vi  < 0 || corner->vi  >= num_positions
+     || corner->vti < 0 || corner->vti >= num_uvs
+     || corner->vni < 0 || corner->vni >= num_normals)
+        return 1;  // index out of bounds
+    return 0;
+}
+
+
+// add one corner of a polygon; polygons are triangulated as a fan
+// -- n is the corner's position in the polygon
+static int add_polygon_corner(ObjFile *obj, Geometry *geo, ObjCorner corner, int n, uint32_t *first, uint32_t *prev) {
+    uint32_t index;
+    if (add_corner(obj, geo, corner.vi, corner.vti, corner.vni, &index) != 0)
+        return 1;  // out of memory (geo.vertices)
+    if (n == 0) {
+        *first = index;
+    } else if (n >= 2) {
+        if (reserve_geometry(geo, 0, 3) != 0)
+            return 6;  // out of memory (geo.indices)
+        geo->indices[geo->num_indices + 0] = *first;
+        geo->indices[geo->num_indices + 1] = *prev;
+        geo->indices[geo->num_indices + 2] = index;
+        geo->num_indices += 3;
     }
-    if (i == 0)
-        return 3;  // empty token; *vi was not set
+    *prev = index;
     return 0;
 }
 
 
-int read_face(FILE *file, char* c, ObjFile *obj, Geometry *geo) {
-    int first_vertex = geo->num_vertices;
+int read_face(Reader *reader, ObjFile *obj, Geometry *geo) {
+    uint32_t first_index = 0;
+    uint32_t prev_index = 0;
     int num_vertices = 0;
-    while (*c != '\n') {
-        if (geo->num_vertices + 1 >= geo->max_vertices)
-            return 1;  // out of memory (geo.vertices)
-        int vi, vti, vni;
-        if (read_vertex_token(file, c, &vi, &vti, &vni) != 0)
+    // NOTE: consume_whitespace first so trailing whitespace doesn't read as a token
+    while (consume_whitespace(reader) == 0 && *reader->head != '\n') {
+        ObjCorner corner;
+        if (read_corner(reader, &obj->face_layout, &corner) != 0)
             return 2;  // failed to parse token
         // NOTE: haven't checked if the user tried to use 0 as an index
-        if (vi == 0)  // must've been set to 0 by user
+        if (corner.vi == 0)  // must've been set to 0 by user
             return 3;  // indices start from 1 (0 is reserved for unset)
-        // remap negative indices
-        vi  = (vi  < 0) ? vi  + obj->num_positions : vi;
-        vti = (vti < 0) ? vti + obj->num_uvs       : vti;
-        vni = (vni < 0) ? vni + obj->num_normals   : vni;
-        // bounds check indices
-        if (vi  < 0 || vi  >= obj->num_positions
-         || vti < 0 || vti >= obj->num_uvs
-         || vni < 0 || vni >= obj->num_normals)
+        if (resolve_corner(obj->num_positions, obj->num_uvs, obj->num_normals, &corner) != 0)
             return 4;  // index out of bounds
-        // append vertex to geo
-        Vertex vertex = {
-            .position = obj->positions[vi],
-            .normal = obj->normals[vni],
-            .uv = obj->uvs[vti]};
-        geo->vertices[geo->num_vertices] = vertex;
-        geo->num_vertices++;
+        int err = add_polygon_corner(obj, geo, corner, num_vertices, &first_index, &prev_index);
+        if (err != 0)
+            return err;
         num_vertices++;
     }
 
     if (num_vertices < 3)
         return 5;  // invalid polygon
 
-    // triangle fan polygon
-    for (int i = 2; i < num_vertices; i++) {
-        if (geo->num_indices + 3 >= geo->max_indices)
-            return 6;  // out of memory (geo.indices)
-        geo->indices[geo->num_indices + 0] = first_vertex + 0;
-        geo->indices[geo->num_indices + 1] = first_vertex + i - 1;
-        geo->indices[geo->num_indices + 2] = first_vertex + i;
-        geo->num_indices += 3;
-    }
+    return 0;
+}
 
+
+int reserve_geometry(Geometry *geo, int num_vertices, int num_indices) {
+    int min_vertices = geo->num_vertices + num_vertices;
+    int min_indices  = geo->num_indices  + num_indices;
+    if (min_vertices <= geo->max_vertices && min_indices <= geo->max_indices)
+        return 0;
+    if (geo->arena == NULL)
+        return 1;  // fixed size buffers are full
+    if (arena_grow(geo->arena, (void**)&geo->vertices, &geo->max_vertices, min_vertices, sizeof(Vertex)) != 0
+     || arena_grow(geo->arena, (void**)&geo->indices, &geo->max_indices, min_indices, sizeof(uint32_t)) != 0)
+        return 2;  // out of memory
     return 0;
 }
 
 
-int read_obj(char* path, Geometry *geo) {
-    // NOTE: roughly copied from render_gl.c:read_glsl
-    // TODO: src/file_io.{c,h}
-    // -- int open(char* path, FILE *file, long *filesize);  // error handler
-    // -- int read(FILE *file, int length, void *dest);  // EOF checker
-    FILE *file = fopen(path, "r");
-    if (file == NULL) {  // most likely file not found
-        fprintf(stderr, "failed to open file: %s\n", path);
-        return 1;
+Geometry geometry_lod(Geometry *geo, int level) {
+    Geometry view = *geo;
+    view.arena = NULL;
+    view.num_lods = 0;
+    if (geo->num_lods > 0) {
+        view.indices = &geo->indices[geo->lods[level].first_index];
+        view.num_indices = view.max_indices = geo->lods[level].num_indices;
     }
+    return view;
+}
 
-    if (fseek(file, 0, SEEK_END) != 0) {
-        fprintf(stderr, "seek failed: %s\n", path);
-        fclose(file);
-        return 1;
+
+void prescan_obj(Reader reader, ObjCounts *counts) {
+    *counts = (ObjCounts){0, 0, 0, 0, 0};
+    while (reader.head < reader.end) {
+        const char *line = reader.head;
+        if (line[0] == 'f') {
+            // count whitespace -> token transitions
+            counts->num_faces++;
+            bool in_token = false;
+            for (reader.head++; reader.head < reader.end && *reader.head != '\n'; reader.head++) {
+                bool is_token = !is_whitespace(*reader.head);
+                if (is_token && !in_token)
+                    counts->num_corners++;
+                in_token = is_token;
+            }
+        } else {
+            if (line[0] == 'v' && reader.end - line > 1) {
+                switch (line[1]) {
+                    case ' ': case '\t': counts->num_positions++; break;
+                    case 't': counts->num_uvs++; break;
+                    case 'n': counts->num_normals++; break;
+                    default: break;
+                }
+            }
+            consume_line(&reader);
+        }
+        if (reader.head < reader.end)
+            reader.head++;  // newline
     }
-    long file_length = ftell(file);
-    if (file_length == 0) {
-        fprintf(stderr, "file is empty: %s", path);
-        fclose(file);
-        return 1;
+}
+
+
+// grow obj storage for 1 more element of the type opcode declares
+static int reserve_obj(ObjFile *obj, char opcode) {
+    switch (opcode) {
+        case 'v':
+            return arena_grow(obj->arena, (void**)&obj->positions, &obj->max_positions, obj->num_positions + 1, sizeof(Vec3));
+        case 't':
+            return arena_grow(obj->arena, (void**)&obj->uvs, &obj->max_uvs, obj->num_uvs + 1, sizeof(Vec2));
+        case 'n':
+            return arena_grow(obj->arena, (void**)&obj->normals, &obj->max_normals, obj->num_normals + 1, sizeof(Vec3));
+        default:
+            return 0;
     }
-    rewind(file);
+}
 
-    // obj state
-    Vec3 positions[1024] = {{0, 0, 0}};
-    Vec3 normals[1024] = {{0, 0, 0}};
-    Vec2 uvs[1024] = {{0, 0}};
-
-    ObjFile obj = {
-        .num_positions = 1,
-        .num_normals = 1,
-        .num_uvs = 1,
-        .max_positions = sizeof(positions) / sizeof(Vec3),
-        .max_normals = sizeof(normals) / sizeof(Vec3),
-        .max_uvs = sizeof(uvs) / sizeof(Vec2),
-        .positions = positions,
-        .normals = normals,
-        .uvs = uvs,
+
+// size obj arrays for counts
+// -- first is 1 if slot 0 holds the default for unset indices, 0 for chunks
+static int init_obj(ObjFile *obj, Arena *arena, ObjCounts *counts, int first) {
+    *obj = (ObjFile){
+        .num_positions = first,
+        .num_normals = first,
+        .num_uvs = first,
+        .max_positions = 0,
+        .max_normals = 0,
+        .max_uvs = 0,
+        .positions = NULL,
+        .normals = NULL,
+        .uvs = NULL,
+        .arena = arena,
+        .weld = NULL,
+        .face_layout = FACE_UNKNOWN,
     };
+    if (arena_grow(arena, (void**)&obj->positions, &obj->max_positions, counts->num_positions + 1, sizeof(Vec3)) != 0
+     || arena_grow(arena, (void**)&obj->normals, &obj->max_normals, counts->num_normals + 1, sizeof(Vec3)) != 0
+     || arena_grow(arena, (void**)&obj->uvs, &obj->max_uvs, counts->num_uvs + 1, sizeof(Vec2)) != 0)
+        return 1;  // out of memory
+    obj->positions[0] = (Vec3){0, 0, 0};
+    obj->normals[0] = (Vec3){0, 0, 0};
+    obj->uvs[0] = (Vec2){0, 0};
+    return 0;
+}
 
-    // parse
-    char c = '\n';  // last char read
-    char opcode = '\0';
-    int  line_number = 1;
-    bool eof_reached = false;
-    bool failed = false;
-    while (!failed && !eof_reached) {  // loop over lines
-        if (c != '\n'
-         || read_opcode(file, &c, &opcode) != 0) {
-            failed = true;
+
+// store a face's raw corners; they're resolved once every chunk is parsed
+static int record_face(Reader *reader, ObjChunk *chunk, int line_number) {
+    if (arena_grow(&chunk->arena, (void**)&chunk->faces, &chunk->max_faces, chunk->num_faces + 1, sizeof(ObjFace)) != 0)
+        return 1;  // out of memory
+    ObjFace *face = &chunk->faces[chunk->num_faces];
+    *face = (ObjFace){
+        .num_corners = 0,
+        .line_number = line_number,
+        .num_positions = chunk->obj.num_positions,
+        .num_uvs = chunk->obj.num_uvs,
+        .num_normals = chunk->obj.num_normals};
+    // NOTE: corners only count once the whole face is valid; a failed face leaves no trace
+    int first_corner = chunk->num_corners;
+    int result = 0;
+    while (consume_whitespace(reader) == 0 && *reader->head != '\n') {
+        if (arena_grow(&chunk->arena, (void**)&chunk->corners, &chunk->max_corners, first_corner + face->num_corners + 1, sizeof(ObjCorner)) != 0) {
+            result = 1;  // out of memory
+            break;
+        }
+        ObjCorner *corner = &chunk->corners[first_corner + face->num_corners];
+        if (read_corner(reader, &chunk->obj.face_layout, corner) != 0) {
+            result = 2;  // failed to parse token
+            break;
+        }
+        if (corner->vi == 0) {
+            result = 3;  // indices start from 1 (0 is reserved for unset)
             break;
         }
+        face->num_corners++;
+    }
+    if (result == 0 && face->num_corners < 3)
+        result = 5;  // invalid polygon
+    if (result != 0)
+        return result;
+    chunk->num_corners += face->num_corners;
+    chunk->num_faces++;
+    return 0;
+}
+
+
+// parse line by line until EOF or an error
+// -- faces go straight into geo, or are recorded into chunk if it isn't NULL
+// -- *line_number is left on the line that failed
+static int parse_lines(Reader *reader, ObjFile *obj, Geometry *geo, ObjChunk *chunk, int *line_number) {
+    char opcode = '\0';
+    while (reader->head < reader->end) {  // loop over lines
+        if (read_opcode(reader, &opcode) != 0
+         || reserve_obj(obj, opcode) != 0)
+            return 1;
         // parse line
+        bool failed = false;
         switch (opcode) {
             case 'v':
-                if (read_float_token(file, &c, &obj.positions[obj.num_positions].x) != 0
-                 || read_float_token(file, &c, &obj.positions[obj.num_positions].y) != 0
-                 || read_float_token(file, &c, &obj.positions[obj.num_positions].z) != 0)
-                    failed = true;
-                obj.num_positions++;
-                if (obj.num_positions >= obj.max_positions)
+                if (read_float_token(reader, &obj->positions[obj->num_positions].x) != 0
+                 || read_float_token(reader, &obj->positions[obj->num_positions].y) != 0
+                 || read_float_token(reader, &obj->positions[obj->num_positions].z) != 0)
                     failed = true;
+                obj->num_positions++;
                 break;
             case 't':  // 'vt'
-                if (read_float_token(file, &c, &obj.uvs[obj.num_uvs].x) != 0
-                 || read_float_token(file, &c, &obj.uvs[obj.num_uvs].y) != 0)
-                    failed = true;
-                obj.num_uvs++;
-                if (obj.num_uvs >= obj.max_uvs)
+                if (read_float_token(reader, &obj->uvs[obj->num_uvs].x) != 0
+                 || read_float_token(reader, &obj->uvs[obj->num_uvs].y) != 0)
                     failed = true;
+                obj->num_uvs++;
                 break;
             case 'n':  // 'vn'
-                if (read_float_token(file, &c, &obj.normals[obj.num_normals].x) != 0
-                 || read_float_token(file, &c, &obj.normals[obj.num_normals].y) != 0
-                 || read_float_token(file, &c, &obj.normals[obj.num_normals].z) != 0)
-                    failed = true;
-                obj.num_normals++;
-                if (obj.num_normals >= obj.max_normals)
+                if (read_float_token(reader, &obj->normals[obj->num_normals].x) != 0
+                 || read_float_token(reader, &obj->normals[obj->num_normals].y) != 0
+                 || read_float_token(reader, &obj->normals[obj->num_normals].z) != 0)
                     failed = true;
+                obj->num_normals++;
                 break;
             case 'f':
-                if (read_face(file, &c, &obj, geo) != 0)
-                    failed = true;
+                if (chunk != NULL)
+                    failed = (record_face(reader, chunk, *line_number) != 0);
+                else
+                    failed = (read_face(reader, obj, geo) != 0);
                 break;
             case '\n':  // empty line
                 break;
             default:  // skip to end of line
-                consume_line(file, &c);
+                consume_line(reader);
                 break;
         }
+        if (failed)
+            return 1;
 
         // trailing whitespace
         // NOTE: no terminating newline is ok
-        if (c != '\n') {
-            if (consume_whitespace(file, &c) != 0)
-                eof_reached = true;
+        if (consume_whitespace(reader) != 0)
+            return 0;  // EOF
+        if (*reader->head != '\n')
+            return 2;  // junk after the last token
+        reader->head++;  // newline
+
+        (*line_number)++;
+    }
+    return 0;
+}
+
+
+static int parse_obj_serial(Reader reader, ObjOptions *options, Geometry *geo, int *line_number) {
+    ObjStats *stats = options->stats;
+    double start = (stats != NULL) ? obj_clock() : 0;
+
+    // size everything up front; growth is only a fallback
+    ObjCounts counts;
+    prescan_obj(reader, &counts);
+    if (stats != NULL) {
+        stats->prescan = obj_clock() - start;
+        stats->num_faces = counts.num_faces;
+        start = obj_clock();
+    }
+
+    // obj state
+    // NOTE: slot 0 of each array is the default for unset indices
+    Arena scratch;
+    init_arena(&scratch,
+        sizeof(Vec3) * (counts.num_positions + counts.num_normals + 2)
+      + sizeof(Vec2) * (counts.num_uvs + 1) + 256);
+    ObjFile obj;
+    WeldTable weld;
+
+    int result = init_obj(&obj, &scratch, &counts, 1);
+
+    if (result == 0 && options->weld) {
+        // NOTE: most meshes have ~1-2 unique corners per position
+        result = init_weld_table(&weld, &scratch, counts.num_positions * 2);
+        obj.weld = &weld;
+    }
+
+    if (result == 0 && geo->arena != NULL) {
+        int num_triangles = counts.num_corners - counts.num_faces * 2;
+        result = reserve_geometry(geo, counts.num_corners, (num_triangles > 0) ? num_triangles * 3 : 0);
+    }
+
+    if (result == 0)
+        result = parse_lines(&reader, &obj, geo, NULL, line_number);
+
+    free_arena(&scratch);
+    if (stats != NULL)
+        stats->parse = obj_clock() - start;
+    return result;
+}
+
+
+// thrd_start_t: parse one chunk into its own arena
+static int parse_chunk(void *data) {
+    ObjChunk *chunk = data;
+    ObjCounts counts;
+    prescan_obj(chunk->reader, &counts);
+    init_arena(&chunk->arena,
+        sizeof(Vec3) * (counts.num_positions + counts.num_normals + 2)
+      + sizeof(Vec2) * (counts.num_uvs + 1)
+      + sizeof(ObjFace) * counts.num_faces
+      + sizeof(ObjCorner) * counts.num_corners + 256);
+    if (init_obj(&chunk->obj, &chunk->arena, &counts, 0) != 0
+     || arena_grow(&chunk->arena, (void**)&chunk->faces, &chunk->max_faces, counts.num_faces, sizeof(ObjFace)) != 0
+     || arena_grow(&chunk->arena, (void**)&chunk->corners, &chunk->max_corners, counts.num_corners, sizeof(ObjCorner)) != 0) {
+        chunk->error_line = 1;
+        return 1;
+    }
+    int line_number = 1;
+    if (parse_lines(&chunk->reader, &chunk->obj, NULL, chunk, &line_number) != 0) {
+        chunk->error_line = line_number;
+        return 1;
+    }
+    chunk->num_lines = line_number - 1;
+    return 0;
+}
+
+
+// resolve a chunk's recorded corner against the merged obj
+static inline int resolve_chunk_corner(ObjChunk *chunk, ObjFace *face, ObjCorner *corner) {
+    // NOTE: counts match what the serial parser would've had on this line
+    return resolve_corner(
+        chunk->first_position + face->num_positions,
+        chunk->first_uv + face->num_uvs,
+        chunk->first_normal + face->num_normals,
+        corner);
+}
+
+
+// thrd_start_t: write a chunk's vertices & indices into its slice of geo
+// NOTE: unwelded only; vertex & index offsets are known ahead of time
+static int emit_chunk(void *data) {
+    ObjChunk *chunk = data;
+    ObjFile  *obj = chunk->merged;
+    Geometry *geo = chunk->geo;
+    uint32_t vertex = chunk->first_vertex;
+    int      index  = chunk->first_index;
+    ObjCorner *corner = chunk->corners;
+    for (int i = 0; i < chunk->num_faces; i++) {
+        ObjFace *face = &chunk->faces[i];
+        uint32_t first_vertex = vertex;
+        // whole face first; nothing is written for a face that fails
+        for (int j = 0; j < face->num_corners; j++) {
+            ObjCorner resolved = corner[j];
+            if (resolve_chunk_corner(chunk, face, &resolved) != 0) {
+                chunk->emit_error_line = face->line_number;
+                return 1;
+            }
         }
+        for (int j = 0; j < face->num_corners; j++, corner++) {
+            ObjCorner resolved = *corner;
+            resolve_chunk_corner(chunk, face, &resolved);
+            geo->vertices[vertex] = (Vertex){
+                .position = obj->positions[resolved.vi],
+                .normal = obj->normals[resolved.vni],
+                .uv = obj->uvs[resolved.vti]};
+            // triangle fan polygon
+            if (j >= 2) {
+                geo->indices[index + 0] = first_vertex;
+                geo->indices[index + 1] = vertex - 1;
+                geo->indices[index + 2] = vertex;
+                index += 3;
+            }
+            vertex++;
+        }
+    }
+    return 0;
+}
+
+
+// welding has to see corners in file order, so this runs on one thread
+static int weld_chunk(ObjChunk *chunk, ObjFile *obj, Geometry *geo) {
+    ObjCorner *corner = chunk->corners;
+    for (int i = 0; i < chunk->num_faces; i++) {
+        ObjFace *face = &chunk->faces[i];
+        uint32_t first_index = 0;
+        uint32_t prev_index = 0;
+        for (int j = 0; j < face->num_corners; j++, corner++) {
+            ObjCorner resolved = *corner;
+            if (resolve_chunk_corner(chunk, face, &resolved) != 0
+             || add_polygon_corner(obj, geo, resolved, j, &first_index, &prev_index) != 0) {
+                chunk->emit_error_line = face->line_number;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
 
-        line_number++;
 
-        if (ftell(file) == file_length)
-            eof_reached = true;
+// run func over chunks on their own threads & wait for all of them
+static void run_chunks(ObjChunk *chunks, int num_chunks, thrd_start_t func) {
+    thrd_t *threads = malloc(sizeof(thrd_t) * num_chunks);
+    bool   *started = calloc(num_chunks, sizeof(bool));
+    for (int i = 0; i < num_chunks; i++) {
+        if (threads != NULL && started != NULL
+         && thrd_create(&threads[i], func, &chunks[i]) == thrd_success)
+            started[i] = true;
+        else
+            func(&chunks[i]);  // couldn't spawn a thread, do it here
     }
+    for (int i = 0; i < num_chunks; i++) {
+        if (started != NULL && started[i])
+            thrd_join(threads[i], NULL);
+    }
+    free(threads);
+    free(started);
+}
 
-    fclose(file);
 
-    if (failed) {
-        fprintf(stderr, "failed to parse line %d\n", line_number - 1);
+static int parse_obj_parallel(Reader reader, ObjOptions *options, int num_chunks, Geometry *geo, int *line_number) {
+    ObjStats *stats = options->stats;
+    double phase_start = (stats != NULL) ? obj_clock() : 0;
+    ObjChunk *chunks = calloc(num_chunks, sizeof(ObjChunk));
+    if (chunks == NULL) {
+        *line_number = 1;
+        return 1;  // out of memory
+    }
+
+    // split into chunks of whole lines
+    const char *start = reader.head;
+    size_t length = reader.end - reader.head;
+    for (int i = 0; i < num_chunks; i++) {
+        const char *end = reader.end;
+        if (i < num_chunks - 1) {
+            end = reader.head + length * (i + 1) / num_chunks;
+            if (end < start)
+                end = start;  // previous chunk ran past this split
+            const char *newline = memchr(end, '\n', reader.end - end);
+            end = (newline != NULL) ? newline + 1 : reader.end;
+        }
+        chunks[i].reader = (Reader){.head = start, .end = end};
+        start = end;
+    }
+
+    if (stats != NULL) {
+        stats->prescan = obj_clock() - phase_start;
+        phase_start = obj_clock();
+    }
+
+    // phase 1: parse chunks in parallel
+    run_chunks(chunks, num_chunks, parse_chunk);
+    if (stats != NULL) {
+        stats->parse = obj_clock() - phase_start;
+        phase_start = obj_clock();
+    }
+
+    // prefix sums
+    // NOTE: nothing after the first chunk that failed is used
+    ObjCounts totals = {0, 0, 0, 0, 0};
+    int num_triangles = 0;
+    int num_lines = 0;
+    int num_parsed = num_chunks;
+    for (int i = 0; i < num_chunks; i++) {
+        ObjChunk *chunk = &chunks[i];
+        chunk->first_position = 1 + totals.num_positions;
+        chunk->first_uv       = 1 + totals.num_uvs;
+        chunk->first_normal   = 1 + totals.num_normals;
+        chunk->first_vertex   = geo->num_vertices + totals.num_corners;
+        chunk->first_index    = geo->num_indices + num_triangles * 3;
+        chunk->first_line     = num_lines;
+        totals.num_positions += chunk->obj.num_positions;
+        totals.num_uvs       += chunk->obj.num_uvs;
+        totals.num_normals   += chunk->obj.num_normals;
+        totals.num_faces     += chunk->num_faces;
+        totals.num_corners   += chunk->num_corners;
+        num_triangles        += chunk->num_corners - chunk->num_faces * 2;
+        num_lines            += chunk->num_lines;
+        if (chunk->error_line != 0) {
+            num_parsed = i + 1;
+            break;
+        }
+    }
+
+    // merge obj state
+    Arena scratch;
+    init_arena(&scratch,
+        sizeof(Vec3) * (totals.num_positions + totals.num_normals + 2)
+      + sizeof(Vec2) * (totals.num_uvs + 1) + 256);
+    ObjFile obj;
+    WeldTable weld;
+    int result = init_obj(&obj, &scratch, &totals, 1);
+    if (result == 0) {
+        for (int i = 0; i < num_parsed; i++) {
+            ObjChunk *chunk = &chunks[i];
+            memcpy(&obj.positions[chunk->first_position], chunk->obj.positions, sizeof(Vec3) * chunk->obj.num_positions);
+            memcpy(&obj.uvs[chunk->first_uv], chunk->obj.uvs, sizeof(Vec2) * chunk->obj.num_uvs);
+            memcpy(&obj.normals[chunk->first_normal], chunk->obj.normals, sizeof(Vec3) * chunk->obj.num_normals);
+        }
+        obj.num_positions += totals.num_positions;
+        obj.num_uvs       += totals.num_uvs;
+        obj.num_normals   += totals.num_normals;
+    }
+    if (stats != NULL) {
+        stats->merge = obj_clock() - phase_start;
+        stats->num_faces = totals.num_faces;
+        phase_start = obj_clock();
+    }
+
+    // phase 2: faces -> geo
+    if (result == 0 && options->weld) {
+        result = init_weld_table(&weld, &scratch, totals.num_positions * 2);
+        obj.weld = &weld;
+        if (result == 0)
+            result = reserve_geometry(geo, totals.num_corners, num_triangles * 3);
+        for (int i = 0; result == 0 && i < num_parsed; i++) {
+            if (weld_chunk(&chunks[i], &obj, geo) != 0)
+                break;  // error is picked up below
+        }
+    } else if (result == 0) {
+        result = reserve_geometry(geo, totals.num_corners, num_triangles * 3);
+        if (result == 0) {
+            for (int i = 0; i < num_parsed; i++) {
+                chunks[i].merged = &obj;
+                chunks[i].geo = geo;
+            }
+            run_chunks(chunks, num_parsed, emit_chunk);
+            // NOTE: a chunk that failed left its slice part written
+            bool emitted = true;
+            for (int i = 0; i < num_parsed; i++)
+                emitted = emitted && chunks[i].emit_error_line == 0;
+            if (emitted) {
+                geo->num_vertices += totals.num_corners;
+                geo->num_indices  += num_triangles * 3;
+            }
+        }
+    }
+    if (stats != NULL)
+        stats->emit = obj_clock() - phase_start;
+    if (result != 0)
+        *line_number = 1;
+
+    // first error in file order
+    for (int i = 0; result == 0 && i < num_parsed; i++) {
+        ObjChunk *chunk = &chunks[i];
+        if (chunk->emit_error_line != 0) {
+            *line_number = chunk->first_line + chunk->emit_error_line;
+            result = 1;
+        } else if (chunk->error_line != 0) {
+            *line_number = chunk->first_line + chunk->error_line;
+            result = 1;
+        }
+    }
+    if (result == 0)
+        *line_number = num_lines + 1;
+
+    free_arena(&scratch);
+    for (int i = 0; i < num_chunks; i++)
+        free_arena(&chunks[i].arena);
+    free(chunks);
+    return result;
+}
+
+
+static int count_threads(ObjOptions *options, size_t file_length, Geometry *geo) {
+    if (geo->arena == NULL)
+        return 1;  // fixed size buffers; keep it simple
+    int num_threads = options->num_threads;
+#ifdef _SC_NPROCESSORS_ONLN
+    if (num_threads <= 0)
+        num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    // NOTE: small files aren't worth the thread startup & merge
+    size_t max_chunks = file_length / OBJ_MIN_CHUNK_SIZE;
+    if ((size_t)num_threads > max_chunks)
+        num_threads = (int)max_chunks;
+    return (num_threads > 1) ? num_threads : 1;
+}
+
+
+int read_obj(char* path, Geometry *geo) {
+    ObjOptions options = {.weld = false, .optimise = false, .lods = 0, .num_threads = 0, .stats = NULL, .cancel = NULL};
+    return read_obj_options(path, &options, geo);
+}
+
+
+static bool cancelled(ObjOptions *options) {
+    return options->cancel != NULL && atomic_load_explicit(options->cancel, memory_order_relaxed);
+}
+
+
+int read_obj_options(char* path, ObjOptions *options, Geometry *geo) {
+    ObjStats *stats = options->stats;
+    double start = 0;
+    if (stats != NULL) {
+        *stats = (ObjStats){0};
+        start = obj_clock();
+    }
+
+    // NOTE: the whole file is mapped & parsed in place
+    // -- no per-byte stdio calls & no ftell per line
+    MappedFile file;
+    if (map_file(path, &file) != 0)
+        return 1;  // map_file prints its own errors
+    if (stats != NULL) {
+        stats->map = obj_clock() - start;
+        stats->file_length = file.length;
+    }
+    if (file.length == 0) {
+        fprintf(stderr, "file is empty: %s\n", path);
+        unmap_file(&file);
+        return 1;
+    }
+
+    Reader reader = {
+        .head = file.data,
+        .end = file.data + file.length};
+
+    int num_threads = count_threads(options, file.length, geo);
+    if (stats != NULL)
+        stats->num_threads = num_threads;
+    int line_number = 1;
+    int result = (num_threads > 1)
+        ? parse_obj_parallel(reader, options, num_threads, geo, &line_number)
+        : parse_obj_serial(reader, options, geo, &line_number);
+
+    unmap_file(&file);
+    if (result != 0) {
+        if (stats != NULL)
+            stats->total = obj_clock() - start;
+        fprintf(stderr, "failed to parse line %d\n", line_number);
         return 1;
     }
 
+    if (cancelled(options))
+        return 2;
+    if (options->lods > 1) {
+        double lods_start = (stats != NULL) ? obj_clock() : 0;
+        result = build_lods(geo, options->lods);
+        if (stats != NULL)
+            stats->lods = obj_clock() - lods_start;
+        if (result != 0)
+            fprintf(stderr, "failed to build LODs for %s\n", path);
+    }
+    if (result == 0 && cancelled(options))
+        return 2;
+    if (result == 0 && options->optimise) {
+        double optimise_start = (stats != NULL) ? obj_clock() : 0;
+        result = optimise_mesh(geo, VERTEX_CACHE_SIZE, OVERDRAW_THRESHOLD);
+        if (stats != NULL)
+            stats->optimise = obj_clock() - optimise_start;
+        if (result != 0)
+            fprintf(stderr, "failed to optimise %s\n", path);
+    }
+    if (stats != NULL)
+        stats->total = obj_clock() - start;
+    if (result != 0)
+        return 1;
+
     return 0;
 }
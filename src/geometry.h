@@ -1,10 +1,10 @@
 // Using C23 Standard
 #pragma once
 
-#include <stdio.h>
-// #include <stdlib.h>  // atof & atoi
+#include <stdatomic.h>
 #include <stdint.h>
 
+#include "arena.h"
 #include "vector.h"
 
 
@@ -15,6 +15,18 @@ typedef struct Vertex_s {
 } Vertex;
 
 
+// levels of detail per mesh, including the full mesh
+#define MAX_LODS  5
+
+
+// 1 level of detail; a run of Geometry.indices over the shared vertices
+typedef struct GeometryLod_s {
+    int    first_index;
+    int    num_indices;
+    float  error;  // model space distance from the full mesh (roughly); 0 for level 0
+} GeometryLod;
+
+
 typedef struct Geometry_s {
     int       num_vertices;
     int       max_vertices;
@@ -22,9 +34,51 @@ typedef struct Geometry_s {
     int       max_indices;
     Vertex   *vertices;
     uint32_t *indices;
+    // NOTE: if arena is NULL vertices & indices are fixed size buffers
+    // -- otherwise they grow into the arena as needed
+    Arena    *arena;
+    // levels of detail, full mesh first; see build_lods (simplify.h)
+    // -- 0 if indices are just the full mesh
+    int          num_lods;
+    GeometryLod  lods[MAX_LODS];
 } Geometry;
 
 
+// cursor into a file loaded w/ map_file
+// -- *head is the next char to be read
+typedef struct Reader_s {
+    const char *head;
+    const char *end;  // 1 past the last char
+} Reader;
+
+
+// (vi, vti, vni) -> index of the vertex already emitted for that corner
+typedef struct WeldEntry_s {
+    int       vi;  // 0 marks an empty slot
+    int       vti;
+    int       vni;
+    uint32_t  vertex;
+} WeldEntry;
+
+
+// open addressing (linear probing) hash table of WeldEntry
+typedef struct WeldTable_s {
+    int        num_entries;
+    int        max_entries;  // power of 2
+    WeldEntry *entries;
+} WeldTable;
+
+
+// which indices a face's "v/vt/vn" tokens have
+typedef enum FaceLayout_e {
+    FACE_UNKNOWN = 0,
+    FACE_V,        // v
+    FACE_V_VT,     // v/vt
+    FACE_V_VN,     // v//vn
+    FACE_V_VT_VN,  // v/vt/vn
+} FaceLayout;
+
+
 typedef struct ObjFile_s {
     int   num_positions;
     int   max_positions;
@@ -35,19 +89,139 @@ typedef struct ObjFile_s {
     Vec3 *positions;
     Vec3 *normals;
     Vec2 *uvs;
+    Arena *arena;  // scratch; freed when read_obj returns
+    WeldTable *weld;  // NULL unless welding
+    FaceLayout face_layout;  // of the last corner read
 } ObjFile;
 
 
+// per-phase wall clock timings, in seconds
+// -- filled in by read_obj_options when ObjOptions.stats isn't NULL
+// NOTE: phases that didn't run are left at 0
+typedef struct ObjStats_s {
+    double  map;      // map_file
+    double  prescan;  // serial: prescan_obj; parallel: splitting chunks
+    double  parse;    // serial: the whole parse; parallel: parse_chunk threads
+    double  merge;    // parallel: prefix sums & merging obj arrays
+    double  emit;     // parallel: faces -> geo (welded or not)
+    double  lods;     // build_lods
+    double  optimise; // optimise_mesh
+    double  total;
+    size_t  file_length;
+    int     num_threads;
+    int     num_faces;
+} ObjStats;
+
+
+typedef struct ObjOptions_s {
+    // share one vertex between all face corners w/ the same (v, vt, vn)
+    bool  weld;
+    // reorder triangles & vertices for the GPU w/ optimise_mesh (see optimise.h)
+    // NOTE: ~3x fewer vertex shader runs on welded meshes; pointless w/o weld (every corner is its own vertex)
+    bool  optimise;
+    // levels of detail to build w/ build_lods (see simplify.h); 0 or 1 for none
+    // NOTE: built before optimising; each level is optimised on its own
+    int   lods;
+    // 0 for 1 thread per core; 1 for the serial parser
+    // NOTE: output is identical either way
+    int   num_threads;
+    // optional; NULL to skip timing
+    ObjStats *stats;
+    // optional; NULL to always finish. read_obj_options gives up once it's true
+    // NOTE: only checked between phases (parse, LODs, optimise); each runs to its end
+    atomic_bool *cancel;
+} ObjOptions;
+
+
+// one face corner's indices; raw or resolved
+typedef struct ObjCorner_s {
+    int  vi;
+    int  vti;
+    int  vni;
+} ObjCorner;
+
+
+// a face recorded by a worker thread, resolved after all chunks are parsed
+typedef struct ObjFace_s {
+    int  num_corners;
+    int  line_number;  // relative to the chunk
+    // chunk's counts when the face was read; for negative indices
+    int  num_positions;
+    int  num_uvs;
+    int  num_normals;
+} ObjFace;
+
+
+// smallest slice of a file worth giving its own thread
+#define OBJ_MIN_CHUNK_SIZE  (1 << 20)
+
+
+// newline aligned slice of a file, parsed on its own thread
+typedef struct ObjChunk_s {
+    Reader     reader;
+    Arena      arena;
+    ObjFile    obj;  // NOTE: no slot 0 defaults; counts are local
+    int        num_faces;
+    int        max_faces;
+    ObjFace   *faces;
+    int        num_corners;
+    int        max_corners;
+    ObjCorner *corners;  // raw indices, as written in the file
+    int        num_lines;
+    int        error_line;  // 0 unless parsing failed
+    int        emit_error_line;  // 0 unless resolving faces failed
+    // global offsets (prefix sums over earlier chunks)
+    int        first_position;
+    int        first_uv;
+    int        first_normal;
+    int        first_vertex;
+    int        first_index;
+    int        first_line;
+    // merged state, for emit_chunk
+    ObjFile   *merged;
+    Geometry  *geo;
+} ObjChunk;
+
+
+// quick pass over a file to size buffers before parsing
+// NOTE: counts are exact for well formed files
+typedef struct ObjCounts_s {
+    int num_positions;
+    int num_normals;
+    int num_uvs;
+    int num_faces;
+    int num_corners;  // vertex tokens across all faces
+} ObjCounts;
+
+
 // .obj file parser
 int read_obj(char* path, Geometry *geo);
+// 2 if options->cancel was set; nothing is printed
+int read_obj_options(char* path, ObjOptions *options, Geometry *geo);
+void prescan_obj(Reader reader, ObjCounts *counts);
+// make room for more vertices & indices; fails on fixed size buffers
+int reserve_geometry(Geometry *geo, int num_vertices, int num_indices);
+// 1 level's indices over all of geo's vertices; geo itself if it has no LODs
+// NOTE: a fixed size view into geo; don't grow it
+Geometry geometry_lod(Geometry *geo, int level);
 // general parser tools
-int consume_line(FILE *file, char *c);
-int consume_whitespace(FILE *file, char *c);
+// NOTE: both stop on the newline, they don't consume it
+int consume_line(Reader *reader);
+int consume_whitespace(Reader *reader);
 // get line start
-int read_opcode(FILE *file, char *c, char *opcode);
+int read_opcode(Reader *reader, char *opcode);
 // NOTE: consumes leading whitespace
-int read_token(FILE *file, char *c, int len_token, char* token);
-int read_float_token(FILE *file, char *c, float *dest);
-int read_vertex_token(FILE *file, char *c, int *vi, int *vni, int *vti);
+int read_token(Reader *reader, int len_token, char* token);
+int read_float_token(Reader *reader, float *dest);
+int read_vertex_token(Reader *reader, int *vi, int *vti, int *vni);
+// read_vertex_token w/ a fast path for the last layout seen
+// NOTE: doesn't consume leading whitespace
+int read_corner(Reader *reader, FaceLayout *layout, ObjCorner *corner);
 // read multiple vertices
-int read_face(FILE *file, char* c, ObjFile *obj, Geometry *geo);
+int read_face(Reader *reader, ObjFile *obj, Geometry *geo);
+// remap negative indices & bounds check against the counts so far
+int resolve_corner(int num_positions, int num_uvs, int num_normals, ObjCorner *corner);
+// vertex welding
+int init_weld_table(WeldTable *table, Arena *arena, int expected_vertices);
+// append (or reuse, if welding) the vertex for one resolved face corner
+int add_corner(ObjFile *obj, Geometry *geo, int vi, int vti, int vni, uint32_t *index);
@@ -0,0 +1,283 @@
+// Using C23 Standard
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpu_profile.h"
+
+
+static const GLenum stat_targets[GPU_STAT_COUNT] = {
+    GL_VERTEX_SHADER_INVOCATIONS_ARB,
+    GL_FRAGMENT_SHADER_INVOCATIONS_ARB,
+    GL_CLIPPING_INPUT_PRIMITIVES_ARB,
+    GL_CLIPPING_OUTPUT_PRIMITIVES_ARB};
+
+static const char *pass_names[GPU_PASS_COUNT] = {"cube", "reproject", "direct", "overlay"};
+static const char *stat_names[GPU_STAT_COUNT] = {"vertices", "fragments", "clip_in", "clip_out"};
+
+
+int init_gpu_profiler(GpuProfiler *profiler) {
+    memset(profiler, 0, sizeof(*profiler));
+    profiler->history = malloc(sizeof(GpuFrame) * GPU_PROFILE_HISTORY);
+    if (profiler->history == NULL) {
+        fprintf(stderr, "out of memory for GPU profiler history\n");
+        return 1;
+    }
+    profiler->has_stats = GLEW_ARB_pipeline_statistics_query || GLEW_VERSION_4_6;
+
+    // NOTE: glGenQueries for the statistics; Mesa's glCreateQueries only
+    // takes their targets in 4.6 contexts, & glBeginQuery creates them anyway
+    for (int i = 0; i < GPU_PROFILE_LATENCY; i++) {
+        glCreateQueries(GL_TIMESTAMP, 2 + 2 * GPU_PASS_COUNT, profiler->timestamps[i]);
+        if (profiler->has_stats)
+            glGenQueries(GPU_PASS_COUNT * GPU_STAT_COUNT, &profiler->stat_queries[i][0][0]);
+    }
+    return 0;
+}
+
+
+void free_gpu_profiler(GpuProfiler *profiler) {
+    for (int i = 0; i < GPU_PROFILE_LATENCY; i++) {
+        glDeleteQueries(2 + 2 * GPU_PASS_COUNT, profiler->timestamps[i]);
+        glDeleteQueries(GPU_PASS_COUNT * GPU_STAT_COUNT, &profiler->stat_queries[i][0][0]);
+    }
+    free(profiler->history);
+    memset(profiler, 0, sizeof(*profiler));
+}
+
+
+static bool query_ready(GLuint query) {
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available == GL_TRUE;
+}
+
+
+// slot's results -> history; false (& nothing read) if the GPU isn't done yet
+static bool collect_slot(GpuProfiler *profiler, int slot) {
+    GLuint *timestamps = profiler->timestamps[slot];
+    uint32_t passes = profiler->passes[slot];
+    // NOTE: checking every query; the spec doesn't promise they finish in order
+    if (!query_ready(timestamps[1]))
+        return false;
+    for (int i = 0; i < GPU_PASS_COUNT; i++) {
+        if ((passes >> i & 1) == 0)
+            continue;
+        if (!query_ready(timestamps[2 + 2 * i]) || !query_ready(timestamps[3 + 2 * i]))
+            return false;
+        for (int j = 0; j < GPU_STAT_COUNT && profiler->has_stats; j++) {
+            if (!query_ready(profiler->stat_queries[slot][i][j]))
+                return false;
+        }
+    }
+
+    int index;
+    if (profiler->history_count < GPU_PROFILE_HISTORY) {
+        index = (profiler->history_head + profiler->history_count) % GPU_PROFILE_HISTORY;
+        profiler->history_count++;
+    } else {  // overwrite the oldest
+        index = profiler->history_head;
+        profiler->history_head = (profiler->history_head + 1) % GPU_PROFILE_HISTORY;
+    }
+    GpuFrame *frame = &profiler->history[index];
+    memset(frame, 0, sizeof(*frame));
+    frame->frame = profiler->slot_frames[slot];
+    frame->passes = passes;
+
+    GLuint64 begin, end;
+    glGetQueryObjectui64v(timestamps[0], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(timestamps[1], GL_QUERY_RESULT, &end);
+    frame->total_ms = (end - begin) * 1e-6;
+    for (int i = 0; i < GPU_PASS_COUNT; i++) {
+        if ((passes >> i & 1) == 0)
+            continue;
+        glGetQueryObjectui64v(timestamps[2 + 2 * i], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(timestamps[3 + 2 * i], GL_QUERY_RESULT, &end);
+        frame->pass_ms[i] = (end - begin) * 1e-6;
+        for (int j = 0; j < GPU_STAT_COUNT && profiler->has_stats; j++) {
+            GLuint64 count;
+            glGetQueryObjectui64v(profiler->stat_queries[slot][i][j], GL_QUERY_RESULT, &count);
+            frame->stats[i][j] = count;
+        }
+    }
+    return true;
+}
+
+
+void gpu_begin_frame(GpuProfiler *profiler) {
+    if (profiler == NULL)
+        return;
+    int slot = profiler->frame % GPU_PROFILE_LATENCY;
+    // NOTE: never wait; if the GPU is this far behind, lose the frame
+    if (profiler->in_flight[slot] && !collect_slot(profiler, slot))
+        profiler->num_dropped++;
+    profiler->in_flight[slot] = false;
+    profiler->passes[slot] = 0;
+    profiler->slot_frames[slot] = profiler->frame;
+    glQueryCounter(profiler->timestamps[slot][0], GL_TIMESTAMP);
+}
+
+
+void gpu_end_frame(GpuProfiler *profiler) {
+    if (profiler == NULL)
+        return;
+    int slot = profiler->frame % GPU_PROFILE_LATENCY;
+    glQueryCounter(profiler->timestamps[slot][1], GL_TIMESTAMP);
+    profiler->in_flight[slot] = true;
+
+    // collect older frames, oldest first, as soon as they're ready
+    for (int age = GPU_PROFILE_LATENCY - 1; age > 0; age--) {
+        if (profiler->frame < (uint64_t)age)
+            continue;
+        int old_slot = (profiler->frame - age) % GPU_PROFILE_LATENCY;
+        if (profiler->in_flight[old_slot] && collect_slot(profiler, old_slot))
+            profiler->in_flight[old_slot] = false;
+    }
+    profiler->frame++;
+}
+
+
+void gpu_begin_pass(GpuProfiler *profiler, GpuPass pass) {
+    if (profiler == NULL)
+        return;
+    int slot = profiler->frame % GPU_PROFILE_LATENCY;
+    glQueryCounter(profiler->timestamps[slot][2 + 2 * pass], GL_TIMESTAMP);
+    for (int i = 0; i < GPU_STAT_COUNT && profiler->has_stats; i++)
+        glBeginQuery(stat_targets[i], profiler->stat_queries[slot][pass][i]);
+}
+
+
+void gpu_end_pass(GpuProfiler *profiler, GpuPass pass) {
+    if (profiler == NULL)
+        return;
+    int slot = profiler->frame % GPU_PROFILE_LATENCY;
+    for (int i = 0; i < GPU_STAT_COUNT && profiler->has_stats; i++)
+        glEndQuery(stat_targets[i]);
+    glQueryCounter(profiler->timestamps[slot][3 + 2 * pass], GL_TIMESTAMP);
+    profiler->passes[slot] |= 1u << pass;
+}
+
+
+GpuFrame *gpu_history(GpuProfiler *profiler, int i) {
+    if (profiler == NULL || i < 0 || i >= profiler->history_count)
+        return NULL;
+    return &profiler->history[(profiler->history_head + i) % GPU_PROFILE_HISTORY];
+}
+
+
+int write_gpu_profile_csv(GpuProfiler *profiler, char* path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "failed to open file for writing: %s\n", path);
+        return 1;
+    }
+    fprintf(file, "frame,total_ms");
+    for (int i = 0; i < GPU_PASS_COUNT; i++)
+        fprintf(file, ",%s_ms", pass_names[i]);
+    for (int i = 0; i < GPU_PASS_COUNT && profiler->has_stats; i++) {
+        for (int j = 0; j < GPU_STAT_COUNT; j++)
+            fprintf(file, ",%s_%s", pass_names[i], stat_names[j]);
+    }
+    fprintf(file, "\n");
+
+    for (int i = 0; i < profiler->history_count; i++) {
+        GpuFrame *frame = gpu_history(profiler, i);
+        fprintf(file, "%llu,%.4f", (unsigned long long)frame->frame, frame->total_ms);
+        for (int j = 0; j < GPU_PASS_COUNT; j++) {
+            if (frame->passes >> j & 1) {
+                fprintf(file, ",%.4f", frame->pass_ms[j]);
+            } else {
+                fprintf(file, ",");
+            }
+        }
+        for (int j = 0; j < GPU_PASS_COUNT && profiler->has_stats; j++) {
+            for (int k = 0; k < GPU_STAT_COUNT; k++) {
+                if (frame->passes >> j & 1) {
+                    fprintf(file, ",%llu", (unsigned long long)frame->stats[j][k]);
+                } else {
+                    fprintf(file, ",");
+                }
+            }
+        }
+        fprintf(file, "\n");
+    }
+
+    if (fclose(file) != 0) {
+        fprintf(stderr, "failed to write: %s\n", path);
+        return 2;
+    }
+    return 0;
+}
+
+
+// -- overlay --
+
+#define OVERLAY_FRAMES   30  // averaged, so the bars don't flicker
+#define OVERLAY_MARGIN    8  // pixels
+#define OVERLAY_BAR       6
+#define OVERLAY_GAP       3
+
+
+static const GLfloat pass_colours[GPU_PASS_COUNT][3] = {
+    {0.9f, 0.5f, 0.1f},   // cube
+    {0.2f, 0.7f, 0.9f},   // reproject
+    {0.6f, 0.9f, 0.2f},   // direct
+    {0.8f, 0.3f, 0.8f}};  // overlay
+
+
+static void fill_rect(int x, int y, int width, int height, GLfloat r, GLfloat g, GLfloat b) {
+    if (width <= 0 || height <= 0)
+        return;
+    glScissor(x, y, width, height);
+    glClearColor(r, g, b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+
+void draw_gpu_overlay(GpuProfiler *profiler, GLuint framebuffer, int width, int height, float budget_ms) {
+    if (profiler == NULL || !profiler->overlay)
+        return;
+    gpu_begin_pass(profiler, GPU_PASS_OVERLAY);
+
+    // recent averages; a row per pass, then the whole frame
+    double mean_ms[GPU_PASS_COUNT + 1] = {0};
+    int num_frames[GPU_PASS_COUNT + 1] = {0};
+    for (int i = profiler->history_count - 1; i >= 0 && i >= profiler->history_count - OVERLAY_FRAMES; i--) {
+        GpuFrame *frame = gpu_history(profiler, i);
+        for (int j = 0; j < GPU_PASS_COUNT; j++) {
+            if (frame->passes >> j & 1) {
+                mean_ms[j] += frame->pass_ms[j];
+                num_frames[j]++;
+            }
+        }
+        mean_ms[GPU_PASS_COUNT] += frame->total_ms;
+        num_frames[GPU_PASS_COUNT]++;
+    }
+
+    GLfloat clear_colour[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_colour);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glEnable(GL_SCISSOR_TEST);
+
+    // NOTE: the budget is halfway along the track; overruns up to 2x still fit
+    int track = width / 3;
+    float pixels_per_ms = track * 0.5f / budget_ms;
+    int row_height = OVERLAY_BAR + OVERLAY_GAP;
+    int top = height - OVERLAY_MARGIN;  // GL window coords are bottom up
+    int num_rows = GPU_PASS_COUNT + 1;
+    fill_rect(OVERLAY_MARGIN, top - num_rows * row_height, track, num_rows * row_height, 0.1f, 0.1f, 0.1f);
+    for (int i = 0; i < num_rows; i++) {
+        if (num_frames[i] == 0)
+            continue;  // pass didn't run lately
+        int length = (int)(mean_ms[i] / num_frames[i] * pixels_per_ms);
+        length = (length > track) ? track : length;
+        const GLfloat *colour = (i < GPU_PASS_COUNT) ? pass_colours[i] : (GLfloat[3]){0.9f, 0.9f, 0.9f};
+        int y = top - (i + 1) * row_height + OVERLAY_GAP;
+        fill_rect(OVERLAY_MARGIN, y, length, OVERLAY_BAR, colour[0], colour[1], colour[2]);
+    }
+    fill_rect(OVERLAY_MARGIN + track / 2, top - num_rows * row_height, 1, num_rows * row_height, 1.0f, 0.2f, 0.2f);
+
+    glDisable(GL_SCISSOR_TEST);
+    glClearColor(clear_colour[0], clear_colour[1], clear_colour[2], clear_colour[3]);
+    gpu_end_pass(profiler, GPU_PASS_OVERLAY);
+}
@@ -0,0 +1,84 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdint.h>
+
+// GLEW (-lGLEW)
+#include <GL/glew.h>
+
+// OpenGL (-lGL)
+#include <GL/gl.h>
+
+
+// GPU timings & pipeline statistics per render pass
+// -- queries are read back GPU_PROFILE_LATENCY frames later, so they never stall
+// -- finished frames go into a ring of the last GPU_PROFILE_HISTORY frames
+#define GPU_PROFILE_LATENCY  3
+#define GPU_PROFILE_HISTORY  512
+
+
+typedef enum GpuPass_e {
+    GPU_PASS_CUBE,       // scene -> cube map
+    GPU_PASS_REPROJECT,  // cube map -> panini view
+    GPU_PASS_DIRECT,     // scene -> panini view, tessellated
+    GPU_PASS_OVERLAY,    // draw_gpu_overlay
+    GPU_PASS_COUNT,
+} GpuPass;
+
+
+// GL_ARB_pipeline_statistics_query counters (core in 4.6)
+typedef enum GpuStat_e {
+    GPU_STAT_VERTICES,   // vertex shader invocations
+    GPU_STAT_FRAGMENTS,  // fragment shader invocations
+    GPU_STAT_CLIP_IN,    // primitives into clipping
+    GPU_STAT_CLIP_OUT,   // primitives out of clipping
+    GPU_STAT_COUNT,
+} GpuStat;
+
+
+typedef struct GpuFrame_s {
+    uint64_t  frame;   // from 0, in gpu_begin_frame order
+    uint32_t  passes;  // 1 << GpuPass for each pass that ran
+    double    total_ms;  // gpu_begin_frame to gpu_end_frame
+    double    pass_ms[GPU_PASS_COUNT];
+    uint64_t  stats[GPU_PASS_COUNT][GPU_STAT_COUNT];  // all 0 w/o pipeline stats
+} GpuFrame;
+
+
+typedef struct GpuProfiler_s {
+    bool      has_stats;  // driver supports pipeline statistics
+    bool      overlay;    // draw_gpu_overlay does nothing if false
+    // queries, per frame in flight
+    // -- timestamps: frame begin & end, then begin & end of each pass
+    GLuint    timestamps[GPU_PROFILE_LATENCY][2 + 2 * GPU_PASS_COUNT];
+    GLuint    stat_queries[GPU_PROFILE_LATENCY][GPU_PASS_COUNT][GPU_STAT_COUNT];
+    uint32_t  passes[GPU_PROFILE_LATENCY];  // passes recorded into each slot
+    uint64_t  slot_frames[GPU_PROFILE_LATENCY];
+    bool      in_flight[GPU_PROFILE_LATENCY];
+    uint64_t  frame;  // current frame
+    uint64_t  num_dropped;  // frames whose results weren't ready in time
+    // finished frames, oldest first from history_head
+    GpuFrame *history;  // GPU_PROFILE_HISTORY of them
+    int       history_head;
+    int       history_count;
+} GpuProfiler;
+
+
+// NOTE: needs a current context
+int init_gpu_profiler(GpuProfiler *profiler);
+void free_gpu_profiler(GpuProfiler *profiler);
+
+// every function below does nothing if profiler is NULL
+// -- passes can run at most once per frame & must not overlap
+void gpu_begin_frame(GpuProfiler *profiler);
+void gpu_end_frame(GpuProfiler *profiler);
+void gpu_begin_pass(GpuProfiler *profiler, GpuPass pass);
+void gpu_end_pass(GpuProfiler *profiler, GpuPass pass);
+
+// history[i] oldest first; NULL if i is out of range
+GpuFrame *gpu_history(GpuProfiler *profiler, int i);
+// 1 row per frame in history; empty cells for passes that didn't run
+int write_gpu_profile_csv(GpuProfiler *profiler, char* path);
+// 1 bar per pass, averaged over recent frames; budget_ms is the bar's midpoint
+// NOTE: scissored clears only; no shaders, textures or vertex state touched
+void draw_gpu_overlay(GpuProfiler *profiler, GLuint framebuffer, int width, int height, float budget_ms);
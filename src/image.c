@@ -0,0 +1,150 @@
+// Using C23 Standard
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "file_io.h"
+#include "image.h"
+
+
+int init_image(Image *image, int width, int height) {
+    image->width = 0;
+    image->height = 0;
+    image->pixels = NULL;
+    if (width <= 0 || height <= 0)
+        return 1;  // invalid size
+    image->pixels = malloc(sizeof(uint32_t) * (size_t)width * height);
+    if (image->pixels == NULL) {
+        fprintf(stderr, "out of memory for %dx%d image\n", width, height);
+        return 2;
+    }
+    image->width = width;
+    image->height = height;
+    return 0;
+}
+
+
+void free_image(Image *image) {
+    free(image->pixels);
+    image->pixels = NULL;
+    image->width = 0;
+    image->height = 0;
+}
+
+
+// whitespace & '#' comments between header fields
+static void skip_ppm_whitespace(const char **head, const char *end) {
+    while (*head < end) {
+        char c = **head;
+        if (c == '#') {
+            while (*head < end && **head != '\n')
+                (*head)++;
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            (*head)++;
+        } else {
+            return;
+        }
+    }
+}
+
+
+static int read_ppm_int(const char **head, const char *end, int *dest) {
+    skip_ppm_whitespace(head, end);
+    int value = 0;
+    int digits = 0;
+    while (*head < end && **head >= '0' && **head <= '9' && digits < 9) {
+        value = value * 10 + (**head - '0');
+        (*head)++;
+        digits++;
+    }
+    *dest = value;
+    return (digits > 0) ? 0 : 1;
+}
+
+
+int read_ppm(char* path, Image *image) {
+    MappedFile file;
+    if (map_file(path, &file) != 0)
+        return 1;  // map_file prints its own errors
+
+    const char *head = file.data;
+    const char *end = file.data + file.length;
+    int width, height, maxval;
+    if (file.length < 2 || head[0] != 'P' || head[1] != '6') {
+        fprintf(stderr, "not a binary .ppm (P6): %s\n", path);
+        unmap_file(&file);
+        return 2;
+    }
+    head += 2;
+    if (read_ppm_int(&head, end, &width) != 0
+     || read_ppm_int(&head, end, &height) != 0
+     || read_ppm_int(&head, end, &maxval) != 0
+     || head >= end) {
+        fprintf(stderr, "bad .ppm header: %s\n", path);
+        unmap_file(&file);
+        return 2;
+    }
+    head++;  // exactly 1 whitespace char before the raster
+    if (maxval != 255) {
+        fprintf(stderr, "only 8-bit .ppm is supported: %s (maxval %d)\n", path, maxval);
+        unmap_file(&file);
+        return 3;
+    }
+    if (width <= 0 || height <= 0 || (size_t)(end - head) < (size_t)width * height * 3) {
+        fprintf(stderr, ".ppm is truncated: %s\n", path);
+        unmap_file(&file);
+        return 4;
+    }
+
+    if (init_image(image, width, height) != 0) {
+        unmap_file(&file);
+        return 5;
+    }
+    const uint8_t *rgb = (const uint8_t*)head;
+    uint8_t *rgba = (uint8_t*)image->pixels;
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        rgba[i * 4 + 0] = rgb[i * 3 + 0];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+    unmap_file(&file);
+    return 0;
+}
+
+
+int write_ppm(char* path, Image *image) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "failed to open file for writing: %s\n", path);
+        return 1;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", image->width, image->height);
+
+    // NOTE: 1 row at a time; no full size RGB copy
+    uint8_t *row = malloc((size_t)image->width * 3);
+    if (row == NULL) {
+        fclose(file);
+        return 2;
+    }
+    bool written = true;
+    const uint8_t *rgba = (const uint8_t*)image->pixels;
+    for (int y = 0; y < image->height && written; y++) {
+        const uint8_t *src = rgba + (size_t)y * image->width * 4;
+        for (int x = 0; x < image->width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        written = fwrite(row, 3, image->width, file) == (size_t)image->width;
+    }
+    free(row);
+    if (fclose(file) != 0)
+        written = false;
+    if (!written) {
+        fprintf(stderr, "failed to write: %s\n", path);
+        remove(path);
+        return 3;
+    }
+    return 0;
+}
@@ -0,0 +1,22 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdint.h>
+
+
+// 8-bit RGBA, rows top to bottom
+// NOTE: pixels are 4 bytes in memory order R, G, B, A
+// -- uploads as GL_RGBA + GL_UNSIGNED_BYTE w/o any swizzle
+typedef struct Image_s {
+    int       width;
+    int       height;
+    uint32_t *pixels;
+} Image;
+
+
+int init_image(Image *image, int width, int height);
+void free_image(Image *image);
+
+// binary .ppm (P6, maxval 255); alpha is dropped on write & 255 on read
+int read_ppm(char* path, Image *image);
+int write_ppm(char* path, Image *image);
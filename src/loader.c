@@ -0,0 +1,143 @@
+// Using C23 Standard
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "loader.h"
+
+
+void init_spsc_queue(SpscQueue *queue) {
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+}
+
+
+bool spsc_push(SpscQueue *queue, void *item) {
+    // NOTE: only this side writes tail, so a relaxed load sees our own last store
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail - head == SPSC_CAPACITY)
+        return false;
+    queue->slots[tail % SPSC_CAPACITY] = item;
+    // release; the slot (& whatever item points at) is written before the consumer sees it
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+
+bool spsc_pop(SpscQueue *queue, void **item) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head == tail)
+        return false;
+    *item = queue->slots[head % SPSC_CAPACITY];
+    // release; the slot is read before the producer can reuse it
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+
+static int load(Loader *loader, LoadRequest *request, LoadResult *result) {
+    ObjOptions options = request->options;
+    switch (request->kind) {
+        case LOAD_MESH:
+            result->mesh = malloc(sizeof(MeshCache));
+            if (result->mesh == NULL) {
+                fprintf(stderr, "out of memory loading %s\n", request->path);
+                return 1;
+            }
+            // NOTE: stop_loader gives up on a stale cache's rebuild between phases
+            options.cancel = &loader->cancel;
+            if (open_mesh(request->path, request->cache_path, &options, result->mesh) != 0) {
+                free(result->mesh);
+                result->mesh = NULL;
+                return 1;  // open_mesh prints its own errors
+            }
+            return 0;
+        case LOAD_SHADER:
+            if (map_file(request->path, &result->file) != 0)
+                return 1;  // map_file prints its own errors
+            return 0;
+        default:
+            fprintf(stderr, "unknown load request: %d\n", request->kind);
+            return 1;
+    }
+}
+
+
+// thrd_start_t: every request in order, each pushed as soon as it's done
+static int loader_main(void *data) {
+    Loader *loader = data;
+    for (int i = 0; i < loader->num_requests; i++) {
+        if (atomic_load_explicit(&loader->cancel, memory_order_relaxed))
+            return 1;
+        LoadResult *result = &loader->results[i];
+        result->status = load(loader, &loader->requests[i], result);
+        // NOTE: only full if the GL thread stops polling; wait for it, or stop_loader
+        while (!spsc_push(&loader->queue, result)) {
+            if (atomic_load_explicit(&loader->cancel, memory_order_relaxed))
+                return 1;
+            thrd_yield();
+        }
+    }
+    return 0;
+}
+
+
+int start_loader(Loader *loader, int num_requests, LoadRequest *requests) {
+    loader->num_requests = num_requests;
+    loader->requests = requests;
+    loader->results = calloc(num_requests, sizeof(LoadResult));
+    loader->running = false;
+    loader->num_popped = 0;
+    if (loader->results == NULL) {
+        fprintf(stderr, "out of memory for %d load requests\n", num_requests);
+        return 1;
+    }
+    for (int i = 0; i < num_requests; i++)
+        loader->results[i].request = i;
+    init_spsc_queue(&loader->queue);
+    atomic_init(&loader->cancel, false);
+    if (thrd_create(&loader->thread, loader_main, loader) != thrd_success) {
+        fprintf(stderr, "failed to start the loader thread\n");
+        free(loader->results);
+        loader->results = NULL;
+        return 1;
+    }
+    loader->running = true;
+    return 0;
+}
+
+
+LoadResult *poll_loader(Loader *loader) {
+    void *result;
+    if (!loader->running || !spsc_pop(&loader->queue, &result))
+        return NULL;
+    loader->num_popped++;
+    return result;
+}
+
+
+int loader_pending(Loader *loader) {
+    return loader->num_requests - loader->num_popped;
+}
+
+
+void stop_loader(Loader *loader) {
+    if (loader->running) {
+        atomic_store_explicit(&loader->cancel, true, memory_order_relaxed);
+        thrd_join(loader->thread, NULL);
+        loader->running = false;
+    }
+    // NOTE: the thread is gone; results it never pushed are safe to free too
+    for (int i = 0; loader->results != NULL && i < loader->num_requests; i++) {
+        LoadResult *result = &loader->results[i];
+        if (result->mesh != NULL) {
+            close_mesh(result->mesh);
+            free(result->mesh);
+        }
+        if (result->file.data != NULL)
+            unmap_file(&result->file);
+    }
+    free(loader->results);
+    loader->results = NULL;
+}
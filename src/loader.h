@@ -0,0 +1,84 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdatomic.h>
+#include <stddef.h>
+// C11 threads (-pthread)
+#include <threads.h>
+
+#include "file_io.h"
+#include "geometry.h"
+#include "mesh_cache.h"
+
+
+// lock-free single producer, single consumer ring of pointers
+// -- head & tail count up forever; slot = count % SPSC_CAPACITY
+// -- only the producer writes tail & only the consumer writes head, each on
+//    its own cache line so neither side's stores bounce the other's loads
+// NOTE: SPSC_CAPACITY must be a power of 2
+#define SPSC_CAPACITY  64
+
+
+typedef struct SpscQueue_s {
+    alignas(64) atomic_size_t  head;  // next slot to pop
+    alignas(64) atomic_size_t  tail;  // next slot to push
+    alignas(64) void  *slots[SPSC_CAPACITY];
+} SpscQueue;
+
+
+void init_spsc_queue(SpscQueue *queue);
+// producer only; false if the queue is full
+bool spsc_push(SpscQueue *queue, void *item);
+// consumer only; false if the queue is empty
+bool spsc_pop(SpscQueue *queue, void **item);
+
+
+// background asset loading
+// -- 1 thread works through the requests in order, w/o touching GL
+// -- each finished asset goes back to the GL thread through an SpscQueue,
+//    which uploads it; nothing waits on the other side
+typedef enum LoadKind_e {
+    LOAD_MESH,    // open_mesh; parses the .obj if the cache is stale
+    LOAD_SHADER,  // the whole file, for ShaderStage.source
+} LoadKind;
+
+
+typedef struct LoadRequest_s {
+    LoadKind    kind;
+    char       *path;        // .obj or .glsl
+    char       *cache_path;  // LOAD_MESH; .mesh
+    ObjOptions  options;     // LOAD_MESH
+} LoadRequest;
+
+
+// NOTE: owned by the Loader; valid until stop_loader
+typedef struct LoadResult_s {
+    int         request;  // index into Loader.requests
+    int         status;   // 0 on success; the loader thread prints its own errors
+    MeshCache  *mesh;     // LOAD_MESH; NULL on failure
+    MappedFile  file;     // LOAD_SHADER; data is NULL on failure
+} LoadResult;
+
+
+typedef struct Loader_s {
+    int           num_requests;
+    LoadRequest  *requests;  // must outlive the thread
+    LoadResult   *results;   // 1 per request, in request order
+    SpscQueue     queue;     // LoadResult*; loader thread -> GL thread
+    atomic_bool   cancel;
+    thrd_t        thread;
+    bool          running;
+    int           num_popped;  // GL thread side
+} Loader;
+
+
+// starts the loader thread on requests; returns at once
+int start_loader(Loader *loader, int num_requests, LoadRequest *requests);
+// the next finished asset, w/o waiting; NULL if nothing new is ready
+LoadResult *poll_loader(Loader *loader);
+// requests not popped by poll_loader yet; 0 once everything is in
+int loader_pending(Loader *loader);
+// cancels any requests not started yet, joins the thread & frees every result
+// NOTE: waits for the request in flight; a mesh rebuild stops at its next phase
+// (see ObjOptions.cancel), but a single parse, LOD build or optimise runs to the end
+void stop_loader(Loader *loader);
@@ -0,0 +1,352 @@
+// Using C23 Standard
+// Math (-lm)
+#include <math.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "matrix.h"
+
+
+#define PI  3.14159265358979f
+
+
+Mat4 Mat4_identity() {
+    Mat4 out = {{
+        {1, 0, 0, 0},
+        {0, 1, 0, 0},
+        {0, 0, 1, 0},
+        {0, 0, 0, 1}}};
+    return out;
+}
+
+
+Mat4 Mat4_translation(Vec3 offset) {
+    Mat4 out = Mat4_identity();
+    out.m[3][0] = offset.x;
+    out.m[3][1] = offset.y;
+    out.m[3][2] = offset.z;
+    return out;
+}
+
+
+Mat4 Mat4_transpose(const Mat4 *m) {
+    Mat4 out;
+#ifdef __SSE2__
+    __m128 c0 = _mm_load_ps(m->m[0]);
+    __m128 c1 = _mm_load_ps(m->m[1]);
+    __m128 c2 = _mm_load_ps(m->m[2]);
+    __m128 c3 = _mm_load_ps(m->m[3]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_store_ps(out.m[0], c0);
+    _mm_store_ps(out.m[1], c1);
+    _mm_store_ps(out.m[2], c2);
+    _mm_store_ps(out.m[3], c3);
+#else
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++)
+            out.m[i][j] = m->m[j][i];
+    }
+#endif
+    return out;
+}
+
+
+Mat4 Mat4_multiply(const Mat4 *a, const Mat4 *b) {
+    // out column j = a * (b column j); a linear combination of a's columns
+    Mat4 out;
+#if defined(__AVX__)
+    // 2 output columns per register
+    __m256 a0 = _mm256_broadcast_ps((const __m128*)a->m[0]);
+    __m256 a1 = _mm256_broadcast_ps((const __m128*)a->m[1]);
+    __m256 a2 = _mm256_broadcast_ps((const __m128*)a->m[2]);
+    __m256 a3 = _mm256_broadcast_ps((const __m128*)a->m[3]);
+    for (int j = 0; j < 4; j += 2) {
+        __m256 bj = _mm256_loadu_ps(b->m[j]);  // columns j & j + 1
+        __m256 sum = _mm256_mul_ps(a0, _mm256_permute_ps(bj, 0x00));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(a1, _mm256_permute_ps(bj, 0x55)));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(a2, _mm256_permute_ps(bj, 0xAA)));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(a3, _mm256_permute_ps(bj, 0xFF)));
+        _mm256_storeu_ps(out.m[j], sum);
+    }
+#elif defined(__SSE2__)
+    __m128 a0 = _mm_load_ps(a->m[0]);
+    __m128 a1 = _mm_load_ps(a->m[1]);
+    __m128 a2 = _mm_load_ps(a->m[2]);
+    __m128 a3 = _mm_load_ps(a->m[3]);
+    for (int j = 0; j < 4; j++) {
+        __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(b->m[j][0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(b->m[j][1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(b->m[j][2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(b->m[j][3])));
+        _mm_store_ps(out.m[j], sum);
+    }
+#else
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+            out.m[j][i] = a->m[0][i] * b->m[j][0] + a->m[1][i] * b->m[j][1]
+                        + a->m[2][i] * b->m[j][2] + a->m[3][i] * b->m[j][3];
+        }
+    }
+#endif
+    return out;
+}
+
+
+Vec4 Mat4_transform(const Mat4 *m, Vec4 v) {
+    Vec4 out;
+#ifdef __SSE2__
+    __m128 sum = _mm_mul_ps(_mm_load_ps(m->m[0]), _mm_set1_ps(v.x));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(m->m[1]), _mm_set1_ps(v.y)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(m->m[2]), _mm_set1_ps(v.z)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(m->m[3]), _mm_set1_ps(v.w)));
+    _mm_store_ps(&out.x, sum);
+#else
+    float *o = &out.x;
+    for (int i = 0; i < 4; i++)
+        o[i] = m->m[0][i] * v.x + m->m[1][i] * v.y + m->m[2][i] * v.z + m->m[3][i] * v.w;
+#endif
+    return out;
+}
+
+
+// -- inverse --
+// NOTE: block method; M = | A B |, each block 2x2, stored (0,0) (0,1) (1,0) (1,1)
+//                         | C D |
+// -- works on the transpose as well, so storage order doesn't matter
+#ifdef __SSE2__
+#define SHUFFLE(a, b, x, y, z, w)  _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define SWIZZLE(v, x, y, z, w)     SHUFFLE(v, v, x, y, z, w)
+
+
+// 2x2 a * b
+static inline __m128 mat2_multiply(__m128 a, __m128 b) {
+    return _mm_add_ps(
+        _mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)),
+        _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+
+// 2x2 adjugate(a) * b
+static inline __m128 mat2_adjugate_multiply(__m128 a, __m128 b) {
+    return _mm_sub_ps(
+        _mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b),
+        _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+
+// 2x2 a * adjugate(b)
+static inline __m128 mat2_multiply_adjugate(__m128 a, __m128 b) {
+    return _mm_sub_ps(
+        _mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)),
+        _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+#endif
+
+
+int Mat4_inverse(const Mat4 *m, Mat4 *dest) {
+#ifdef __SSE2__
+    __m128 c0 = _mm_load_ps(m->m[0]);
+    __m128 c1 = _mm_load_ps(m->m[1]);
+    __m128 c2 = _mm_load_ps(m->m[2]);
+    __m128 c3 = _mm_load_ps(m->m[3]);
+    __m128 a = _mm_movelh_ps(c0, c1);
+    __m128 b = _mm_movehl_ps(c1, c0);
+    __m128 c = _mm_movelh_ps(c2, c3);
+    __m128 d = _mm_movehl_ps(c3, c2);
+
+    // |A| |B| |C| |D|
+    __m128 sub_det = _mm_sub_ps(
+        _mm_mul_ps(SHUFFLE(c0, c2, 0, 2, 0, 2), SHUFFLE(c1, c3, 1, 3, 1, 3)),
+        _mm_mul_ps(SHUFFLE(c0, c2, 1, 3, 1, 3), SHUFFLE(c1, c3, 0, 2, 0, 2)));
+    __m128 det_a = SWIZZLE(sub_det, 0, 0, 0, 0);
+    __m128 det_b = SWIZZLE(sub_det, 1, 1, 1, 1);
+    __m128 det_c = SWIZZLE(sub_det, 2, 2, 2, 2);
+    __m128 det_d = SWIZZLE(sub_det, 3, 3, 3, 3);
+
+    // inverse = 1 / |M| * | X Y |, w/ X, Y, Z & W found as their adjugates
+    //                     | Z W |
+    __m128 d_c = mat2_adjugate_multiply(d, c);
+    __m128 a_b = mat2_adjugate_multiply(a, b);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_multiply(b, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2_multiply(c, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_multiply_adjugate(d, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_multiply_adjugate(a, d_c));
+
+    // |M| = |A| |D| + |B| |C| - trace(A#B D#C)
+    __m128 trace = _mm_mul_ps(a_b, SWIZZLE(d_c, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, SWIZZLE(trace, 2, 3, 0, 1));
+    trace = _mm_add_ps(trace, SWIZZLE(trace, 1, 0, 3, 2));
+    __m128 det = _mm_sub_ps(
+        _mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), trace);
+    if (_mm_cvtss_f32(det) == 0.0f)
+        return 1;  // singular
+
+    // signs & 1 / |M|, then undo the adjugates while storing
+    __m128 inv_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    x = _mm_mul_ps(x, inv_det);
+    y = _mm_mul_ps(y, inv_det);
+    z = _mm_mul_ps(z, inv_det);
+    w = _mm_mul_ps(w, inv_det);
+    _mm_store_ps(dest->m[0], SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_store_ps(dest->m[1], SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_store_ps(dest->m[2], SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_store_ps(dest->m[3], SHUFFLE(z, w, 2, 0, 2, 0));
+    return 0;
+#else
+    // cofactors from 2x2 sub-determinants of the top & bottom 2 rows
+    const float (*a)[4] = m->m;
+    float s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+    float s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+    float s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+    float s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    float s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+    float s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+    float c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+    float c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+    float c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+    float c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+    float c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+    float c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+    float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (det == 0.0f)
+        return 1;  // singular
+    float inv = 1.0f / det;
+    Mat4 out;
+    out.m[0][0] = ( a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * inv;
+    out.m[0][1] = (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * inv;
+    out.m[0][2] = ( a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * inv;
+    out.m[0][3] = (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * inv;
+    out.m[1][0] = (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * inv;
+    out.m[1][1] = ( a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * inv;
+    out.m[1][2] = (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * inv;
+    out.m[1][3] = ( a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * inv;
+    out.m[2][0] = ( a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * inv;
+    out.m[2][1] = (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * inv;
+    out.m[2][2] = ( a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * inv;
+    out.m[2][3] = (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * inv;
+    out.m[3][0] = (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * inv;
+    out.m[3][1] = ( a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * inv;
+    out.m[3][2] = (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * inv;
+    out.m[3][3] = ( a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * inv;
+    *dest = out;
+    return 0;
+#endif
+}
+
+
+Mat4 Mat4_look_at(Vec3 eye, Vec3 target, Vec3 up) {
+    Vec3 forward = {target.x - eye.x, target.y - eye.y, target.z - eye.z};
+    Vec3_normalise(&forward);
+    Vec3 right = cross(forward, up);
+    Vec3_normalise(&right);
+    Vec3 true_up = cross(right, forward);
+
+    // rows are right, up & -forward; an orthonormal basis inverts by transposing
+    Mat4 out = {{
+        {right.x, true_up.x, -forward.x, 0},
+        {right.y, true_up.y, -forward.y, 0},
+        {right.z, true_up.z, -forward.z, 0},
+        {-dot(right, eye), -dot(true_up, eye), dot(forward, eye), 1}}};
+    return out;
+}
+
+
+Mat4 Mat4_perspective(float fov_y, float aspect, float near, float far) {
+    float f = 1.0f / tanf(fov_y * (PI / 360.0f));
+    float r = far - near;
+    Mat4 out = {{
+        {f / aspect, 0, 0, 0},
+        {0, f, 0, 0},
+        {0, 0, -(far + near) / r, -1},
+        {0, 0, -2.0f * far * near / r, 0}}};
+    return out;
+}
+
+
+// -- batch kernels --
+
+void Mat4_transform_points(const Mat4 *m, const void *points, size_t stride, size_t count, Vec4 *dest) {
+    const char *head = points;
+    size_t i = 0;
+#if defined(__AVX__)
+    // 2 points per register; column k is in both halves
+    __m256 c0 = _mm256_broadcast_ps((const __m128*)m->m[0]);
+    __m256 c1 = _mm256_broadcast_ps((const __m128*)m->m[1]);
+    __m256 c2 = _mm256_broadcast_ps((const __m128*)m->m[2]);
+    __m256 c3 = _mm256_broadcast_ps((const __m128*)m->m[3]);
+    for (; i + 2 <= count; i += 2) {
+        const float *p0 = (const float*)(head + i * stride);
+        const float *p1 = (const float*)(head + (i + 1) * stride);
+        __m256 sum = _mm256_add_ps(c3, _mm256_mul_ps(c0,
+            _mm256_set_m128(_mm_set1_ps(p1[0]), _mm_set1_ps(p0[0]))));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(c1,
+            _mm256_set_m128(_mm_set1_ps(p1[1]), _mm_set1_ps(p0[1]))));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(c2,
+            _mm256_set_m128(_mm_set1_ps(p1[2]), _mm_set1_ps(p0[2]))));
+        _mm256_storeu_ps(&dest[i].x, sum);
+    }
+#endif
+#ifdef __SSE2__
+    __m128 s0 = _mm_load_ps(m->m[0]);
+    __m128 s1 = _mm_load_ps(m->m[1]);
+    __m128 s2 = _mm_load_ps(m->m[2]);
+    __m128 s3 = _mm_load_ps(m->m[3]);
+    for (; i < count; i++) {
+        const float *p = (const float*)(head + i * stride);
+        __m128 sum = _mm_add_ps(s3, _mm_mul_ps(s0, _mm_set1_ps(p[0])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(s1, _mm_set1_ps(p[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(s2, _mm_set1_ps(p[2])));
+        _mm_store_ps(&dest[i].x, sum);
+    }
+#else
+    for (; i < count; i++) {
+        const float *p = (const float*)(head + i * stride);
+        float *out = &dest[i].x;
+        for (int j = 0; j < 4; j++)
+            out[j] = m->m[3][j] + m->m[0][j] * p[0] + m->m[1][j] * p[1] + m->m[2][j] * p[2];
+    }
+#endif
+}
+
+
+void Vec3_normalise_batch(Vec3 *vectors, size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    // 4 Vec3s are 3 registers; transposed to x, y & z & back
+    float *head = &vectors[0].x;
+    for (; i + 4 <= count; i += 4) {
+        float *v = head + i * 3;
+        __m128 a = _mm_loadu_ps(v);      // x0 y0 z0 x1
+        __m128 b = _mm_loadu_ps(v + 4);  // y1 z1 x2 y2
+        __m128 c = _mm_loadu_ps(v + 8);  // z2 x3 y3 z3
+        __m128 x = SHUFFLE(a, SHUFFLE(b, c, 2, 2, 1, 1), 0, 3, 0, 2);
+        __m128 y = SHUFFLE(SHUFFLE(a, b, 1, 1, 0, 0), SHUFFLE(b, c, 3, 3, 2, 2), 0, 2, 0, 2);
+        __m128 z = SHUFFLE(SHUFFLE(a, b, 2, 2, 1, 1), c, 0, 2, 0, 3);
+
+        // NOTE: same operations & order as Vec3_normalise, so the same result
+        __m128 magnitude = _mm_sqrt_ps(_mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+        x = _mm_div_ps(x, magnitude);
+        y = _mm_div_ps(y, magnitude);
+        z = _mm_div_ps(z, magnitude);
+
+        __m128 xy_low = _mm_unpacklo_ps(x, y);   // x0 y0 x1 y1
+        __m128 xy_high = _mm_unpackhi_ps(x, y);  // x2 y2 x3 y3
+        __m128 zx = SHUFFLE(z, x, 0, 0, 1, 1);   // z0 z0 x1 x1
+        __m128 yz = SHUFFLE(y, z, 1, 1, 1, 1);   // y1 y1 z1 z1
+        __m128 zxy = SHUFFLE(z, xy_high, 2, 2, 2, 3);  // z2 z2 x3 y3
+        __m128 xyz = SHUFFLE(zxy, z, 2, 3, 3, 3);      // x3 y3 z3 z3
+        _mm_storeu_ps(v, SHUFFLE(xy_low, zx, 0, 1, 0, 2));
+        _mm_storeu_ps(v + 4, SHUFFLE(yz, xy_high, 0, 2, 0, 1));
+        _mm_storeu_ps(v + 8, SHUFFLE(zxy, xyz, 0, 2, 1, 2));
+    }
+#endif
+    for (; i < count; i++)
+        Vec3_normalise(&vectors[i]);
+}
@@ -0,0 +1,37 @@
+// Using C23 Standard
+#pragma once
+
+#include <stddef.h>
+
+#include "vector.h"
+
+
+// 4x4 float matrix; column major, like GLSL & glUniformMatrix4fv w/ GL_FALSE
+// -- m[column][row]; columns are where x, y & z go, then the translation
+// NOTE: vectors are columns; Mat4_multiply(a, b) applies b first
+// NOTE: SSE2 & AVX paths if the compiler targets them, scalar otherwise
+typedef struct Mat4_s {
+    alignas(16) float m[4][4];
+} Mat4;
+
+
+Mat4 Mat4_identity();
+Mat4 Mat4_translation(Vec3 offset);
+Mat4 Mat4_transpose(const Mat4 *m);
+Mat4 Mat4_multiply(const Mat4 *a, const Mat4 *b);
+Vec4 Mat4_transform(const Mat4 *m, Vec4 v);
+// general inverse; 1 if m is singular (dest is left as is)
+int Mat4_inverse(const Mat4 *m, Mat4 *dest);
+
+// GL conventions; view space looks down -Z, clip z is [-w, +w]
+// -- look_at: world -> view
+Mat4 Mat4_look_at(Vec3 eye, Vec3 target, Vec3 up);
+// -- fov_y in degrees; 90 & aspect 1 for cube map faces
+Mat4 Mat4_perspective(float fov_y, float aspect, float near, float far);
+
+// batch kernels, for CPU side culling & mesh processing
+// -- points are read stride bytes apart, so Vertex arrays work as is
+// -- dest[i] = m * (points[i], 1)
+void Mat4_transform_points(const Mat4 *m, const void *points, size_t stride, size_t count, Vec4 *dest);
+// in place; zero length vectors become NaN, same as Vec3_normalise
+void Vec3_normalise_batch(Vec3 *vectors, size_t count);
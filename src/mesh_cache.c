@@ -0,0 +1,259 @@
+// Using C23 Standard
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mesh_cache.h"
+
+
+static uint64_t header_checksum(MeshCacheHeader header) {
+    header.checksum = 0;
+    return fnv1a_64(&header, sizeof(header), FNV_OFFSET_BASIS);
+}
+
+
+// FNV-1a over 8 byte words in 4 interleaved lanes, w/ a shift to fold high bits down
+// -- bytewise fnv1a_64 is ~1 byte per multiply; too slow to run over every load
+// -- chain calls by passing the last result as hash, like fnv1a_64
+static uint64_t array_checksum(const void *array, uint64_t length, uint64_t hash) {
+    const char *data = array;
+    uint64_t lanes[4] = {hash, hash ^ 1, hash ^ 2, hash ^ 3};
+    uint64_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        for (int j = 0; j < 4; j++) {
+            uint64_t word;
+            memcpy(&word, data + i + 8 * j, sizeof(word));
+            lanes[j] = (lanes[j] ^ word) * 0x00000100000001B3ull;  // FNV prime
+            lanes[j] ^= lanes[j] >> 32;
+        }
+    }
+    hash = fnv1a_64(lanes, sizeof(lanes), hash);
+    return fnv1a_64(data + i, length - i, hash);
+}
+
+
+// every array after the header, in file order
+static uint64_t payload_checksum(MeshCacheHeader *header, Vertex *vertices, uint32_t *indices, PackedVertex *packed, uint16_t *short_indices) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = array_checksum(vertices, sizeof(Vertex) * (uint64_t)header->num_vertices, hash);
+    hash = array_checksum(indices, sizeof(uint32_t) * (uint64_t)header->num_indices, hash);
+    hash = array_checksum(packed, sizeof(PackedVertex) * (uint64_t)header->num_vertices, hash);
+    return array_checksum(short_indices, sizeof(uint16_t) * (uint64_t)header->num_short_indices, hash);
+}
+
+
+static uint32_t mesh_cache_flags(ObjOptions *options) {
+    uint32_t lods = (options->lods > 1) ? (uint32_t)options->lods : 0;
+    return (options->weld ? MESH_CACHE_WELDED : 0)
+         | (options->optimise ? MESH_CACHE_OPTIMISED : 0)
+         | lods << MESH_CACHE_LODS_SHIFT;
+}
+
+
+// every LOD is a whole number of triangles inside the index array
+static bool valid_lods(MeshCacheHeader *header) {
+    if (header->num_lods > MAX_LODS)
+        return false;
+    for (uint32_t i = 0; i < header->num_lods; i++) {
+        GeometryLod *lod = &header->lods[i];
+        if (lod->first_index < 0 || lod->num_indices < 0 || lod->num_indices % 3 != 0
+         || (uint64_t)lod->first_index + lod->num_indices > header->num_indices)
+            return false;
+    }
+    return true;
+}
+
+
+int write_mesh_cache(char* path, Geometry *geo, char* source_path, ObjOptions *options) {
+    MeshCacheHeader header = {
+        .magic = MESH_CACHE_MAGIC,
+        .version = MESH_CACHE_VERSION,
+        .header_size = sizeof(MeshCacheHeader),
+        .vertex_size = sizeof(Vertex),
+        .index_size = sizeof(uint32_t),
+        .num_vertices = geo->num_vertices,
+        .num_indices = geo->num_indices,
+        .flags = mesh_cache_flags(options),
+        .num_lods = geo->num_lods,
+        .packed_vertex_size = sizeof(PackedVertex),
+        .num_short_indices = (geo->num_vertices <= UINT16_MAX + 1) ? geo->num_indices : 0,
+        .source_mtime = 0,
+        .source_size = 0,
+        .payload_checksum = 0,
+        .checksum = 0};
+    memcpy(header.lods, geo->lods, sizeof(header.lods));
+    vertex_bounds(geo, &header.bounds);
+    if (file_info(source_path, &header.source_mtime, &header.source_size) != 0) {
+        fprintf(stderr, "failed to stat mesh source: %s\n", source_path);
+        return 1;
+    }
+
+    // VERTEX_PACKED's arrays; packed once here, not on every populate
+    // NOTE: + 1 so empty meshes don't malloc(0)
+    PackedVertex *packed = malloc(sizeof(PackedVertex) * geo->num_vertices + 1);
+    uint16_t *short_indices = malloc(sizeof(uint16_t) * header.num_short_indices + 1);
+    if (packed == NULL || short_indices == NULL) {
+        fprintf(stderr, "out of memory packing %d vertices for mesh cache: %s\n", geo->num_vertices, path);
+        free(packed);
+        free(short_indices);
+        return 2;
+    }
+    pack_vertices(geo, &header.bounds, packed);
+    for (uint32_t i = 0; i < header.num_short_indices; i++)
+        short_indices[i] = (uint16_t)geo->indices[i];
+    header.payload_checksum = payload_checksum(&header, geo->vertices, geo->indices, packed, short_indices);
+    header.checksum = header_checksum(header);
+
+    // write to a temp file & rename, so a crash never leaves a torn cache
+    char temp_path[4096];
+    if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", path) >= (int)sizeof(temp_path)) {
+        fprintf(stderr, "mesh cache path is too long: %s\n", path);
+        free(packed);
+        free(short_indices);
+        return 3;
+    }
+    FILE *file = fopen(temp_path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "failed to open mesh cache for writing: %s\n", temp_path);
+        free(packed);
+        free(short_indices);
+        return 4;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(geo->vertices, sizeof(Vertex), geo->num_vertices, file) == (size_t)geo->num_vertices
+        && fwrite(geo->indices, sizeof(uint32_t), geo->num_indices, file) == (size_t)geo->num_indices
+        && fwrite(packed, sizeof(PackedVertex), geo->num_vertices, file) == (size_t)geo->num_vertices
+        && fwrite(short_indices, sizeof(uint16_t), header.num_short_indices, file) == header.num_short_indices;
+    free(packed);
+    free(short_indices);
+    if (fclose(file) != 0)
+        written = false;
+    if (!written || rename(temp_path, path) != 0) {
+        fprintf(stderr, "failed to write mesh cache: %s\n", path);
+        remove(temp_path);
+        return 5;
+    }
+    return 0;
+}
+
+
+int load_mesh_cache(char* path, char* source_path, ObjOptions *options, MeshCache *cache) {
+    int64_t  cache_mtime, source_mtime;
+    uint64_t cache_size, source_size;
+    if (file_info(path, &cache_mtime, &cache_size) != 0)
+        return 1;  // no cache
+    if (file_info(source_path, &source_mtime, &source_size) != 0)
+        return 2;  // no source; NOTE: could trust the cache here
+    if (source_mtime > cache_mtime)
+        return 3;  // .obj was edited since the cache was built
+    if (cache_size < sizeof(MeshCacheHeader))
+        return 4;  // truncated
+
+    if (map_file(path, &cache->file) != 0)
+        return 5;
+
+    MeshCacheHeader header;
+    memcpy(&header, cache->file.data, sizeof(header));
+    uint64_t expected_size = header.header_size
+        + (uint64_t)header.num_vertices * (sizeof(Vertex) + sizeof(PackedVertex))
+        + (uint64_t)header.num_indices * sizeof(uint32_t)
+        + (uint64_t)header.num_short_indices * sizeof(uint16_t);
+    int err = 0;
+    if (header.magic != MESH_CACHE_MAGIC
+     || header.version != MESH_CACHE_VERSION
+     || header.checksum != header_checksum(header)
+     || !valid_lods(&header)
+     || (header.num_short_indices != 0 && header.num_short_indices != header.num_indices))
+        err = 6;  // not a cache, or corrupt
+    else if (header.header_size != sizeof(MeshCacheHeader)
+          || header.vertex_size != sizeof(Vertex)
+          || header.index_size != sizeof(uint32_t)
+          || header.packed_vertex_size != sizeof(PackedVertex)
+          || expected_size != cache->file.length)
+        err = 7;  // built by another version of panini
+    else if (header.source_mtime != source_mtime
+          || header.source_size != source_size
+          || header.flags != mesh_cache_flags(options))
+        err = 8;  // built from a different .obj, or w/ different options
+    if (err != 0) {
+        unmap_file(&cache->file);
+        return err;
+    }
+
+    // NOTE: the mapping is read only; none of these must be written to
+    char *data = cache->file.data + header.header_size;
+    Vertex *vertices = (Vertex*)data;
+    uint32_t *indices = (uint32_t*)(data + sizeof(Vertex) * header.num_vertices);
+    PackedVertex *packed = (PackedVertex*)(data + sizeof(Vertex) * header.num_vertices + sizeof(uint32_t) * header.num_indices);
+    uint16_t *short_indices = (uint16_t*)(packed + header.num_vertices);
+    // NOTE: the sizes matched, but a bad sector or a partial copy could still hold garbage
+    if (header.payload_checksum != payload_checksum(&header, vertices, indices, packed, short_indices)) {
+        unmap_file(&cache->file);
+        return 9;  // corrupt arrays
+    }
+    cache->geo = (Geometry){
+        .num_vertices = header.num_vertices,
+        .max_vertices = header.num_vertices,
+        .num_indices = header.num_indices,
+        .max_indices = header.num_indices,
+        .vertices = vertices,
+        .indices = indices,
+        .arena = NULL,
+        .num_lods = header.num_lods};
+    memcpy(cache->geo.lods, header.lods, sizeof(header.lods));
+    cache->packed = (PackedMesh){
+        .bounds = header.bounds,
+        .vertices = packed,
+        .indices = (header.num_short_indices != 0) ? short_indices : NULL};
+    return 0;
+}
+
+
+int open_mesh(char* obj_path, char* cache_path, ObjOptions *options, MeshCache *cache) {
+    cache->file = (MappedFile){NULL, 0, false};
+    cache->packed = (PackedMesh){.vertices = NULL, .indices = NULL};
+    init_arena(&cache->arena, 0);
+    if (load_mesh_cache(cache_path, obj_path, options, cache) == 0)
+        return 0;
+
+    // (re)build from the .obj
+    cache->geo = (Geometry){
+        .num_vertices = 0,
+        .max_vertices = 0,
+        .num_indices = 0,
+        .max_indices = 0,
+        .vertices = NULL,
+        .indices = NULL,
+        .arena = &cache->arena,
+        .num_lods = 0};
+    if (read_obj_options(obj_path, options, &cache->geo) != 0) {
+        free_arena(&cache->arena);
+        return 1;
+    }
+    if (write_mesh_cache(cache_path, &cache->geo, obj_path, options) != 0)
+        return 0;  // not fatal; use the parsed geo this time
+    // swap the parsed geo for the mapped copy, keeps the arena footprint short lived
+    Geometry parsed = cache->geo;
+    if (load_mesh_cache(cache_path, obj_path, options, cache) != 0) {
+        cache->geo = parsed;
+        return 0;
+    }
+    free_arena(&cache->arena);
+    return 0;
+}
+
+
+void close_mesh(MeshCache *cache) {
+    unmap_file(&cache->file);
+    free_arena(&cache->arena);
+    cache->geo = (Geometry){
+        .num_vertices = 0,
+        .max_vertices = 0,
+        .num_indices = 0,
+        .max_indices = 0,
+        .vertices = NULL,
+        .indices = NULL,
+        .arena = NULL,
+        .num_lods = 0};
+    cache->packed = (PackedMesh){.vertices = NULL, .indices = NULL};
+}
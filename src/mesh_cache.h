@@ -0,0 +1,69 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdint.h>
+
+#include "arena.h"
+#include "file_io.h"
+#include "geometry.h"
+#include "packed_vertex.h"
+
+
+// binary mesh cache; skips the .obj text parse on repeat loads
+// -- file layout: MeshCacheHeader, Vertex[num_vertices], uint32_t[num_indices],
+//    PackedVertex[num_vertices], uint16_t[num_short_indices]
+// -- every array is laid out exactly as populate uploads it; VERTEX_FLOAT uses
+//    the first 2, VERTEX_PACKED the last 2 (or uint32_t indices if there are none)
+// -- indices hold every LOD; the header says where each starts
+// NOTE: native endianness; caches aren't portable between machines
+#define MESH_CACHE_MAGIC    0x48534D50  // "PMSH"
+#define MESH_CACHE_VERSION  5
+
+// flags; ObjOptions the cache was built with
+#define MESH_CACHE_WELDED     0x1
+#define MESH_CACHE_OPTIMISED  0x2
+// ObjOptions.lods (0 for none) in the bits above this
+#define MESH_CACHE_LODS_SHIFT  8
+
+
+typedef struct MeshCacheHeader_s {
+    uint32_t  magic;
+    uint32_t  version;
+    uint32_t  header_size;  // offset of the vertex array
+    uint32_t  vertex_size;  // sizeof(Vertex); catches layout changes
+    uint32_t  index_size;
+    uint32_t  num_vertices;
+    uint32_t  num_indices;
+    uint32_t  flags;
+    uint32_t  num_lods;  // Geometry.num_lods
+    uint32_t  packed_vertex_size;  // sizeof(PackedVertex)
+    uint32_t  num_short_indices;   // num_indices, or 0 if any vertex is past UINT16_MAX
+    GeometryLod   lods[MAX_LODS];
+    VertexBounds  bounds;  // the PackedVertex array's; vertex_bounds of the mesh
+    // the .obj this cache was built from
+    int64_t   source_mtime;  // nanoseconds; see file_info
+    uint64_t  source_size;
+    uint64_t  payload_checksum;  // every array after the header; see load_mesh_cache
+    uint64_t  checksum;  // fnv1a_64 of this header w/ checksum = 0
+} MeshCacheHeader;
+
+
+// geo points into the mapped cache (read only), or into arena if the
+// cache couldn't be written & we fell back to the parsed .obj
+// -- packed points into the mapping too; its vertices & indices are NULL in the fallback
+typedef struct MeshCache_s {
+    MappedFile  file;
+    Arena       arena;
+    Geometry    geo;
+    PackedMesh  packed;
+} MeshCache;
+
+
+int write_mesh_cache(char* path, Geometry *geo, char* source_path, ObjOptions *options);
+// fails if the cache is missing, invalid or older than source_path
+// NOTE: hashes the whole payload, so a corrupt array fails too; a truncated one
+// already fails the size check. costs ~1 extra read of the file (page cache speed)
+int load_mesh_cache(char* path, char* source_path, ObjOptions *options, MeshCache *cache);
+// load_mesh_cache, (re)building the cache from the .obj if needed
+int open_mesh(char* obj_path, char* cache_path, ObjOptions *options, MeshCache *cache);
+void close_mesh(MeshCache *cache);
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "geometry.h"
+#include "mesh_cache.h"
+
+
+void print_usage(char* argv_0) {
+    printf("usage: %s [--weld] [--optimise] [--lods N] [--threads N] folder/file.obj folder/file.mesh\n", argv_0);
+    printf(".obj -> binary mesh cache (loaded by panini_gl w/ open_mesh)\n");
+    printf("    --weld        deduplicate (v, vt, vn) corners\n");
+    printf("    --optimise    reorder triangles & vertices for the GPU\n");
+    printf("    --lods N      build N levels of detail (up to %d) into the cache\n", MAX_LODS);
+    printf("    --threads N   parser threads (0 = 1 per core, 1 = serial)\n");
+}
+
+
+int main(int argc, char* argv[]) {
+    ObjOptions options = {.weld = false, .optimise = false, .lods = 0, .num_threads = 0, .stats = NULL, .cancel = NULL};
+    char *obj_path = NULL;
+    char *mesh_path = NULL;
+    bool bad_args = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--weld") == 0) {
+            options.weld = true;
+        } else if (strcmp(argv[i], "--optimise") == 0) {
+            options.optimise = true;
+        } else if (strcmp(argv[i], "--lods") == 0 && i + 1 < argc) {
+            options.lods = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.num_threads = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && obj_path == NULL) {
+            obj_path = argv[i];
+        } else if (argv[i][0] != '-' && mesh_path == NULL) {
+            mesh_path = argv[i];
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args || obj_path == NULL || mesh_path == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    Arena arena;
+    init_arena(&arena, 0);
+    Geometry geo = {
+        .num_vertices = 0,
+        .max_vertices = 0,
+        .num_indices = 0,
+        .max_indices = 0,
+        .vertices = NULL,
+        .indices = NULL,
+        .arena = &arena,
+        .num_lods = 0};
+    if (read_obj_options(obj_path, &options, &geo) != 0) {
+        printf("!!! parse failed !!!\n");
+        free_arena(&arena);
+        return 1;
+    }
+
+    if (write_mesh_cache(mesh_path, &geo, obj_path, &options) != 0) {
+        printf("!!! write failed !!!\n");
+        free_arena(&arena);
+        return 1;
+    }
+
+    printf("%s -> %s (%d vertices, %d indices, %d LODs)\n",
+        obj_path, mesh_path, geo.num_vertices, geo.num_indices, geo.num_lods);
+    free_arena(&arena);
+    return 0;
+}
@@ -0,0 +1,500 @@
+// Using C23 Standard
+// Math (-lm)
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "optimise.h"
+
+
+// 0 if geo is a valid triangle list
+static int check_triangles(Geometry *geo) {
+    if (geo->num_indices % 3 != 0) {
+        fprintf(stderr, "not a triangle list: %d indices\n", geo->num_indices);
+        return 2;
+    }
+    for (int i = 0; i < geo->num_indices; i++) {
+        if (geo->indices[i] >= (uint32_t)geo->num_vertices) {
+            fprintf(stderr, "index %d out of range: %u >= %d\n", i, geo->indices[i], geo->num_vertices);
+            return 3;
+        }
+    }
+    return 0;
+}
+
+
+// -- FIFO vertex cache model --
+// timestamps count misses; a vertex is cached if it missed in the last cache_size misses
+// -- every vertex starts uncached if *time starts at cache_size + 1 & timestamps at 0
+// -- *time += cache_size + 1 flushes the cache
+static int cache_misses(uint32_t *triangle, int cache_size, uint32_t *timestamps, uint32_t *time) {
+    int misses = 0;
+    for (int i = 0; i < 3; i++) {
+        uint32_t v = triangle[i];
+        if (*time - timestamps[v] > (uint32_t)cache_size) {
+            timestamps[v] = (*time)++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+
+// -- overdraw estimate --
+
+typedef struct ScreenVertex_s {
+    float  x;
+    float  y;
+    float  depth;  // smaller is nearer
+} ScreenVertex;
+
+
+// twice the signed area of a, b, p; positive if counter-clockwise
+static inline float edge(ScreenVertex *a, ScreenVertex *b, float px, float py) {
+    return (b->x - a->x) * (py - a->y) - (b->y - a->y) * (px - a->x);
+}
+
+
+// top-left fill rule, so pixels on shared edges are only drawn once
+// -- counter-clockwise w/ +Y up; top edges go left, left edges go down
+static inline bool top_left(ScreenVertex *a, ScreenVertex *b) {
+    return (a->y == b->y && b->x < a->x) || b->y < a->y;
+}
+
+
+// 1 orthographic view along +/- axis, depth tested in draw order
+// -- counts every fragment that passes (would be shaded w/ early-z)
+static void rasterise_view(Geometry *geo, int axis, int sign, Vec3 min, float scale, float *depth, uint64_t *shaded) {
+    // right & up, so right x up = -forward (GL's view space handedness)
+    int right = (sign > 0) ? (axis + 2) % 3 : (axis + 1) % 3;
+    int up = (sign > 0) ? (axis + 1) % 3 : (axis + 2) % 3;
+    for (int i = 0; i < OVERDRAW_GRID * OVERDRAW_GRID; i++)
+        depth[i] = FLT_MAX;
+
+    for (int t = 0; t < geo->num_indices; t += 3) {
+        ScreenVertex corners[3];
+        for (int i = 0; i < 3; i++) {
+            float *p = &geo->vertices[geo->indices[t + i]].position.x;
+            float *origin = &min.x;
+            corners[i].x = (p[right] - origin[right]) * scale;
+            corners[i].y = (p[up] - origin[up]) * scale;
+            corners[i].depth = p[axis] * sign;
+        }
+        ScreenVertex *a = &corners[0];
+        ScreenVertex *b = &corners[1];
+        ScreenVertex *c = &corners[2];
+        float area = edge(a, b, c->x, c->y);
+        if (area >= 0.0f)
+            continue;  // back facing or degenerate; front faces are clockwise
+        // swap to counter-clockwise, so inside is positive
+        b = &corners[2];
+        c = &corners[1];
+        area = -area;
+
+        float min_x = fminf(a->x, fminf(b->x, c->x));
+        float min_y = fminf(a->y, fminf(b->y, c->y));
+        float max_x = fmaxf(a->x, fmaxf(b->x, c->x));
+        float max_y = fmaxf(a->y, fmaxf(b->y, c->y));
+        int x0 = (int)fmaxf(floorf(min_x), 0.0f);
+        int y0 = (int)fmaxf(floorf(min_y), 0.0f);
+        int x1 = (int)fminf(ceilf(max_x), OVERDRAW_GRID - 1);
+        int y1 = (int)fminf(ceilf(max_y), OVERDRAW_GRID - 1);
+        bool top_left_a = top_left(b, c);  // edge opposite a
+        bool top_left_b = top_left(c, a);
+        bool top_left_c = top_left(a, b);
+        for (int y = y0; y <= y1; y++) {
+            float py = y + 0.5f;
+            for (int x = x0; x <= x1; x++) {
+                float px = x + 0.5f;
+                float wa = edge(b, c, px, py);
+                float wb = edge(c, a, px, py);
+                float wc = edge(a, b, px, py);
+                if (wa < 0.0f || wb < 0.0f || wc < 0.0f
+                 || (wa == 0.0f && !top_left_a)
+                 || (wb == 0.0f && !top_left_b)
+                 || (wc == 0.0f && !top_left_c))
+                    continue;
+                float z = (wa * a->depth + wb * b->depth + wc * c->depth) / area;
+                float *pixel = &depth[y * OVERDRAW_GRID + x];
+                if (z < *pixel) {
+                    *pixel = z;
+                    (*shaded)++;
+                }
+            }
+        }
+    }
+}
+
+
+int analyse_mesh(Geometry *geo, int cache_size, MeshStats *stats) {
+    *stats = (MeshStats){0};
+    int result = check_triangles(geo);
+    if (result != 0 || geo->num_indices == 0)
+        return result;
+
+    Arena scratch;
+    init_arena(&scratch, 0);
+    uint32_t *timestamps = arena_alloc(&scratch, sizeof(uint32_t) * geo->num_vertices);
+    float *depth = arena_alloc(&scratch, sizeof(float) * OVERDRAW_GRID * OVERDRAW_GRID);
+    if (timestamps == NULL || depth == NULL) {
+        free_arena(&scratch);
+        return 1;  // arena_alloc prints its own errors
+    }
+
+    // vertex cache
+    memset(timestamps, 0, sizeof(uint32_t) * geo->num_vertices);
+    uint32_t time = cache_size + 1;
+    int misses = 0;
+    for (int t = 0; t < geo->num_indices; t += 3)
+        misses += cache_misses(&geo->indices[t], cache_size, timestamps, &time);
+    stats->acmr = (float)misses / (geo->num_indices / 3);
+    stats->atvr = (float)misses / geo->num_vertices;
+
+    // overdraw; every view shares 1 scale, so pixels are the same size
+    Vec3 min = geo->vertices[geo->indices[0]].position;
+    Vec3 max = min;
+    for (int i = 0; i < geo->num_indices; i++) {
+        Vec3 p = geo->vertices[geo->indices[i]].position;
+        min = (Vec3){fminf(min.x, p.x), fminf(min.y, p.y), fminf(min.z, p.z)};
+        max = (Vec3){fmaxf(max.x, p.x), fmaxf(max.y, p.y), fmaxf(max.z, p.z)};
+    }
+    float extent = fmaxf(max.x - min.x, fmaxf(max.y - min.y, max.z - min.z));
+    float scale = (extent > 0.0f) ? OVERDRAW_GRID / extent : 0.0f;
+    uint64_t shaded = 0;
+    uint64_t covered = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        for (int sign = -1; sign <= 1; sign += 2) {
+            rasterise_view(geo, axis, sign, min, scale, depth, &shaded);
+            for (int i = 0; i < OVERDRAW_GRID * OVERDRAW_GRID; i++)
+                covered += (depth[i] != FLT_MAX);
+        }
+    }
+    stats->overdraw = (covered > 0) ? (float)shaded / covered : 0.0f;
+
+    free_arena(&scratch);
+    return 0;
+}
+
+
+int optimise_mesh(Geometry *geo, int cache_size, float overdraw_threshold) {
+    // NOTE: triangles never move between LODs
+    int num_lods = (geo->num_lods > 0) ? geo->num_lods : 1;
+    int result = 0;
+    for (int i = 0; i < num_lods && result == 0; i++) {
+        Geometry level = geometry_lod(geo, i);
+        result = optimise_vertex_cache(&level, cache_size);
+        if (result == 0)
+            result = optimise_overdraw(&level, cache_size, overdraw_threshold);
+    }
+    // NOTE: in level 0's order; coarser levels use a subset of its vertices
+    if (result == 0)
+        result = optimise_vertex_fetch(geo);
+    return result;
+}
+
+
+// -- vertex cache --
+
+// Tipsify's next fanning vertex
+// -- a recent candidate that would still be cached after its whole fan, or
+//    any candidate w/ triangles left, or a dead end, or the next vertex in order
+static int next_fan(int num_candidates, uint32_t *candidates, int *live, uint32_t *timestamps, uint32_t time, int cache_size,
+                    int *num_dead_ends, uint32_t *dead_ends, int *cursor, int num_vertices) {
+    int best = -1;
+    uint32_t best_priority = 0;
+    for (int i = 0; i < num_candidates; i++) {
+        uint32_t v = candidates[i];
+        if (live[v] == 0)
+            continue;
+        // 0 unless fanning v (2 new vertices per triangle at most) keeps it cached
+        uint32_t age = time - timestamps[v];
+        uint32_t priority = (age + 2 * (uint32_t)live[v] <= (uint32_t)cache_size) ? age : 0;
+        if (best == -1 || priority > best_priority) {
+            best = v;
+            best_priority = priority;
+        }
+    }
+    if (best != -1)
+        return best;
+
+    // dead end; most recently used vertices first, then file order
+    while (*num_dead_ends > 0) {
+        uint32_t v = dead_ends[--*num_dead_ends];
+        if (live[v] > 0)
+            return v;
+    }
+    for (; *cursor < num_vertices; (*cursor)++) {
+        if (live[*cursor] > 0)
+            return *cursor;
+    }
+    return -1;  // every triangle is emitted
+}
+
+
+int optimise_vertex_cache(Geometry *geo, int cache_size) {
+    int result = check_triangles(geo);
+    if (result != 0 || geo->num_indices == 0)
+        return result;
+    int num_vertices = geo->num_vertices;
+    int num_triangles = geo->num_indices / 3;
+
+    Arena scratch;
+    init_arena(&scratch, 0);
+    int *offsets = arena_alloc(&scratch, sizeof(int) * (num_vertices + 1));
+    int *live = arena_alloc(&scratch, sizeof(int) * num_vertices);  // triangles left per vertex
+    int *adjacency = arena_alloc(&scratch, sizeof(int) * geo->num_indices);  // triangles per vertex
+    uint32_t *timestamps = arena_alloc(&scratch, sizeof(uint32_t) * num_vertices);
+    uint32_t *dead_ends = arena_alloc(&scratch, sizeof(uint32_t) * geo->num_indices);
+    bool *emitted = arena_alloc(&scratch, sizeof(bool) * num_triangles);
+    uint32_t *out = arena_alloc(&scratch, sizeof(uint32_t) * geo->num_indices);
+    if (offsets == NULL || live == NULL || adjacency == NULL || timestamps == NULL
+     || dead_ends == NULL || emitted == NULL || out == NULL) {
+        free_arena(&scratch);
+        return 1;  // arena_alloc prints its own errors
+    }
+
+    // vertex -> triangle adjacency; offsets are prefix sums of live
+    memset(live, 0, sizeof(int) * num_vertices);
+    for (int i = 0; i < geo->num_indices; i++)
+        live[geo->indices[i]]++;
+    int max_live = 0;
+    offsets[0] = 0;
+    for (int v = 0; v < num_vertices; v++) {
+        offsets[v + 1] = offsets[v] + live[v];
+        max_live = (live[v] > max_live) ? live[v] : max_live;
+    }
+    // NOTE: timestamps doubles as the fill cursor until the main loop
+    memcpy(timestamps, offsets, sizeof(int) * num_vertices);
+    for (int i = 0; i < geo->num_indices; i++)
+        adjacency[timestamps[geo->indices[i]]++] = i / 3;
+    // 1 fan emits every triangle around its vertex
+    uint32_t *candidates = arena_alloc(&scratch, sizeof(uint32_t) * 3 * max_live);
+    if (candidates == NULL) {
+        free_arena(&scratch);
+        return 1;
+    }
+
+    memset(timestamps, 0, sizeof(uint32_t) * num_vertices);
+    memset(emitted, 0, sizeof(bool) * num_triangles);
+    uint32_t time = cache_size + 1;
+    int num_dead_ends = 0;
+    int cursor = 0;
+    int num_out = 0;
+    int fan = next_fan(0, candidates, live, timestamps, time, cache_size, &num_dead_ends, dead_ends, &cursor, num_vertices);
+    while (fan >= 0) {
+        int num_candidates = 0;
+        for (int i = offsets[fan]; i < offsets[fan + 1]; i++) {
+            int t = adjacency[i];
+            if (emitted[t])
+                continue;
+            for (int j = 0; j < 3; j++) {
+                uint32_t v = geo->indices[t * 3 + j];
+                out[num_out++] = v;
+                dead_ends[num_dead_ends++] = v;
+                candidates[num_candidates++] = v;
+                live[v]--;
+                if (time - timestamps[v] > (uint32_t)cache_size)
+                    timestamps[v] = time++;
+            }
+            emitted[t] = true;
+        }
+        fan = next_fan(num_candidates, candidates, live, timestamps, time, cache_size, &num_dead_ends, dead_ends, &cursor, num_vertices);
+    }
+
+    memcpy(geo->indices, out, sizeof(uint32_t) * geo->num_indices);
+    free_arena(&scratch);
+    return 0;
+}
+
+
+// -- overdraw --
+
+typedef struct Cluster_s {
+    int    start;  // first triangle
+    int    end;    // 1 past the last triangle
+    float  sort_key;
+} Cluster;
+
+
+// outward facing & far from the centre first; ties in the original order
+static int compare_clusters(const void *a, const void *b) {
+    const Cluster *x = a;
+    const Cluster *y = b;
+    if (x->sort_key != y->sort_key)
+        return (x->sort_key < y->sort_key) ? 1 : -1;
+    return x->start - y->start;
+}
+
+
+// front facing normal; length is twice the area
+// NOTE: clockwise front faces, like panini_gl
+static Vec3 front_normal(Geometry *geo, uint32_t *triangle, Vec3 *centroid) {
+    Vec3 a = geo->vertices[triangle[0]].position;
+    Vec3 b = geo->vertices[triangle[1]].position;
+    Vec3 c = geo->vertices[triangle[2]].position;
+    *centroid = (Vec3){(a.x + b.x + c.x) / 3, (a.y + b.y + c.y) / 3, (a.z + b.z + c.z) / 3};
+    Vec3 ab = {b.x - a.x, b.y - a.y, b.z - a.z};
+    Vec3 ac = {c.x - a.x, c.y - a.y, c.z - a.z};
+    return (Vec3){  // ac x ab
+        ac.y * ab.z - ac.z * ab.y,
+        ac.z * ab.x - ac.x * ab.z,
+        ac.x * ab.y - ac.y * ab.x};
+}
+
+
+static float length(Vec3 v) {
+    return sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+
+int optimise_overdraw(Geometry *geo, int cache_size, float threshold) {
+    int result = check_triangles(geo);
+    if (result != 0 || geo->num_indices == 0)
+        return result;
+    int num_triangles = geo->num_indices / 3;
+
+    Arena scratch;
+    init_arena(&scratch, 0);
+    uint32_t *timestamps = arena_alloc(&scratch, sizeof(uint32_t) * geo->num_vertices);
+    int *hard = arena_alloc(&scratch, sizeof(int) * num_triangles);
+    Cluster *clusters = arena_alloc(&scratch, sizeof(Cluster) * num_triangles);
+    uint32_t *out = arena_alloc(&scratch, sizeof(uint32_t) * geo->num_indices);
+    if (timestamps == NULL || hard == NULL || clusters == NULL || out == NULL) {
+        free_arena(&scratch);
+        return 1;  // arena_alloc prints its own errors
+    }
+
+    // hard boundaries; 3 misses means a new patch, disjoint from the last
+    memset(timestamps, 0, sizeof(uint32_t) * geo->num_vertices);
+    uint32_t time = cache_size + 1;
+    int num_hard = 0;
+    for (int t = 0; t < num_triangles; t++) {
+        int misses = cache_misses(&geo->indices[t * 3], cache_size, timestamps, &time);
+        if (t == 0 || misses == 3)
+            hard[num_hard++] = t;
+    }
+
+    // soft boundaries; split each run as soon as the split part's ACMR is
+    // within threshold of the whole run's
+    int num_clusters = 0;
+    for (int i = 0; i < num_hard; i++) {
+        int start = hard[i];
+        int end = (i + 1 < num_hard) ? hard[i + 1] : num_triangles;
+        time += cache_size + 1;
+        int misses = 0;
+        for (int t = start; t < end; t++)
+            misses += cache_misses(&geo->indices[t * 3], cache_size, timestamps, &time);
+        float target = threshold * misses / (end - start);
+
+        int first_cluster = num_clusters;
+        clusters[num_clusters++].start = start;
+        time += cache_size + 1;
+        int run_misses = 0;
+        int run_triangles = 0;
+        for (int t = start; t < end; t++) {
+            run_misses += cache_misses(&geo->indices[t * 3], cache_size, timestamps, &time);
+            run_triangles++;
+            if (run_misses <= target * run_triangles) {
+                clusters[num_clusters++].start = t + 1;
+                time += cache_size + 1;
+                run_misses = 0;
+                run_triangles = 0;
+            }
+        }
+        // the last split is leftovers w/ a poor ACMR; merge it into the one before
+        if (num_clusters - 1 > first_cluster)
+            num_clusters--;
+    }
+    for (int i = 0; i < num_clusters; i++)
+        clusters[i].end = (i + 1 < num_clusters) ? clusters[i + 1].start : num_triangles;
+
+    // area weighted centroid of the mesh
+    Vec3 mesh_centre = {0, 0, 0};
+    float mesh_area = 0.0f;
+    for (int t = 0; t < num_triangles; t++) {
+        Vec3 centroid;
+        float area = length(front_normal(geo, &geo->indices[t * 3], &centroid));
+        mesh_centre = (Vec3){
+            mesh_centre.x + centroid.x * area,
+            mesh_centre.y + centroid.y * area,
+            mesh_centre.z + centroid.z * area};
+        mesh_area += area;
+    }
+    if (mesh_area > 0.0f)
+        mesh_centre = (Vec3){mesh_centre.x / mesh_area, mesh_centre.y / mesh_area, mesh_centre.z / mesh_area};
+
+    // sort key: how far each cluster faces away from the centre
+    for (int i = 0; i < num_clusters; i++) {
+        Vec3 centre = {0, 0, 0};
+        Vec3 normal = {0, 0, 0};
+        float area = 0.0f;
+        for (int t = clusters[i].start; t < clusters[i].end; t++) {
+            Vec3 centroid;
+            Vec3 n = front_normal(geo, &geo->indices[t * 3], &centroid);
+            float a = length(n);
+            centre = (Vec3){centre.x + centroid.x * a, centre.y + centroid.y * a, centre.z + centroid.z * a};
+            normal = (Vec3){normal.x + n.x, normal.y + n.y, normal.z + n.z};
+            area += a;
+        }
+        float normal_length = length(normal);
+        if (area == 0.0f || normal_length == 0.0f) {
+            clusters[i].sort_key = 0.0f;
+            continue;
+        }
+        Vec3 offset = {
+            centre.x / area - mesh_centre.x,
+            centre.y / area - mesh_centre.y,
+            centre.z / area - mesh_centre.z};
+        clusters[i].sort_key = (offset.x * normal.x + offset.y * normal.y + offset.z * normal.z) / normal_length;
+    }
+    qsort(clusters, num_clusters, sizeof(Cluster), compare_clusters);
+
+    int num_out = 0;
+    for (int i = 0; i < num_clusters; i++) {
+        int count = (clusters[i].end - clusters[i].start) * 3;
+        memcpy(&out[num_out], &geo->indices[clusters[i].start * 3], sizeof(uint32_t) * count);
+        num_out += count;
+    }
+    memcpy(geo->indices, out, sizeof(uint32_t) * geo->num_indices);
+    free_arena(&scratch);
+    return 0;
+}
+
+
+// -- vertex fetch --
+
+int optimise_vertex_fetch(Geometry *geo) {
+    int result = check_triangles(geo);
+    if (result != 0 || geo->num_vertices == 0)
+        return result;
+
+    Arena scratch;
+    init_arena(&scratch, 0);
+    uint32_t *remap = arena_alloc(&scratch, sizeof(uint32_t) * geo->num_vertices);
+    Vertex *vertices = arena_alloc(&scratch, sizeof(Vertex) * geo->num_vertices);
+    if (remap == NULL || vertices == NULL) {
+        free_arena(&scratch);
+        return 1;  // arena_alloc prints its own errors
+    }
+
+    // NOTE: UINT32_MAX marks vertices not seen yet
+    memset(remap, 0xFF, sizeof(uint32_t) * geo->num_vertices);
+    uint32_t next = 0;
+    for (int i = 0; i < geo->num_indices; i++) {
+        uint32_t v = geo->indices[i];
+        if (remap[v] == UINT32_MAX)
+            remap[v] = next++;
+        geo->indices[i] = remap[v];
+    }
+    for (int v = 0; v < geo->num_vertices; v++) {
+        if (remap[v] == UINT32_MAX)
+            remap[v] = next++;
+        vertices[remap[v]] = geo->vertices[v];
+    }
+
+    memcpy(geo->vertices, vertices, sizeof(Vertex) * geo->num_vertices);
+    free_arena(&scratch);
+    return 0;
+}
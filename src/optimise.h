@@ -0,0 +1,44 @@
+// Using C23 Standard
+#pragma once
+
+#include "geometry.h"
+
+
+// triangle order & vertex order for the GPU
+// -- every triangle is drawn for up to 6 cube faces, so vertex shader runs
+//    (post-transform cache misses) & overdraw are paid up to 6 times over
+// NOTE: geo must be a triangle list in writeable memory (not a mapped cache)
+
+// post-transform vertex cache to optimise for & measure with
+// NOTE: real caches vary by vendor; a FIFO of 16 is a fair middle ground
+#define VERTEX_CACHE_SIZE  16
+// clusters may cost this much ACMR to be small enough to sort for overdraw
+#define OVERDRAW_THRESHOLD  1.05f
+// software raster resolution for analyse_mesh's overdraw estimate
+#define OVERDRAW_GRID  256
+
+
+typedef struct MeshStats_s {
+    float  acmr;      // vertex shader runs per triangle; 3 is worst, ~0.5 best
+    float  atvr;      // vertex shader runs per vertex; 1 is best
+    float  overdraw;  // fragments shaded per pixel covered; 1 is best
+} MeshStats;
+
+
+// ACMR & ATVR w/ a FIFO of cache_size
+// overdraw from 6 orthographic views along +/- X, Y & Z
+// -- front faces are clockwise, like panini_gl (glFrontFace(GL_CW))
+int analyse_mesh(Geometry *geo, int cache_size, MeshStats *stats);
+
+// all 3 passes below, in order; the first 2 per LOD (see geometry_lod)
+// NOTE: the passes on their own treat geo->indices as 1 mesh
+int optimise_mesh(Geometry *geo, int cache_size, float overdraw_threshold);
+// Tipsify (Sander, Nehab & Barczak 2007); fans around recently used vertices
+// -- linear time, unlike Forsyth's scoring; triangles keep their winding
+int optimise_vertex_cache(Geometry *geo, int cache_size);
+// split into clusters at cache flushes & wherever a cluster's ACMR is
+// within threshold of its whole run, then draw outward facing clusters first
+// NOTE: view independent; occluders tend to face away from the mesh centre
+int optimise_overdraw(Geometry *geo, int cache_size, float threshold);
+// renumber vertices in order of first use; unused vertices go last
+int optimise_vertex_fetch(Geometry *geo);
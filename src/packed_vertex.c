@@ -0,0 +1,191 @@
+// Using C23 Standard
+// Math (-lm)
+#include <math.h>
+#include <string.h>
+
+#include "packed_vertex.h"
+
+
+uint16_t float_to_half(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint16_t sign = (x >> 16) & 0x8000;
+    int exponent = (int)((x >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = x & 0x7FFFFF;
+
+    if (exponent == 0xFF - 127 + 15)  // inf or nan; nans stay quiet nans
+        return sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0);
+    if (exponent >= 31)
+        return sign | 0x7C00;  // overflow -> inf
+    if (exponent <= 0) {  // subnormal or 0
+        if (exponent < -10)
+            return sign;
+        mantissa |= 0x800000;  // implicit 1
+        int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+        return sign | half;
+    }
+    uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFF;
+    // NOTE: a carry out of the mantissa bumps the exponent, which is correct
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        half++;
+    return sign | half;
+}
+
+
+float half_to_float(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    int exponent = (h >> 10) & 0x1F;
+    uint32_t mantissa = h & 0x3FF;
+    uint32_t x;
+    if (exponent == 0x1F) {
+        x = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        x = sign | ((uint32_t)(exponent - 15 + 127) << 23) | (mantissa << 13);
+    } else {  // subnormal or 0; exact in a float
+        float f = mantissa * (1.0f / (1 << 24));
+        return (sign != 0) ? -f : f;
+    }
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+
+static int16_t snorm16(float f) {
+    f = (f < -1.0f) ? -1.0f : (f > 1.0f) ? 1.0f : f;
+    return (int16_t)lroundf(f * 32767.0f);
+}
+
+
+void octahedral_encode(Vec3 normal, int16_t dest[2]) {
+    // project onto the octahedron |x| + |y| + |z| = 1, then fold the -z half out
+    float sum = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+    if (sum == 0.0f) {  // no normal; anything decodes to a unit vector
+        dest[0] = dest[1] = 0;
+        return;
+    }
+    float x = normal.x / sum;
+    float y = normal.y / sum;
+    if (normal.z < 0.0f) {
+        float folded_x = (1.0f - fabsf(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+        float folded_y = (1.0f - fabsf(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+        x = folded_x;
+        y = folded_y;
+    }
+    dest[0] = snorm16(x);
+    dest[1] = snorm16(y);
+}
+
+
+// NOTE: same as decode_normal in the shaders
+Vec3 octahedral_decode(int16_t encoded[2]) {
+    // GL snorm: -32768 & -32767 are both -1
+    float x = fmaxf(encoded[0] / 32767.0f, -1.0f);
+    float y = fmaxf(encoded[1] / 32767.0f, -1.0f);
+    Vec3 n = {x, y, 1.0f - fabsf(x) - fabsf(y)};
+    float t = fmaxf(-n.z, 0.0f);
+    n.x += (n.x >= 0.0f) ? -t : t;
+    n.y += (n.y >= 0.0f) ? -t : t;
+    Vec3_normalise(&n);
+    return n;
+}
+
+
+void vertex_bounds(Geometry *geo, VertexBounds *bounds) {
+    if (geo->num_vertices == 0) {
+        *bounds = (VertexBounds){.offset = {0, 0, 0}, .scale = {0, 0, 0}};
+        return;
+    }
+    Vec3 min = geo->vertices[0].position;
+    Vec3 max = min;
+    for (int i = 1; i < geo->num_vertices; i++) {
+        Vec3 p = geo->vertices[i].position;
+        min.x = fminf(min.x, p.x);
+        min.y = fminf(min.y, p.y);
+        min.z = fminf(min.z, p.z);
+        max.x = fmaxf(max.x, p.x);
+        max.y = fmaxf(max.y, p.y);
+        max.z = fmaxf(max.z, p.z);
+    }
+    bounds->offset = min;
+    bounds->scale = (Vec3){max.x - min.x, max.y - min.y, max.z - min.z};
+}
+
+
+void mesh_vertex_bounds(Geometry *geo, PackedMesh *packed, VertexBounds *bounds) {
+    if (packed != NULL && packed->vertices != NULL)
+        *bounds = packed->bounds;
+    else
+        vertex_bounds(geo, bounds);
+}
+
+
+void merge_vertex_bounds(int num_meshes, Geometry *meshes, PackedMesh *packed, VertexBounds *bounds) {
+    *bounds = (VertexBounds){.offset = {0, 0, 0}, .scale = {0, 0, 0}};
+    bool empty = true;
+    for (int i = 0; i < num_meshes; i++) {
+        if (meshes[i].num_vertices == 0)
+            continue;  // its {0, 0, 0} bounds would pull the box to the origin
+        VertexBounds mesh;
+        mesh_vertex_bounds(&meshes[i], (packed != NULL) ? &packed[i] : NULL, &mesh);
+        if (empty) {
+            *bounds = mesh;
+            empty = false;
+            continue;
+        }
+        Vec3 min = {
+            fminf(bounds->offset.x, mesh.offset.x),
+            fminf(bounds->offset.y, mesh.offset.y),
+            fminf(bounds->offset.z, mesh.offset.z)};
+        Vec3 max = {
+            fmaxf(bounds->offset.x + bounds->scale.x, mesh.offset.x + mesh.scale.x),
+            fmaxf(bounds->offset.y + bounds->scale.y, mesh.offset.y + mesh.scale.y),
+            fmaxf(bounds->offset.z + bounds->scale.z, mesh.offset.z + mesh.scale.z)};
+        bounds->offset = min;
+        bounds->scale = (Vec3){max.x - min.x, max.y - min.y, max.z - min.z};
+    }
+}
+
+
+bool prepacked(int num_meshes, Geometry *meshes, PackedMesh *packed, VertexBounds *bounds) {
+    if (packed == NULL)
+        return false;
+    for (int i = 0; i < num_meshes; i++) {
+        if (meshes[i].num_vertices == 0)
+            continue;
+        // NOTE: exact compare; w/ 2+ meshes, only 1 that spans the whole scene matches
+        if (packed[i].vertices == NULL || memcmp(&packed[i].bounds, bounds, sizeof(VertexBounds)) != 0)
+            return false;
+    }
+    return true;
+}
+
+
+static uint16_t unorm16(float value, float offset, float scale) {
+    if (scale == 0.0f)
+        return 0;
+    float f = (value - offset) / scale;
+    f = (f < 0.0f) ? 0.0f : (f > 1.0f) ? 1.0f : f;
+    return (uint16_t)lroundf(f * 65535.0f);
+}
+
+
+void pack_vertices(Geometry *geo, VertexBounds *bounds, PackedVertex *dest) {
+    for (int i = 0; i < geo->num_vertices; i++) {
+        Vertex *v = &geo->vertices[i];
+        PackedVertex *out = &dest[i];
+        out->position[0] = unorm16(v->position.x, bounds->offset.x, bounds->scale.x);
+        out->position[1] = unorm16(v->position.y, bounds->offset.y, bounds->scale.y);
+        out->position[2] = unorm16(v->position.z, bounds->offset.z, bounds->scale.z);
+        out->position[3] = 0;
+        octahedral_encode(v->normal, out->normal);
+        out->uv[0] = float_to_half(v->uv.x);
+        out->uv[1] = float_to_half(v->uv.y);
+    }
+}
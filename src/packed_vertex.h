@@ -0,0 +1,58 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdint.h>
+
+#include "geometry.h"
+#include "vector.h"
+
+
+// what populate uploads; shaders decode PackedVertex if built w/ PACKED_VERTEX
+typedef enum VertexFormat_e {
+    VERTEX_PACKED,  // PackedVertex; default
+    VERTEX_FLOAT,   // Vertex, as parsed
+} VertexFormat;
+
+
+// 16 bytes; half of Vertex
+typedef struct PackedVertex_s {
+    uint16_t  position[4];  // unorm16 across VertexBounds; [3] is padding
+    int16_t   normal[2];    // octahedral, snorm16
+    uint16_t  uv[2];        // half floats
+} PackedVertex;
+
+
+// position = offset + scale * unorm16
+typedef struct VertexBounds_s {
+    Vec3  offset;  // min corner
+    Vec3  scale;   // max - min; 0 on flat axes
+} VertexBounds;
+
+
+// 1 mesh, packed ahead of time against its own vertex_bounds; e.g. by the mesh cache
+// -- read only; populate uploads it as is when bounds are the whole scene's (always w/ 1 mesh)
+typedef struct PackedMesh_s {
+    VertexBounds   bounds;    // vertex_bounds of the mesh
+    PackedVertex  *vertices;  // Geometry.num_vertices; NULL if not packed
+    uint16_t      *indices;   // Geometry.num_indices; NULL if any vertex is past UINT16_MAX
+} PackedMesh;
+
+
+// IEEE 754 binary16, round to nearest even
+uint16_t float_to_half(float f);
+float half_to_float(uint16_t h);
+// unit vector -> square -> snorm16; < 0.004deg error
+void octahedral_encode(Vec3 normal, int16_t dest[2]);
+Vec3 octahedral_decode(int16_t encoded[2]);
+
+void vertex_bounds(Geometry *geo, VertexBounds *bounds);
+// packed's bounds if it has vertices (w/o scanning geo), otherwise vertex_bounds
+// -- packed can be NULL
+void mesh_vertex_bounds(Geometry *geo, PackedMesh *packed, VertexBounds *bounds);
+// 1 VertexBounds around every mesh; meshes w/o vertices are skipped
+// -- packed is NULL, or 1 per mesh; see mesh_vertex_bounds
+void merge_vertex_bounds(int num_meshes, Geometry *meshes, PackedMesh *packed, VertexBounds *bounds);
+// true if packed has every mesh's vertices, packed against bounds; nothing to repack
+bool prepacked(int num_meshes, Geometry *meshes, PackedMesh *packed, VertexBounds *bounds);
+// dest is geo->num_vertices long
+void pack_vertices(Geometry *geo, VertexBounds *bounds, PackedVertex *dest);
@@ -0,0 +1,536 @@
+// Using C23 Standard
+// POSIX (sysconf)
+#define _POSIX_C_SOURCE 200809L
+// Math (-lm)
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+// C11 threads (-pthread)
+#include <threads.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "panini.h"
+
+
+#define PI  3.14159265358979f
+
+// output is split into square tiles, handed out to threads in order
+#define TILE_SIZE  64
+
+
+float panini_max_fov(float d) {
+    // NOTE: d < 1: d + cos(fov / 2) must stay > 0
+    // -- d > 1: x = S * sin(lon) turns back once cos(lon) < -1 / d
+    float limit = (d < 1.0f) ? d : 1.0f / d;
+    return 2.0f * acosf(-limit) * (180.0f / PI);
+}
+
+
+int validate_panini_params(PaniniParams *params) {
+    if (!(params->d >= 0.0f))
+        return 1;  // also catches NaN
+    if (!(params->compression >= 0.0f && params->compression <= 1.0f))
+        return 2;
+    if (!(params->fov > 0.0f && params->fov < panini_max_fov(params->d)))
+        return 3;
+    return 0;
+}
+
+
+bool same_panini_params(PaniniParams *a, PaniniParams *b) {
+    return a->d == b->d && a->compression == b->compression && a->fov == b->fov;
+}
+
+
+float panini_half_width(PaniniParams *params) {
+    float half_fov = params->fov * (PI / 360.0f);
+    return (params->d + 1.0f) * sinf(half_fov) / (params->d + cosf(half_fov));
+}
+
+
+float panini_scale(PaniniParams *params, Vec3 direction) {
+    float d = params->d;
+    float h = sqrtf(direction.x * direction.x + direction.z * direction.z);
+    float half_fov = params->fov * (PI / 360.0f);
+    float lon = atan2f(direction.x, -direction.z);
+    lon = fminf(fabsf(lon), half_fov);
+    // NOTE: straight up or down; any big number will do
+    float tan_lat = (h > 1e-6f) ? direction.y / h : 1e6f;
+    float sec_lat_sq = 1.0f + tan_lat * tan_lat;
+
+    // x = S * sin(lon), S = (d + 1) / (d + cos(lon))
+    // -- dx/dlon, & lon per radian of true angle is 1 / cos(lat)
+    float cos_lon = cosf(lon);
+    float denominator = d + cos_lon;
+    float dx_dlon = (d + 1.0f) * (d * cos_lon + 1.0f) / (denominator * denominator);
+    float horizontal = dx_dlon * sqrtf(sec_lat_sq);
+    // y = tan(lat) / y_scale; see panini_column
+    float inv_s = denominator / (d + 1.0f);
+    float y_scale = inv_s + (cos_lon - inv_s) * params->compression;
+    float vertical = sec_lat_sq / y_scale;
+    return fmaxf(horizontal, vertical);
+}
+
+
+// image plane x -> point on the unit cylinder
+// -- solves x = S * sin(lon), S = (d + 1) / (d + cos(lon)) for cos(lon); no trig
+// -- *y_scale maps image plane y to the direction's y
+static void panini_column(PaniniParams *params, float x, float *dir_x, float *dir_z, float *y_scale) {
+    float d = params->d;
+    float k = (x * x) / ((d + 1.0f) * (d + 1.0f));
+    float discriminant = 1.0f + k * (1.0f - d * d);
+    float cos_lon = (-k * d + sqrtf(discriminant > 0.0f ? discriminant : 0.0f)) / (k + 1.0f);
+    float inv_s = (d + cos_lon) / (d + 1.0f);
+    *dir_x = x * inv_s;  // sin(lon)
+    *dir_z = -cos_lon;
+    // NOTE: rectilinear y is y * cos(lon) at the same longitude
+    *y_scale = inv_s + (cos_lon - inv_s) * params->compression;
+}
+
+
+Vec3 panini_direction(PaniniParams *params, int width, int height, float px, float py) {
+    float half_width = panini_half_width(params);
+    float half_height = half_width * height / width;
+    float x = (px / width * 2.0f - 1.0f) * half_width;
+    float y = (1.0f - py / height * 2.0f) * half_height;
+    Vec3 dir;
+    float y_scale;
+    panini_column(params, x, &dir.x, &dir.z, &y_scale);
+    dir.y = y * y_scale;
+    return dir;
+}
+
+
+void panini_direction_table(PaniniParams *params, int width, int height, float *dest) {
+    float half_width = panini_half_width(params);
+    float half_height = half_width * height / width;
+    float step_y = 2.0f * half_height / height;
+    float bottom_y = 0.5f * step_y - half_height;  // row 0's centre
+
+    // NOTE: row 0 holds the per-column terms until it's the last row left
+    // -- (x, y_scale, z, 0); saves allocating a column buffer
+    for (int px = 0; px < width; px++) {
+        float x = ((px + 0.5f) / width * 2.0f - 1.0f) * half_width;
+        float *column = &dest[px * 4];
+        panini_column(params, x, &column[0], &column[2], &column[1]);
+        column[3] = 0.0f;
+    }
+    for (int py = height - 1; py >= 0; py--) {
+        float y = bottom_y + py * step_y;
+        float *row = &dest[(size_t)py * width * 4];
+        for (int px = 0; px < width; px++) {
+            const float *column = &dest[px * 4];
+            row[px * 4 + 1] = y * column[1];  // read before row 0 overwrites it
+            row[px * 4 + 0] = column[0];
+            row[px * 4 + 2] = column[2];
+            row[px * 4 + 3] = 0.0f;
+        }
+    }
+}
+
+
+// -- sampling --
+// NOTE: bilinear within one cube face (clamp to edge)
+// -- matches GL w/o GL_TEXTURE_CUBE_MAP_SEAMLESS
+
+// texel coords -> integer part & fraction, 4 at a time
+// NOTE: floorf is a libm call w/o SSE4.1
+static inline void split_coords4(const float *coords, int *whole, float *fraction) {
+#ifdef __SSE2__
+    __m128 c = _mm_loadu_ps(coords);
+    __m128i i = _mm_cvttps_epi32(c);  // rounds towards 0
+    __m128 f = _mm_cvtepi32_ps(i);
+    __m128 negative = _mm_cmpgt_ps(f, c);
+    i = _mm_add_epi32(i, _mm_castps_si128(negative));  // -1 where truncation went up
+    f = _mm_cvtepi32_ps(i);
+    _mm_storeu_si128((__m128i*)whole, i);
+    _mm_storeu_ps(fraction, _mm_sub_ps(c, f));
+#else
+    for (int i = 0; i < 4; i++) {
+        float f = floorf(coords[i]);
+        whole[i] = (int)f;
+        fraction[i] = coords[i] - f;
+    }
+#endif
+}
+
+
+static inline uint32_t sample_bilinear(const Image *image, int x0, int y0, float tx, float ty, bool wrap_x) {
+    int x1 = x0 + 1;
+    int y1 = y0 + 1;
+    int w = image->width;
+    int h = image->height;
+    if (wrap_x) {
+        x0 = ((x0 % w) + w) % w;
+        x1 = ((x1 % w) + w) % w;
+    } else {
+        x0 = (x0 < 0) ? 0 : (x0 >= w) ? w - 1 : x0;
+        x1 = (x1 < 0) ? 0 : (x1 >= w) ? w - 1 : x1;
+    }
+    y0 = (y0 < 0) ? 0 : (y0 >= h) ? h - 1 : y0;
+    y1 = (y1 < 0) ? 0 : (y1 >= h) ? h - 1 : y1;
+    const uint32_t *row0 = image->pixels + (size_t)y0 * w;
+    const uint32_t *row1 = image->pixels + (size_t)y1 * w;
+
+#ifdef __SSE2__
+    // all 4 channels at once
+    __m128i zero = _mm_setzero_si128();
+    #define UNPACK(p)  _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)(p)), zero), zero))
+    __m128 c00 = UNPACK(row0[x0]);
+    __m128 c10 = UNPACK(row0[x1]);
+    __m128 c01 = UNPACK(row1[x0]);
+    __m128 c11 = UNPACK(row1[x1]);
+    #undef UNPACK
+    __m128 wx = _mm_set1_ps(tx);
+    __m128 top = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c10, c00), wx));
+    __m128 bottom = _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(c11, c01), wx));
+    __m128 out = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), _mm_set1_ps(ty)));
+    __m128i out_i = _mm_cvtps_epi32(out);  // round to nearest even, same as lrintf
+    out_i = _mm_packs_epi32(out_i, out_i);
+    out_i = _mm_packus_epi16(out_i, out_i);
+    return (uint32_t)_mm_cvtsi128_si32(out_i);
+#else
+    const uint8_t *p00 = (const uint8_t*)&row0[x0];
+    const uint8_t *p10 = (const uint8_t*)&row0[x1];
+    const uint8_t *p01 = (const uint8_t*)&row1[x0];
+    const uint8_t *p11 = (const uint8_t*)&row1[x1];
+    uint32_t result;
+    uint8_t *out = (uint8_t*)&result;
+    for (int i = 0; i < 4; i++) {
+        float top = p00[i] + (p10[i] - p00[i]) * tx;
+        float bottom = p01[i] + (p11[i] - p01[i]) * tx;
+        long c = lrintf(top + (bottom - top) * ty);
+        out[i] = (c < 0) ? 0 : (c > 255) ? 255 : (uint8_t)c;
+    }
+    return result;
+#endif
+}
+
+
+// 4 directions -> cube face & texel coords
+// -- face selection & (sc, tc) follow the GL spec's cube map table
+// -- scale & offset map [-1, +1] to texel coords; +0.5 for texel centres
+static void cube_lookup4(const float *x, const float *y, const float *z, float scale, float offset, int *face, float *u, float *v) {
+#ifdef __SSE2__
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 vx = _mm_loadu_ps(x);
+    __m128 vy = _mm_loadu_ps(y);
+    __m128 vz = _mm_loadu_ps(z);
+    __m128 ax = _mm_andnot_ps(sign, vx);
+    __m128 ay = _mm_andnot_ps(sign, vy);
+    __m128 az = _mm_andnot_ps(sign, vz);
+    __m128 x_major = _mm_and_ps(_mm_cmpge_ps(ax, ay), _mm_cmpge_ps(ax, az));
+    __m128 y_major = _mm_andnot_ps(x_major, _mm_cmpge_ps(ay, az));
+    __m128 z_major = _mm_andnot_ps(_mm_or_ps(x_major, y_major), _mm_cmpeq_ps(vx, vx));
+    __m128 sx = _mm_and_ps(vx, sign);
+    __m128 sy = _mm_and_ps(vy, sign);
+    __m128 sz = _mm_and_ps(vz, sign);
+    __m128 neg_y = _mm_xor_ps(vy, sign);
+    // +-X: sc = -z * sign(x), tc = -y
+    // +-Y: sc = x, tc = z * sign(y)
+    // +-Z: sc = x * sign(z), tc = -y
+    __m128 sc = _mm_or_ps(
+        _mm_and_ps(x_major, _mm_xor_ps(_mm_xor_ps(vz, sign), sx)),
+        _mm_or_ps(_mm_and_ps(y_major, vx), _mm_and_ps(z_major, _mm_xor_ps(vx, sz))));
+    __m128 tc = _mm_or_ps(
+        _mm_andnot_ps(y_major, neg_y),
+        _mm_and_ps(y_major, _mm_xor_ps(vz, sy)));
+    __m128 major = _mm_or_ps(
+        _mm_and_ps(x_major, ax),
+        _mm_or_ps(_mm_and_ps(y_major, ay), _mm_and_ps(z_major, az)));
+    __m128 inv = _mm_div_ps(_mm_set1_ps(scale), major);
+    __m128 bias = _mm_set1_ps(offset);
+    _mm_storeu_ps(u, _mm_add_ps(_mm_mul_ps(sc, inv), bias));
+    _mm_storeu_ps(v, _mm_add_ps(_mm_mul_ps(tc, inv), bias));
+
+    int x_bits = _mm_movemask_ps(x_major);
+    int y_bits = _mm_movemask_ps(y_major);
+    int neg_bits[3] = {_mm_movemask_ps(vx), _mm_movemask_ps(vy), _mm_movemask_ps(vz)};
+    for (int i = 0; i < 4; i++) {
+        int axis = (x_bits >> i & 1) ? 0 : (y_bits >> i & 1) ? 1 : 2;
+        face[i] = axis * 2 + (neg_bits[axis] >> i & 1);
+    }
+#else
+    for (int i = 0; i < 4; i++) {
+        float ax = fabsf(x[i]), ay = fabsf(y[i]), az = fabsf(z[i]);
+        float sc, tc, major;
+        if (ax >= ay && ax >= az) {
+            face[i] = signbit(x[i]) ? CUBE_NEGATIVE_X : CUBE_POSITIVE_X;
+            sc = signbit(x[i]) ? z[i] : -z[i];
+            tc = -y[i];
+            major = ax;
+        } else if (ay >= az) {
+            face[i] = signbit(y[i]) ? CUBE_NEGATIVE_Y : CUBE_POSITIVE_Y;
+            sc = x[i];
+            tc = signbit(y[i]) ? -z[i] : z[i];
+            major = ay;
+        } else {
+            face[i] = signbit(z[i]) ? CUBE_NEGATIVE_Z : CUBE_POSITIVE_Z;
+            sc = signbit(z[i]) ? -x[i] : x[i];
+            tc = -y[i];
+            major = az;
+        }
+        float inv = scale / major;
+        u[i] = sc * inv + offset;
+        v[i] = tc * inv + offset;
+    }
+#endif
+}
+
+
+// 4 directions -> equirect texel coords
+// NOTE: per lane atan2; equirect sources are the slow path
+static void equirect_lookup4(const float *x, const float *y, const float *z, int width, int height, float *u, float *v) {
+    for (int i = 0; i < 4; i++) {
+        float lon = atan2f(x[i], -z[i]);
+        float lat = atan2f(y[i], sqrtf(x[i] * x[i] + z[i] * z[i]));
+        u[i] = (lon * (0.5f / PI) + 0.5f) * width - 0.5f;
+        v[i] = (0.5f - lat * (1.0f / PI)) * height - 0.5f;
+    }
+}
+
+
+// -- cube face usage --
+
+// grid spacing inside the image, in pixels; the border is sampled at every pixel
+#define USAGE_STEP  4
+
+
+// texels per pixel from a pixel & its right (1) & lower (2) neighbours
+static void face_density(CubeFaceUsage *face, float *max_footprint, const float *s, const float *t) {
+    float ds_x = s[1] - s[0], dt_x = t[1] - t[0];
+    float ds_y = s[2] - s[0], dt_y = t[2] - t[0];
+    float area = fabsf(ds_x * dt_y - dt_x * ds_y);
+    if (area > 0.0f) {
+        float size = 1.0f / sqrtf(area);
+        face->size = (size > face->size) ? size : face->size;
+    }
+    float footprint = fmaxf(hypotf(ds_x, dt_x), hypotf(ds_y, dt_y));
+    *max_footprint = (footprint > *max_footprint) ? footprint : *max_footprint;
+}
+
+
+void panini_cube_usage(PaniniParams *params, int width, int height, CubeFaceUsage usage[6]) {
+    float max_footprint[6];  // longest step across 1 pixel, in face coords
+    for (int i = 0; i < 6; i++) {
+        usage[i] = (CubeFaceUsage){
+            .used = false,
+            .min_s = 1.0f, .min_t = 1.0f,
+            .max_s = 0.0f, .max_t = 0.0f,
+            .size = 0.0f};
+        max_footprint[i] = 0.0f;
+    }
+
+    float half_width = panini_half_width(params);
+    float half_height = half_width * height / width;
+    float step_x = 2.0f * half_width / width;
+    float step_y = 2.0f * half_height / height;
+    for (int py = 0; py < height; py++) {
+        bool edge_row = py == 0 || py == height - 1;
+        bool grid_row = edge_row || py % USAGE_STEP == 0;
+        // every pixel on the top & bottom rows, grid columns on grid rows
+        // -- otherwise only the left & right edges
+        int px_step = edge_row ? 1 : grid_row ? USAGE_STEP : width - 1;
+        if (px_step < 1)
+            px_step = 1;  // 1 pixel wide
+        float y = half_height - (py + 0.5f) * step_y;
+        for (int px = 0; ; px += px_step) {
+            if (px > width - 1)
+                px = width - 1;  // always hit the last column
+            // this pixel & its neighbours to the right & below
+            float x = (px + 0.5f) * step_x - half_width;
+            float dir_x[4], dir_y[4], dir_z[4], y_scale[2];
+            panini_column(params, x, &dir_x[0], &dir_z[0], &y_scale[0]);
+            panini_column(params, x + step_x, &dir_x[1], &dir_z[1], &y_scale[1]);
+            dir_y[0] = y * y_scale[0];
+            dir_y[1] = y * y_scale[1];
+            dir_x[2] = dir_x[0];
+            dir_y[2] = (y - step_y) * y_scale[0];
+            dir_z[2] = dir_z[0];
+            dir_x[3] = dir_x[0];  // unused lane
+            dir_y[3] = dir_y[0];
+            dir_z[3] = dir_z[0];
+            int face[4];
+            float s[4], t[4];
+            cube_lookup4(dir_x, dir_y, dir_z, 0.5f, 0.5f, face, s, t);
+
+            CubeFaceUsage *f = &usage[face[0]];
+            f->used = true;
+            f->min_s = (s[0] < f->min_s) ? s[0] : f->min_s;
+            f->min_t = (t[0] < f->min_t) ? t[0] : f->min_t;
+            f->max_s = (s[0] > f->max_s) ? s[0] : f->max_s;
+            f->max_t = (t[0] > f->max_t) ? t[0] : f->max_t;
+            // NOTE: no density where a neighbour is on another face
+            if (face[1] == face[0] && face[2] == face[0])
+                face_density(f, &max_footprint[face[0]], s, t);
+            if (px == width - 1)
+                break;
+        }
+    }
+
+    // grid samples can be USAGE_STEP pixels from the true bounds
+    for (int i = 0; i < 6; i++) {
+        CubeFaceUsage *f = &usage[i];
+        if (!f->used)
+            continue;
+        float pad = max_footprint[i] * USAGE_STEP;
+        f->min_s = fmaxf(f->min_s - pad, 0.0f);
+        f->min_t = fmaxf(f->min_t - pad, 0.0f);
+        f->max_s = fminf(f->max_s + pad, 1.0f);
+        f->max_t = fminf(f->max_t + pad, 1.0f);
+    }
+}
+
+
+// -- threading --
+
+typedef struct RemapJob_s {
+    PaniniSource  *source;
+    Image         *dest;
+    // per output column; padded to a multiple of 4
+    float         *column_x;
+    float         *column_z;
+    float         *column_y_scale;
+    float          top_y;  // image plane y of row 0's centre
+    float          step_y;
+    int            num_tiles_x;
+    int            num_tiles;
+    atomic_int     next_tile;
+} RemapJob;
+
+
+static void remap_tile(RemapJob *job, int tile) {
+    Image *dest = job->dest;
+    PaniniSource *source = job->source;
+    int x_start = (tile % job->num_tiles_x) * TILE_SIZE;
+    int y_start = (tile / job->num_tiles_x) * TILE_SIZE;
+    int x_end = (x_start + TILE_SIZE < dest->width) ? x_start + TILE_SIZE : dest->width;
+    int y_end = (y_start + TILE_SIZE < dest->height) ? y_start + TILE_SIZE : dest->height;
+
+    // NOTE: all cube faces are the same size
+    int face_size = source->images[0].width;
+    float scale = 0.5f * face_size;
+    float offset = 0.5f * face_size - 0.5f;
+
+    for (int py = y_start; py < y_end; py++) {
+        float y = job->top_y - py * job->step_y;
+        uint32_t *row = dest->pixels + (size_t)py * dest->width;
+        for (int px = x_start; px < x_end; px += 4) {
+            float dir_y[4];
+            for (int i = 0; i < 4; i++)
+                dir_y[i] = y * job->column_y_scale[px + i];
+            int face[4] = {0, 0, 0, 0};
+            float u[4], v[4];
+            if (source->type == SOURCE_CUBE) {
+                cube_lookup4(&job->column_x[px], dir_y, &job->column_z[px], scale, offset, face, u, v);
+            } else {
+                equirect_lookup4(&job->column_x[px], dir_y, &job->column_z[px],
+                    source->images[0].width, source->images[0].height, u, v);
+            }
+            int x0[4], y0[4];
+            float tx[4], ty[4];
+            split_coords4(u, x0, tx);
+            split_coords4(v, y0, ty);
+            bool wrap_x = source->type == SOURCE_EQUIRECT;
+            int num_lanes = (x_end - px < 4) ? x_end - px : 4;
+            for (int i = 0; i < num_lanes; i++)
+                row[px + i] = sample_bilinear(&source->images[face[i]], x0[i], y0[i], tx[i], ty[i], wrap_x);
+        }
+    }
+}
+
+
+// thrd_start_t: pull tiles until there are none left
+static int remap_worker(void *data) {
+    RemapJob *job = data;
+    for (;;) {
+        int tile = atomic_fetch_add_explicit(&job->next_tile, 1, memory_order_relaxed);
+        if (tile >= job->num_tiles)
+            return 0;
+        remap_tile(job, tile);
+    }
+}
+
+
+static int validate_source(PaniniSource *source) {
+    if (source->type == SOURCE_EQUIRECT)
+        return (source->images[0].pixels != NULL) ? 0 : 1;
+    int size = source->images[0].width;
+    for (int i = 0; i < 6; i++) {
+        Image *face = &source->images[i];
+        if (face->pixels == NULL || face->width != size || face->height != size)
+            return 1;
+    }
+    return 0;
+}
+
+
+int panini_remap(PaniniSource *source, PaniniParams *params, Image *dest, int num_threads) {
+    if (validate_panini_params(params) != 0) {
+        fprintf(stderr, "invalid panini params: d=%f, compression=%f, fov=%f\n",
+            params->d, params->compression, params->fov);
+        return 1;
+    }
+    if (validate_source(source) != 0) {
+        fprintf(stderr, "cube faces must be square & all the same size\n");
+        return 2;
+    }
+
+    RemapJob job;
+    job.source = source;
+    job.dest = dest;
+    int padded_width = (dest->width + 3) & ~3;
+    float *columns = malloc(sizeof(float) * padded_width * 3);
+    if (columns == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 3;
+    }
+    job.column_x = columns;
+    job.column_z = columns + padded_width;
+    job.column_y_scale = columns + padded_width * 2;
+
+    // NOTE: only x needs the cylinder solve; y is linear down each column
+    float half_width = panini_half_width(params);
+    float half_height = half_width * dest->height / dest->width;
+    for (int px = 0; px < padded_width; px++) {
+        int column = (px < dest->width) ? px : dest->width - 1;  // padding repeats the edge
+        float x = ((column + 0.5f) / dest->width * 2.0f - 1.0f) * half_width;
+        panini_column(params, x, &job.column_x[px], &job.column_z[px], &job.column_y_scale[px]);
+    }
+    job.step_y = 2.0f * half_height / dest->height;
+    job.top_y = half_height - 0.5f * job.step_y;
+
+    job.num_tiles_x = (dest->width + TILE_SIZE - 1) / TILE_SIZE;
+    job.num_tiles = job.num_tiles_x * ((dest->height + TILE_SIZE - 1) / TILE_SIZE);
+    atomic_init(&job.next_tile, 0);
+
+#ifdef _SC_NPROCESSORS_ONLN
+    if (num_threads <= 0)
+        num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (num_threads > job.num_tiles)
+        num_threads = job.num_tiles;
+    if (num_threads < 1)
+        num_threads = 1;
+
+    // NOTE: this thread works too; a failed thrd_create just means fewer workers
+    thrd_t *threads = malloc(sizeof(thrd_t) * num_threads);
+    int num_started = 0;
+    for (int i = 1; threads != NULL && i < num_threads; i++) {
+        if (thrd_create(&threads[num_started], remap_worker, &job) != thrd_success)
+            break;
+        num_started++;
+    }
+    remap_worker(&job);
+    for (int i = 0; i < num_started; i++)
+        thrd_join(threads[i], NULL);
+
+    free(threads);
+    free(columns);
+    return 0;
+}
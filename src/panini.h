@@ -0,0 +1,88 @@
+// Using C23 Standard
+#pragma once
+
+#include "image.h"
+#include "vector.h"
+
+
+// Panini projection
+// -- project onto a cylinder, then view the cylinder from d units behind its axis
+// -- d = 0 is rectilinear, d = 1 is classic Panini (straight verticals & radials)
+// NOTE: view space is OpenGL's; +X right, +Y up, looking down -Z
+typedef struct PaniniParams_s {
+    float  d;  // distance of the eye behind the cylinder axis; >= 0
+    // 0 keeps Panini verticals, 1 straightens horizontal lines (rectilinear vertically)
+    float  compression;
+    float  fov;  // horizontal, in degrees
+} PaniniParams;
+
+
+// cube faces in GL_TEXTURE_CUBE_MAP_POSITIVE_X order
+typedef enum CubeFace_e {
+    CUBE_POSITIVE_X,
+    CUBE_NEGATIVE_X,
+    CUBE_POSITIVE_Y,
+    CUBE_NEGATIVE_Y,
+    CUBE_POSITIVE_Z,
+    CUBE_NEGATIVE_Z,
+} CubeFace;
+
+
+typedef enum PaniniSourceType_e {
+    SOURCE_CUBE,  // 6 square faces, sampled like a GL cubemap
+    SOURCE_EQUIRECT,  // 360x180 lon/lat; forward (-Z) in the middle
+} PaniniSourceType;
+
+
+typedef struct PaniniSource_s {
+    PaniniSourceType  type;
+    // SOURCE_CUBE uses all 6, SOURCE_EQUIRECT only images[0]
+    // NOTE: rows as uploaded to GL; row 0 is t = 0
+    Image             images[6];
+} PaniniSource;
+
+
+// max horizontal fov for d, in degrees; the cylinder wraps behind the eye past this
+float panini_max_fov(float d);
+int validate_panini_params(PaniniParams *params);
+// for keying anything baked from params (cube plans, LUTs) on them
+bool same_panini_params(PaniniParams *a, PaniniParams *b);
+// half width of the image plane at the edge of the fov; half height is
+// this * height / width (square pixels)
+float panini_half_width(PaniniParams *params);
+// image plane units per radian around a view space direction; the larger of
+// the horizontal & vertical scales, so a small sphere's widest extent
+// -- 1 at the centre; rectilinear (d = 0) stretches the edges by 1 / cos^2(lon)
+//    horizontally, Panini (d = 1) only by 2 / (1 + cos(lon))
+// NOTE: directions outside the fov are clamped to its edge
+float panini_scale(PaniniParams *params, Vec3 direction);
+// view direction through a pixel (not normalised)
+// -- px & py are in pixels from the top left corner; +0.5 for centres
+// NOTE: reference for GPU paths; panini_remap uses a faster per-column form
+Vec3 panini_direction(PaniniParams *params, int width, int height, float px, float py);
+// panini_direction for every pixel centre; 4 floats (x, y, z, 0) per pixel
+// -- rows bottom to top (GL texture order); dest is width * height * 4 floats
+void panini_direction_table(PaniniParams *params, int width, int height, float *dest);
+
+// how much of a cube face a panini view samples
+// NOTE: s & t are [0, 1] across the face, as in the GL cube map table
+// -- t = 0 is the face's row 0 (the bottom row when rendering into it)
+typedef struct CubeFaceUsage_s {
+    bool   used;
+    // bounds of the sampled area; only valid if used
+    float  min_s;
+    float  min_t;
+    float  max_s;
+    float  max_t;
+    // face size for ~1 texel per output pixel (by area), where this face is densest
+    float  size;
+} CubeFaceUsage;
+
+
+// which cube faces a width x height panini view samples, where & how densely
+// -- samples the image border & a sparse grid; bounds are padded to cover the gaps
+void panini_cube_usage(PaniniParams *params, int width, int height, CubeFaceUsage usage[6]);
+
+// dest must already be allocated; its size is the output resolution
+// -- num_threads: 0 for 1 per core
+int panini_remap(PaniniSource *source, PaniniParams *params, Image *dest, int num_threads);
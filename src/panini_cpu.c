@@ -0,0 +1,109 @@
+// Using C23 Standard
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "image.h"
+#include "panini.h"
+#include "timing.h"
+
+
+// CPU reference reprojection; cube faces or equirect in, Panini view out
+
+
+void print_usage(char* argv_0) {
+    printf("usage: %s [options] --cube px.ppm nx.ppm py.ppm ny.ppm pz.ppm nz.ppm out.ppm\n", argv_0);
+    printf("       %s [options] --equirect pano.ppm out.ppm\n", argv_0);
+    printf("    --d D           panini distance; 0 = rectilinear, 1 = classic (default 1)\n");
+    printf("    --compression C vertical compression, 0..1 (default 0)\n");
+    printf("    --fov DEG       horizontal fov (default 150)\n");
+    printf("    --size WxH      output resolution (default 1920x1080)\n");
+    printf("    --threads N     0 = 1 per core (default 0)\n");
+    printf("    --repeat N      remap N times & report timings\n");
+    printf("cube faces are in GL order (+X -X +Y -Y +Z -Z); forward is -Z\n");
+}
+
+
+int main(int argc, char* argv[]) {
+    PaniniParams params = {.d = 1.0f, .compression = 0.0f, .fov = 150.0f};
+    int width = 1920;
+    int height = 1080;
+    int num_threads = 0;
+    int repeat = 1;
+    PaniniSource source = {.type = SOURCE_CUBE};
+    char *image_paths[6] = {NULL, NULL, NULL, NULL, NULL, NULL};
+    int num_images = 0;
+    char *out_path = NULL;
+    bool bad_args = false;
+    for (int i = 1; i < argc && !bad_args; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--d") == 0 && has_value) {
+            params.d = strtof(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--compression") == 0 && has_value) {
+            params.compression = strtof(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--fov") == 0 && has_value) {
+            params.fov = strtof(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--size") == 0 && has_value) {
+            bad_args = sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0;
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && has_value) {
+            repeat = atoi(argv[++i]);
+            bad_args = repeat < 1;
+        } else if (strcmp(argv[i], "--cube") == 0 && i + 7 < argc) {
+            source.type = SOURCE_CUBE;
+            num_images = 6;
+            for (int j = 0; j < 6; j++)
+                image_paths[j] = argv[++i];
+        } else if (strcmp(argv[i], "--equirect") == 0 && i + 2 < argc) {
+            source.type = SOURCE_EQUIRECT;
+            num_images = 1;
+            image_paths[0] = argv[++i];
+        } else if (out_path == NULL && argv[i][0] != '-') {
+            out_path = argv[i];
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args || num_images == 0 || out_path == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (validate_panini_params(&params) != 0) {
+        fprintf(stderr, "invalid params; fov must be < %.1f for d=%.2f & compression in 0..1\n",
+            panini_max_fov(params.d), params.d);
+        return 1;
+    }
+
+    int result = 0;
+    for (int i = 0; i < num_images && result == 0; i++)
+        result = read_ppm(image_paths[i], &source.images[i]);
+
+    Image dest = {0, 0, NULL};
+    if (result == 0)
+        result = init_image(&dest, width, height);
+
+    double best = 0.0;
+    double total = 0.0;
+    for (int i = 0; i < repeat && result == 0; i++) {
+        double start = seconds();
+        result = panini_remap(&source, &params, &dest, num_threads);
+        double elapsed = seconds() - start;
+        total += elapsed;
+        if (i == 0 || elapsed < best)
+            best = elapsed;
+    }
+    if (result == 0 && repeat > 1) {
+        printf("%dx%d: best %.2f ms, mean %.2f ms (%.1f Mpixel/s)\n",
+            width, height, best * 1e3, total / repeat * 1e3,
+            (double)width * height / best * 1e-6);
+    }
+
+    if (result == 0)
+        result = write_ppm(out_path, &dest);
+
+    free_image(&dest);
+    for (int i = 0; i < num_images; i++)
+        free_image(&source.images[i]);
+    return (result == 0) ? 0 : 1;
+}
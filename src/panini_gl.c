@@ -2,6 +2,11 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+// EGL (-lEGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
 
 // GLEW (-lGLEW)
 #include <GL/glew.h>
@@ -14,13 +19,28 @@
 #include <SDL2/SDL_opengl.h>
 
 #include "geometry.h"
+#include "image.h"
+#include "loader.h"
+#include "mesh_cache.h"
 #include "render_gl.h"
+#include "timing.h"
 
 
 // default to PSVita display resolution
 #define WIDTH  960
 #define HEIGHT 544
 
+// GPU overlay bars are scaled so this is halfway along
+#define FRAME_BUDGET_MS  (1000.0f / 60.0f)
+#define GPU_PROFILE_CSV  "build/gpu_profile.csv"
+
+// frames rendered before timing starts in --headless
+// -- the 1st frame bakes the LUT, sizes the cube map etc.
+#define WARMUP_FRAMES  3
+
+// models/hallway.obj runs from z = 0 to -10; segments are repeated down -Z
+#define HALLWAY_LENGTH  10.0f
+
 
 typedef struct Clock_s {
     uint64_t accumulator;
@@ -30,11 +50,30 @@ typedef struct Clock_s {
 } Clock;
 
 
+typedef struct HeadlessOptions_s {
+    int           num_frames;
+    RenderPath    path;
+    VertexFormat  vertex_format;
+    int           num_segments;  // hallway instances
+    bool          culling;
+    float         lod_pixels;
+    char         *dump_path;  // last frame as .ppm; NULL to skip
+} HeadlessOptions;
+
+
 void print_usage(char* argv_0) {
     printf("%s [WIDTH HEIGHT]\n", argv_0);
+    printf("%s --headless [--frames N] [--size WxH] [--path cube|direct] [--vertex packed|float] [--segments N] [--cull on|off] [--lod-pixels N] [--dump out.ppm]\n", argv_0);
     printf("SDL2 + OpenGL Panini Projection Test\n");
     printf("    WIDTH    viewport width\n");
     printf("    HEIGHT   viewport height\n");
+    printf("TAB swaps between the cube map & direct (tessellated) paths\n");
+    printf("F1 toggles the GPU timing overlay, F2 writes it to %s\n", GPU_PROFILE_CSV);
+    printf("--headless renders N frames (default 100) offscreen w/o a window or GPU\n");
+    printf("    (EGL surfaceless; llvmpipe will do) & prints frame time percentiles\n");
+    printf("--segments N draws N hallways end to end (default 1); still 1 draw per pass\n");
+    printf("--cull off draws every instance on every face, skipping the BVH\n");
+    printf("--lod-pixels N: coarsest LOD w/ at most N pixels of error (default 1); 0 for full detail\n");
 }
 
 
@@ -72,55 +111,267 @@ int init_context(int major, int minor, SDL_Window **window, SDL_GLContext *conte
 }
 
 
-void init_OpenGL() {
-    glewInit();  // load OpenGL functions
+// no window, display server or GPU needed; Mesa's llvmpipe will do
+// -- EGL_MESA_platform_surfaceless & EGL_KHR_surfaceless_context
+int init_headless_context(int major, int minor, EGLDisplay *display, EGLContext *context) {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display == NULL) {
+        fprintf(stderr, "no eglGetPlatformDisplayEXT\n");
+        return 1;
+    }
+    *display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    EGLint egl_major, egl_minor;
+    if (*display == EGL_NO_DISPLAY || eglInitialize(*display, &egl_major, &egl_minor) != EGL_TRUE) {
+        fprintf(stderr, "Couldn't initialise a surfaceless EGL display: 0x%04X\n", eglGetError());
+        return 1;
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+    EGLint attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    // NOTE: no config & no surface; everything renders into FBOs
+    *context = eglCreateContext(*display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attribs);
+    if (*context == EGL_NO_CONTEXT
+     || eglMakeCurrent(*display, EGL_NO_SURFACE, EGL_NO_SURFACE, *context) != EGL_TRUE) {
+        fprintf(stderr, "Couldn't initialise headless GL %d.%d context: 0x%04X\n", major, minor, eglGetError());
+        eglTerminate(*display);
+        return 1;
+    }
+    return 0;
+}
+
+
+// NOTE: needs a current context; SDL or EGL
+int init_OpenGL() {
+    // load OpenGL functions
+    // NOTE: GLX builds of GLEW can't find a GLX display under EGL, but have
+    // already loaded every function by then
+    GLenum glew_status = glewInit();
+    if (glew_status != GLEW_OK && glew_status != GLEW_ERROR_NO_GLX_DISPLAY) {
+        fprintf(stderr, "glewInit failed: %s\n", glewGetErrorString(glew_status));
+        return 1;
+    }
     glClearColor(0.1, 0.4, 0.5, 1.0);
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
     glFrontFace(GL_CW);
+    return 0;
 }
 
 
-int init_scene(Scene *scene) {
-    // load geo from file
-    Vertex    vertices[512];
-    uint32_t  indices[512];
+// everything init_scene reads from disk; loaded off the GL thread
+// NOTE: the loader finishes requests in order; the mesh & frame.glsl come
+// -- first, so every stage after them can be queued the moment it's in
+typedef enum SceneAsset_e {
+    ASSET_HALLWAY,
+    ASSET_FRAME_GLSL,  // prefix for every scene shader; see scene_defines
+    ASSET_CUBE_LAYER_VERT,
+    ASSET_CUBE_VERT,
+    ASSET_CUBE_GEOM,
+    ASSET_CLAY_FRAG,
+    ASSET_PANINI_VERT,
+    ASSET_PANINI_FRAG,
+    ASSET_PANINI_LUT_COMP,
+    ASSET_DIRECT_VERT,
+    ASSET_DIRECT_TESC,
+    ASSET_DIRECT_TESE,
+    ASSET_COUNT,
+} SceneAsset;
+
+
+// NOTE: the geo is loaded from the binary cache; rebuilt from the .obj if stale
+LoadRequest scene_assets[ASSET_COUNT] = {
+    [ASSET_HALLWAY] = {LOAD_MESH, "models/hallway.obj", "build/hallway.mesh",
+        {.weld = true, .optimise = true, .lods = MAX_LODS, .num_threads = 0, .stats = NULL, .cancel = NULL}},
+    [ASSET_FRAME_GLSL] = {LOAD_SHADER, "shaders/frame.glsl"},
+    [ASSET_CUBE_LAYER_VERT] = {LOAD_SHADER, "shaders/cube_layer.vert.glsl"},
+    [ASSET_CUBE_VERT] = {LOAD_SHADER, "shaders/cube.vert.glsl"},
+    [ASSET_CUBE_GEOM] = {LOAD_SHADER, "shaders/cube.geom.glsl"},
+    [ASSET_CLAY_FRAG] = {LOAD_SHADER, "shaders/clay.frag.glsl"},
+    [ASSET_PANINI_VERT] = {LOAD_SHADER, "shaders/panini.vert.glsl"},
+    [ASSET_PANINI_FRAG] = {LOAD_SHADER, "shaders/panini.frag.glsl"},
+    [ASSET_PANINI_LUT_COMP] = {LOAD_SHADER, "shaders/panini_lut.comp.glsl"},
+    [ASSET_DIRECT_VERT] = {LOAD_SHADER, "shaders/direct.vert.glsl"},
+    [ASSET_DIRECT_TESC] = {LOAD_SHADER, "shaders/direct.tesc.glsl"},
+    [ASSET_DIRECT_TESE] = {LOAD_SHADER, "shaders/direct.tese.glsl"}};
+
+
+// what each shader asset compiles to
+typedef struct AssetStage_s {
+    GLenum  type;   // 0 if not a stage of its own; e.g. frame.glsl
+    bool    scene;  // takes scene_defines; the reprojection stages don't
+} AssetStage;
+
+
+static AssetStage asset_stages[ASSET_COUNT] = {
+    [ASSET_CUBE_LAYER_VERT] = {GL_VERTEX_SHADER, true},
+    [ASSET_CUBE_VERT] = {GL_VERTEX_SHADER, true},
+    [ASSET_CUBE_GEOM] = {GL_GEOMETRY_SHADER, true},
+    [ASSET_CLAY_FRAG] = {GL_FRAGMENT_SHADER, true},
+    [ASSET_PANINI_VERT] = {GL_VERTEX_SHADER, false},
+    [ASSET_PANINI_FRAG] = {GL_FRAGMENT_SHADER, false},
+    [ASSET_PANINI_LUT_COMP] = {GL_COMPUTE_SHADER, false},
+    [ASSET_DIRECT_VERT] = {GL_VERTEX_SHADER, true},
+    [ASSET_DIRECT_TESC] = {GL_TESS_CONTROL_SHADER, true},
+    [ASSET_DIRECT_TESE] = {GL_TESS_EVALUATION_SHADER, true}};
+
+
+// a stage compiled from the loader's copy of the file
+static ShaderStage asset_stage(Loader *loader, SceneAsset asset) {
+    MappedFile *file = &loader->results[asset].file;
+    return (ShaderStage){asset_stages[asset].type, scene_assets[asset].path, file->data, (int)file->length};
+}
 
-    Geometry geo = {
-        .num_vertices = 0,
-        .max_vertices = sizeof(vertices) / sizeof(Vertex),
-        .num_indices = 0,
-        .max_indices = sizeof(indices) / sizeof(uint32_t),
-        .vertices = vertices,
-        .indices = indices};
 
-    if (read_obj("models/hallway.obj", &geo) != 0)
-        return 1;  // failed to parse .obj
+// scene_defines w/ the loader's copy of frame.glsl; malloc'd, or NULL
+static char *asset_defines(Scene *scene, Loader *loader) {
+    MappedFile *frame = &loader->results[ASSET_FRAME_GLSL].file;
+    return scene_defines(scene->vertex_format, frame->data, frame->length);
+}
+
+
+// pipelines in scene->shaders, in the order init_scene adds them
+typedef enum ScenePipeline_e {
+    PIPELINE_CUBE,
+    PIPELINE_PANINI,
+    PIPELINE_LUT,  // reprojection LUT; baked on first draw & whenever size or params change
+    PIPELINE_DIRECT,
+} ScenePipeline;
+
+
+// 1 mesh, num_segments instances
+static int upload_hallway(Scene *scene, MeshCache *mesh, int num_segments) {
+    SceneInstance *segments = malloc(sizeof(SceneInstance) * num_segments);
+    if (segments == NULL) {
+        fprintf(stderr, "out of memory for %d hallway segments\n", num_segments);
+        return 1;
+    }
+    for (int i = 0; i < num_segments; i++) {
+        segments[i].mesh = 0;
+        segments[i].transform = Mat4_translation((Vec3){0, 0, -HALLWAY_LENGTH * i});
+    }
+    SceneDesc desc = {
+        .num_meshes = 1,
+        .meshes = &mesh->geo,
+        .packed = &mesh->packed,
+        .num_instances = num_segments,
+        .instances = segments};
 
     // push geo to GPU
-    populate(scene, &geo);
+    // NOTE: either vertex format goes straight from the mapped cache to GL
+    // -- VERTEX_PACKED (the default) only packs here if the cache couldn't be written
+    // -- the loader frees its copy in stop_loader
+    int populated = populate(scene, &desc);
+    free(segments);
+    return populated;  // populate prints its own errors
+}
 
-    // load shaders
-    const GLchar glsl[4096] = "\0";
-    int glsl_length = 0;
 
-    GLuint vertex_shader = 0;
-    glsl_length = read_glsl("shaders/fov90.vert.glsl", sizeof(glsl), (const GLchar**)&glsl);
-    // NOTE: compile_glsl will fail automatically if the file fails to load (EOF)
-    if (compile_glsl(&vertex_shader, GL_VERTEX_SHADER, glsl_length, glsl) != 0) {
-        fprintf(stderr, "vertex_shader failed to compile\n");
+// hands 1 finished asset to GL as soon as poll_loader returns it
+// -- so uploads & compiles are spread over the placeholder frames
+// -- the mesh is populated; each shader stage starts compiling on its own
+// NOTE: shader stages need the vertex format & frame.glsl; see SceneAsset
+static int upload_asset(Scene *scene, Loader *loader, LoadResult *asset, int num_segments) {
+    SceneAsset id = asset->request;
+    if (asset->status != 0) {
+        fprintf(stderr, "failed to load %s\n", scene_assets[id].path);
         return 1;
     }
+    if (id == ASSET_HALLWAY) {
+        if (upload_hallway(scene, asset->mesh, num_segments) != 0)
+            return 1;  // upload_hallway prints its own errors
+        // cube pass
+        // NOTE: the cube target is sized on first draw; see update_cube_plan
+        scene->cube_mode = pick_cube_mode();
+        if (scene->cube_mode == CUBE_GEOMETRY_SHADER)
+            fprintf(stderr, "no gl_Layer in vertex shaders; using a geometry shader\n");
+        // NOTE: program binaries are cached in build/, 1 per stage, keyed on source & driver
+        return init_shader_manager(&scene->shaders, "build");  // prints its own errors
+    }
+    if (asset_stages[id].type == 0)
+        return 0;  // frame.glsl; only a prefix for the stages after it
+    bool unused = (scene->cube_mode == CUBE_VERTEX_LAYER)
+        ? (id == ASSET_CUBE_VERT || id == ASSET_CUBE_GEOM)
+        : (id == ASSET_CUBE_LAYER_VERT);
+    if (unused)
+        return 0;  // the other cube mode's stages
+
+    // NOTE: scene stages decode whichever vertex format populate settled on
+    char *defines = NULL;
+    if (asset_stages[id].scene) {
+        defines = asset_defines(scene, loader);
+        if (defines == NULL)
+            return 1;  // scene_defines prints its own errors
+    }
+    ShaderStage stage = asset_stage(loader, id);
+    int program = add_shader_stage(&scene->shaders, &stage, defines);
+    free(defines);  // copied into the stage's source
+    return (program == -1) ? 1 : 0;  // add_shader_stage prints its own errors
+}
+
 
-    GLuint fragment_shader = 0;
-    glsl_length = read_glsl("shaders/clay.frag.glsl", sizeof(glsl), (const GLchar**)&glsl);
-    if (compile_glsl(&fragment_shader, GL_FRAGMENT_SHADER, glsl_length, glsl) != 0) {
-        fprintf(stderr, "fragment_shader failed to compile\n");
+// NOTE: every asset must be through upload_asset; the rest is set up on this (the GL) thread
+// -- finish_scene once poll_shaders(&scene->shaders) is 0
+int init_scene(Scene *scene, Loader *loader) {
+    // link the queued stages into pipelines
+    // NOTE: add_shader_pipeline finds each stage's program by source & defines
+    // -- so clay.frag.glsl is compiled once & shared by every scene pipeline
+    char *defines = asset_defines(scene, loader);
+    if (defines == NULL)
+        return 1;  // scene_defines prints its own errors
+    ShaderStage cube_stages[3];
+    int num_cube_stages;
+    if (scene->cube_mode == CUBE_VERTEX_LAYER) {
+        cube_stages[0] = asset_stage(loader, ASSET_CUBE_LAYER_VERT);
+        cube_stages[1] = asset_stage(loader, ASSET_CLAY_FRAG);
+        num_cube_stages = 2;
+    } else {
+        cube_stages[0] = asset_stage(loader, ASSET_CUBE_VERT);
+        cube_stages[1] = asset_stage(loader, ASSET_CUBE_GEOM);
+        cube_stages[2] = asset_stage(loader, ASSET_CLAY_FRAG);
+        num_cube_stages = 3;
+    }
+    ShaderStage panini_stages[2] = {
+        asset_stage(loader, ASSET_PANINI_VERT),
+        asset_stage(loader, ASSET_PANINI_FRAG)};
+    ShaderStage lut_stage = asset_stage(loader, ASSET_PANINI_LUT_COMP);
+    ShaderStage direct_stages[4] = {
+        asset_stage(loader, ASSET_DIRECT_VERT),
+        asset_stage(loader, ASSET_DIRECT_TESC),
+        asset_stage(loader, ASSET_DIRECT_TESE),
+        asset_stage(loader, ASSET_CLAY_FRAG)};
+    ShaderManager *shaders = &scene->shaders;
+    bool queued = add_shader_pipeline(shaders, num_cube_stages, cube_stages, defines) == PIPELINE_CUBE
+               && add_shader_pipeline(shaders, 2, panini_stages, NULL) == PIPELINE_PANINI
+               && add_shader_pipeline(shaders, 1, &lut_stage, NULL) == PIPELINE_LUT
+               && add_shader_pipeline(shaders, 4, direct_stages, defines) == PIPELINE_DIRECT;
+    free(defines);  // copied into each stage's source
+    if (!queued) {
+        fprintf(stderr, "failed to queue shaders\n");
         return 1;
     }
 
-    if (link_shader(vertex_shader, fragment_shader, &scene->shader) != 0) {
-        fprintf(stderr, "link_shader failed\n");
+    // reprojection pass
+    glCreateVertexArrays(1, &scene->fullscreen_array);
+    scene->panini = (PaniniParams){.d = 1.0f, .compression = 0.0f, .fov = 150.0f};
+
+    // direct path
+    scene->tess_pixels = 16.0f;
+    scene->path = RENDER_CUBE;
+    scene->frame_plan.culling = true;
+    scene->frame_plan.lod_pixels = 1.0f;
+
+    // per frame uniforms
+    // NOTE: hallway.obj is modelled in GL view space; +Y up, looking down -Z
+    scene->camera = (Camera){
+        .right = {1, 0, 0}, .up = {0, 1, 0}, .forward = {0, 0, -1}, .position = {0, 0, 0}};
+    // NOTE: each frame's indirect draws share its uniform ring slot
+    if (init_uniform_ring(&scene->uniforms, scene_draws_size(scene)) != 0) {
+        fprintf(stderr, "uniform buffer failed\n");
         return 1;
     }
 
@@ -128,21 +379,273 @@ int init_scene(Scene *scene) {
 }
 
 
-int main(int argc, char* argv[]) {
-    if (argc <= 0 || argc == 2 || argc > 3) {
-        print_usage(argv[0]);
+// picks up the finished shaders
+int finish_scene(Scene *scene) {
+    ShaderManager *shaders = &scene->shaders;
+    scene->cube_shader = shader_pipeline(shaders, PIPELINE_CUBE);
+    scene->panini_shader = shader_pipeline(shaders, PIPELINE_PANINI);
+    scene->direct_shader = shader_pipeline(shaders, PIPELINE_DIRECT);
+    // NOTE: dispatched w/ glUseProgram; see update_panini_lut
+    scene->lut_shader = shader_program(shaders, PIPELINE_LUT, GL_COMPUTE_SHADER);
+    if (scene->cube_shader == 0) {
+        fprintf(stderr, "cube shader failed\n");
+        return 1;
+    } else if (scene->panini_shader == 0) {
+        fprintf(stderr, "panini shader failed\n");
+        return 1;
+    } else if (scene->direct_shader == 0) {
+        fprintf(stderr, "direct shader failed\n");
+        return 1;
+    }
+    if (scene->lut_shader != 0) {
+        scene->lut_builder = LUT_GPU;
+    } else {
+        fprintf(stderr, "panini LUT shader failed; baking on the CPU\n");
+        scene->lut_builder = LUT_CPU;
+    }
+    return 0;
+}
+
+
+// 1 step towards a drawable scene, w/o blocking; call once per frame
+// -- uploads whatever the loader has finished, then init_scene once it's all
+//    in, then waits on shader compiles
+// -- *ready is set once the scene can be drawn
+static int update_scene_load(Scene *scene, Loader *loader, int num_segments, bool *ready) {
+    // NOTE: stop_loader frees results; so NULL once init_scene has run
+    if (loader->results != NULL) {
+        LoadResult *asset;
+        while ((asset = poll_loader(loader)) != NULL) {
+            if (upload_asset(scene, loader, asset, num_segments) != 0)
+                return 1;  // upload_asset prints its own errors
+        }
+        if (loader_pending(loader) > 0)
+            return 0;
+        int result = init_scene(scene, loader);
+        stop_loader(loader);  // GL has its own copies now
+        if (result != 0)
+            return 1;
+    }
+    if (poll_shaders(&scene->shaders) > 0)
+        return 0;
+    if (finish_scene(scene) != 0)
+        return 1;  // finish_scene prints its own errors
+    *ready = true;
+    return 0;
+}
+
+
+// frame times & GPU pass percentiles for --headless
+static void print_frame_times(double *frame_ms, int num_frames, GpuProfiler *profiler) {
+    double total = 0.0;
+    for (int i = 0; i < num_frames; i++)
+        total += frame_ms[i];
+    printf("%d frames: mean %.2f ms (%.1f fps)\n", num_frames, total / num_frames, num_frames * 1e3 / total);
+    print_percentiles("frame", frame_ms, num_frames);
+    if (profiler == NULL)
+        return;
+
+    // NOTE: reuses frame_ms; the CPU times are printed already
+    const char *pass_names[GPU_PASS_COUNT] = {"gpu cube", "gpu reproject", "gpu direct", "gpu overlay"};
+    for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+        int count = 0;
+        for (int i = 0; i < profiler->history_count; i++) {
+            GpuFrame *frame = gpu_history(profiler, i);
+            if (frame->frame >= WARMUP_FRAMES && (frame->passes >> pass & 1))
+                frame_ms[count++] = frame->pass_ms[pass];
+        }
+        if (count > 0)
+            print_percentiles(pass_names[pass], frame_ms, count);
     }
+}
+
+
+int run_headless(int width, int height, HeadlessOptions *options) {
+    // NOTE: assets load while the context is made & placeholder frames are drawn
+    double start = seconds();
+    Loader loader = {0};
+    if (start_loader(&loader, ASSET_COUNT, scene_assets) != 0)
+        return 1;  // start_loader prints its own errors
+
+    EGLDisplay display;
+    EGLContext context;
+    if (init_headless_context(4, 5, &display, &context) != 0) {
+        fprintf(stderr, "init_headless_context failed\n");
+        stop_loader(&loader);
+        return 1;
+    }
+    printf("%s\n", (const char*)glGetString(GL_RENDERER));
+
+    OffscreenTarget target = {0};
+    GpuProfiler profiler = {0};
+    Scene scene = {0};
+    double *frame_ms = malloc(sizeof(double) * options->num_frames);
+    int result = init_OpenGL();
+    if (result == 0 && frame_ms == NULL) {
+        fprintf(stderr, "out of memory for %d frame times\n", options->num_frames);
+        result = 1;
+    }
+    if (result == 0)
+        result = init_offscreen_target(&target, width, height);
+    if (result == 0 && init_gpu_profiler(&profiler) != 0)
+        fprintf(stderr, "GPU profiler failed; no timings\n");
+
+    // placeholder frames until the scene is ready, like main's loop
+    // NOTE: glFinish stands in for SDL_GL_SwapWindow; 1 frame in flight at most
+    scene.profiler = (profiler.history != NULL) ? &profiler : NULL;
+    scene.output_framebuffer = target.framebuffer;
+    scene.width = width;
+    scene.height = height;
+    scene.vertex_format = options->vertex_format;
+    double first_frame_ms = 0.0;
+    int num_placeholders = 0;
+    bool ready = false;
+    while (result == 0 && !ready) {
+        result = update_scene_load(&scene, &loader, options->num_segments, &ready);
+        if (result != 0 || ready)
+            break;
+        draw_placeholder(target.framebuffer, width, height);
+        glFinish();
+        if (num_placeholders++ == 0)
+            first_frame_ms = (seconds() - start) * 1e3;
+    }
+    stop_loader(&loader);  // if init_offscreen_target etc. failed
+    double ready_ms = (seconds() - start) * 1e3;
+    scene.path = options->path;
+    scene.frame_plan.culling = options->culling;
+    scene.frame_plan.lod_pixels = options->lod_pixels;
+
+    for (int i = -WARMUP_FRAMES; i < options->num_frames && result == 0; i++) {
+        double frame_start = seconds();
+        gpu_begin_frame(scene.profiler);
+        draw_scene(&scene);
+        gpu_end_frame(scene.profiler);
+        glFinish();
+        if (i >= 0)
+            frame_ms[i] = (seconds() - frame_start) * 1e3;
+        if (num_placeholders == 0 && i == -WARMUP_FRAMES)
+            first_frame_ms = (seconds() - start) * 1e3;
+    }
+    if (result == 0) {
+        printf("%dx%d, %s path, %s vertices, %d bit indices, %d instances of %d meshes, ", width, height,
+            (scene.path == RENDER_CUBE) ? "cube" : "direct",
+            (scene.vertex_format == VERTEX_PACKED) ? "packed" : "float",
+            (scene.index_type == GL_UNSIGNED_SHORT) ? 16 : 32,
+            scene.frame_plan.num_instances, scene.frame_plan.num_meshes);
+        printf("culling %s: %d draws of %d instances, %lld triangles (last frame)\n",
+            scene.frame_plan.culling ? "on" : "off", scene.frame_plan.num_draws, scene.frame_plan.num_entries, (long long)scene.frame_plan.num_triangles);
+        printf("first frame after %.1f ms, scene ready after %.1f ms (%d placeholder frames)\n",
+            first_frame_ms, ready_ms, num_placeholders);
+        print_frame_times(frame_ms, options->num_frames, scene.profiler);
+    }
+
+    if (result == 0 && options->dump_path != NULL) {
+        Image image;
+        result = read_offscreen_target(&target, &image);
+        if (result == 0) {
+            result = write_ppm(options->dump_path, &image);
+            free_image(&image);
+        }
+    }
+
+    free(frame_ms);
+    if (profiler.history != NULL)
+        free_gpu_profiler(&profiler);
+    if (scene.draws != NULL)
+        free_scene_geo(&scene);
+    // NOTE: safe on a zeroed Scene; e.g. if the hallway never loaded
+    free_uniform_ring(&scene.uniforms);
+    free_cube_target(&scene.cube);
+    free_panini_lut(&scene.lut);
+    free_shader_manager(&scene.shaders);
+    free_offscreen_target(&target);
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+    return (result == 0) ? 0 : 1;
+}
 
+
+int main(int argc, char* argv[]) {
     int width  = WIDTH;
     int height = HEIGHT;
-    if (argc == 3) {
-        width  = atoi(argv[1]);
-        height = atoi(argv[2]);
+    bool headless = false;
+    HeadlessOptions headless_options = {.num_frames = 100, .path = RENDER_CUBE, .vertex_format = VERTEX_PACKED, .num_segments = 1, .culling = true, .lod_pixels = 1.0f, .dump_path = NULL};
+    int num_positional = 0;
+    bool bad_args = false;
+    for (int i = 1; i < argc && !bad_args; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && has_value) {
+            headless_options.num_frames = atoi(argv[++i]);
+            bad_args = headless_options.num_frames < 1;
+        } else if (strcmp(argv[i], "--size") == 0 && has_value) {
+            bad_args = sscanf(argv[++i], "%dx%d", &width, &height) != 2;
+        } else if (strcmp(argv[i], "--path") == 0 && has_value) {
+            i++;
+            if (strcmp(argv[i], "cube") == 0) {
+                headless_options.path = RENDER_CUBE;
+            } else if (strcmp(argv[i], "direct") == 0) {
+                headless_options.path = RENDER_DIRECT;
+            } else {
+                bad_args = true;
+            }
+        } else if (strcmp(argv[i], "--vertex") == 0 && has_value) {
+            i++;
+            if (strcmp(argv[i], "packed") == 0) {
+                headless_options.vertex_format = VERTEX_PACKED;
+            } else if (strcmp(argv[i], "float") == 0) {
+                headless_options.vertex_format = VERTEX_FLOAT;
+            } else {
+                bad_args = true;
+            }
+        } else if (strcmp(argv[i], "--segments") == 0 && has_value) {
+            headless_options.num_segments = atoi(argv[++i]);
+            bad_args = headless_options.num_segments < 1;
+        } else if (strcmp(argv[i], "--cull") == 0 && has_value) {
+            i++;
+            if (strcmp(argv[i], "on") == 0) {
+                headless_options.culling = true;
+            } else if (strcmp(argv[i], "off") == 0) {
+                headless_options.culling = false;
+            } else {
+                bad_args = true;
+            }
+        } else if (strcmp(argv[i], "--lod-pixels") == 0 && has_value) {
+            headless_options.lod_pixels = atof(argv[++i]);
+            bad_args = !(headless_options.lod_pixels >= 0.0f);
+        } else if (strcmp(argv[i], "--dump") == 0 && has_value) {
+            headless_options.dump_path = argv[++i];
+        } else if (argv[i][0] != '-' && num_positional < 2) {
+            // WIDTH HEIGHT
+            if (num_positional == 0) {
+                width = atoi(argv[i]);
+            } else {
+                height = atoi(argv[i]);
+            }
+            num_positional++;
+        } else {
+            bad_args = true;
+        }
     }
+    if (bad_args || num_positional == 1 || width <= 0 || height <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (headless)
+        return run_headless(width, height, &headless_options);
+
+    // NOTE: assets load while the window opens; placeholder frames until they're in
+    Loader loader = {0};
+    if (start_loader(&loader, ASSET_COUNT, scene_assets) != 0)
+        return 1;  // start_loader prints its own errors
 
     SDL_Window *window = NULL;
     if (init_window(width, height, &window) != 0) {
         fprintf(stderr, "init_window failed\n");
+        stop_loader(&loader);
         return 1;
     }
 
@@ -154,22 +657,32 @@ int main(int argc, char* argv[]) {
     SDL_GLContext context = NULL;  // void*
     if (init_context(4, 5, &window, &context) != 0) {
         fprintf(stderr, "init_context failed\n");
+        stop_loader(&loader);
         SDL_DestroyWindow(window);
         SDL_Quit();
         return 1;
     }
 
-    init_OpenGL();
-
-    Scene scene = {0, 0, 0, 0};
-    if (init_scene(&scene) != 0) {
-        fprintf(stderr, "init_scene failed\n");
+    if (init_OpenGL() != 0) {
+        fprintf(stderr, "init_OpenGL failed\n");
+        stop_loader(&loader);
         SDL_GL_DeleteContext(context);
         SDL_DestroyWindow(window);
         SDL_Quit();
         return 1;
     }
 
+    GpuProfiler profiler;
+    if (init_gpu_profiler(&profiler) != 0)
+        fprintf(stderr, "GPU profiler failed; no timings\n");
+
+    Scene scene = {0};
+    scene.profiler = (profiler.history != NULL) ? &profiler : NULL;
+    scene.output_framebuffer = 0;
+    scene.width = width;
+    scene.height = height;
+    bool scene_ready = false;
+
     Clock clock = {
         .accumulator = 0,
         .delta = 0,
@@ -178,7 +691,18 @@ int main(int argc, char* argv[]) {
     };
 
     bool running = true;
+    int result = 0;
     while (running) {
+        // assets & shaders; placeholder frames until they're in
+        // NOTE: only the GL thread pops; the loader thread never touches GL
+        if (!scene_ready) {
+            result = update_scene_load(&scene, &loader, 1, &scene_ready);
+            if (result != 0) {
+                fprintf(stderr, "init_scene failed\n");
+                break;
+            }
+        }
+
         // handle input events
         // TODO: break out into a function
         SDL_Event event;
@@ -190,6 +714,23 @@ int main(int argc, char* argv[]) {
                 case SDL_KEYDOWN:
                     if (event.key.keysym.sym == SDLK_ESCAPE) {
                         running = false;
+                    } else if (event.key.keysym.sym == SDLK_TAB) {
+                        // swap render paths
+                        scene.path = (scene.path == RENDER_CUBE) ? RENDER_DIRECT : RENDER_CUBE;
+                        printf("render path: %s\n", (scene.path == RENDER_CUBE) ? "cube" : "direct");
+                    } else if (event.key.keysym.sym == SDLK_F1) {
+                        profiler.overlay = !profiler.overlay;
+                    } else if (event.key.keysym.sym == SDLK_F2 && scene.profiler != NULL) {
+                        if (write_gpu_profile_csv(scene.profiler, GPU_PROFILE_CSV) == 0)
+                            printf("wrote %d frames to %s (%llu dropped)\n", profiler.history_count,
+                                GPU_PROFILE_CSV, (unsigned long long)profiler.num_dropped);
+                    }
+                    break;
+                case SDL_WINDOWEVENT:
+                    // NOTE: the panini LUT follows on the next draw
+                    if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                        scene.width = event.window.data1;
+                        scene.height = event.window.data2;
                     }
                     break;
                 default: break;
@@ -208,11 +749,28 @@ int main(int argc, char* argv[]) {
         clock.prev_tick = SDL_GetTicks64();
 
         // draw
-        draw_scene(&window, &scene);
+        gpu_begin_frame(scene.profiler);
+        if (scene_ready) {
+            draw_scene(&scene);
+        } else {
+            draw_placeholder(scene.output_framebuffer, scene.width, scene.height);
+        }
+        draw_gpu_overlay(scene.profiler, scene.output_framebuffer, scene.width, scene.height, FRAME_BUDGET_MS);
+        gpu_end_frame(scene.profiler);
+        SDL_GL_SwapWindow(window);
     }
 
+    stop_loader(&loader);  // quit before everything was in
+    if (scene.draws != NULL)
+        free_scene_geo(&scene);
+    // NOTE: safe on a zeroed Scene; e.g. if the hallway never loaded
+    free_uniform_ring(&scene.uniforms);
+    free_cube_target(&scene.cube);
+    free_panini_lut(&scene.lut);
+    free_shader_manager(&scene.shaders);
+    free_gpu_profiler(&profiler);
     SDL_GL_DeleteContext(context);
     SDL_DestroyWindow(window);
     SDL_Quit();
-    return 0;
+    return (result == 0) ? 0 : 1;
 }
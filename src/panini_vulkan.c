@@ -1,3 +1,393 @@
-int main(int argc, char* argv[]) {
+// Using C23 Standard
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// SDL3 (`pkg-config --cflags --libs sdl3`)
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_vulkan.h>
+
+#include "geometry.h"
+#include "image.h"
+#include "mesh_cache.h"
+#include "render_vulkan.h"
+#include "timing.h"
+
+
+// default to PSVita display resolution
+#define WIDTH  960
+#define HEIGHT 544
+
+// frames rendered before timing starts in --headless
+// -- the 1st frame sizes the cube map & records every slot
+#define WARMUP_FRAMES  3
+
+// models/hallway.obj runs from z = 0 to -10; segments are repeated down -Z
+#define HALLWAY_LENGTH  10.0f
+
+
+typedef struct HeadlessOptions_s {
+    int           num_frames;
+    VertexFormat  vertex_format;
+    int           num_segments;  // hallway instances
+    bool          culling;
+    float         lod_pixels;
+    char         *dump_path;  // last frame as .ppm; NULL to skip
+} HeadlessOptions;
+
+
+void print_usage(char* argv_0) {
+    printf("%s [WIDTH HEIGHT]\n", argv_0);
+    printf("%s --headless [--frames N] [--size WxH] [--vertex packed|float] [--segments N] [--cull on|off] [--lod-pixels N] [--dump out.ppm]\n", argv_0);
+    printf("SDL3 + Vulkan Panini Projection Test\n");
+    printf("    WIDTH    viewport width\n");
+    printf("    HEIGHT   viewport height\n");
+    printf("--headless renders N frames (default 100) offscreen w/o a window or GPU\n");
+    printf("    (no surface; lavapipe will do) & prints frame time percentiles\n");
+    printf("--segments N draws N hallways end to end (default 1); still 1 draw per frame\n");
+    printf("--cull off draws every instance on every face, skipping the BVH\n");
+    printf("--lod-pixels N: coarsest LOD w/ at most N pixels of error (default 1); 0 for full detail\n");
+}
+
+
+// NOTE: the geo is loaded from the binary cache; rebuilt from the .obj if stale
+// -- same options as panini_gl, so both share build/hallway.mesh
+static ObjOptions hallway_options = {.weld = true, .optimise = true, .lods = MAX_LODS, .num_threads = 0, .stats = NULL, .cancel = NULL};
+
+
+// NOTE: scene->vertex_format, width, height & swapchain must be set already
+// NOTE: loads synchronously, unlike panini_gl; 1 mesh (usually a mapped
+// build/hallway.mesh) & SPIR-V built ahead of time, so there's little to hide
+// -- & draw_scene has nothing to show until populate is done
+int init_scene(VulkanContext *vk, Scene *scene, int num_segments) {
+    MeshCache mesh;
+    if (open_mesh("models/hallway.obj", "build/hallway.mesh", &hallway_options, &mesh) != 0)
+        return 1;  // open_mesh prints its own errors
+
+    // 1 mesh, num_segments instances
+    SceneInstance *segments = malloc(sizeof(SceneInstance) * num_segments);
+    if (segments == NULL) {
+        fprintf(stderr, "out of memory for %d hallway segments\n", num_segments);
+        close_mesh(&mesh);
+        return 1;
+    }
+    for (int i = 0; i < num_segments; i++) {
+        segments[i].mesh = 0;
+        segments[i].transform = Mat4_translation((Vec3){0, 0, -HALLWAY_LENGTH * i});
+    }
+    SceneDesc desc = {
+        .num_meshes = 1,
+        .meshes = &mesh.geo,
+        .packed = &mesh.packed,
+        .num_instances = num_segments,
+        .instances = segments};
+
+    // push geo to GPU
+    // NOTE: populate waits for its uploads; the cache can be closed right after
+    int populated = populate(vk, scene, &desc);
+    free(segments);
+    close_mesh(&mesh);
+    if (populated != 0)
+        return 1;  // populate prints its own errors
+
+    // NOTE: the cube target & output are sized on the first begin_frame
+    if (init_frame_ring(vk, scene) != 0 || init_scene_pipelines(vk, scene) != 0)
+        return 1;  // both print their own errors
+
+    scene->panini = (PaniniParams){.d = 1.0f, .compression = 0.0f, .fov = 150.0f};
+    scene->frame_plan.culling = true;
+    scene->frame_plan.lod_pixels = 1.0f;
+    // NOTE: hallway.obj is modelled in GL view space; +Y up, looking down -Z
+    scene->camera = (Camera){
+        .right = {1, 0, 0}, .up = {0, 1, 0}, .forward = {0, 0, -1}, .position = {0, 0, 0}};
+    return 0;
+}
+
+
+// frames are pipelined FRAME_LATENCY deep, like a window would be
+// -- frame time is begin_frame to submit; steady state, that's the GPU's throughput
+// -- submit is draw_scene alone; culling, LOD picks & the ring writes
+int run_headless(int width, int height, HeadlessOptions *options) {
+    double start = seconds();
+    VulkanContext vk = {0};
+    if (init_vulkan(&vk, 0, NULL) != 0 || init_vulkan_device(&vk, VK_NULL_HANDLE) != 0) {
+        free_vulkan(&vk);
+        return 1;  // both print their own errors
+    }
+    printf("%s\n", vk.properties.deviceName);
+
+    Scene scene = {0};
+    scene.swapchain = NULL;
+    scene.width = width;
+    scene.height = height;
+    scene.vertex_format = options->vertex_format;
+    // 4 times per frame: frame, submit, GPU cube & GPU reproject
+    double *times = malloc(sizeof(double) * options->num_frames * 4);
+    int result = 0;
+    if (times == NULL) {
+        fprintf(stderr, "out of memory for %d frame times\n", options->num_frames);
+        result = 1;
+    }
+    if (result == 0)
+        result = init_scene(&vk, &scene, options->num_segments);
+    double ready_ms = (seconds() - start) * 1e3;
+    scene.frame_plan.culling = options->culling;
+    scene.frame_plan.lod_pixels = options->lod_pixels;
+
+    double *frame_ms = times;
+    double *submit_ms = &times[options->num_frames];
+    double *cube_ms = &times[options->num_frames * 2];
+    double *reproject_ms = &times[options->num_frames * 3];
+    int num_gpu = 0;
+    int64_t last_gpu_frame = -1;
+    double first_frame_ms = 0.0;
+    for (int i = -WARMUP_FRAMES; i < options->num_frames && result == 0; i++) {
+        double frame_start = seconds();
+        result = begin_frame(&vk, &scene);
+        double submit_start = seconds();
+        if (result == 0)
+            result = draw_scene(&vk, &scene);
+        double frame_end = seconds();
+        if (i >= 0) {
+            frame_ms[i] = (frame_end - frame_start) * 1e3;
+            submit_ms[i] = (frame_end - submit_start) * 1e3;
+        }
+        if (i == -WARMUP_FRAMES)
+            first_frame_ms = (frame_end - start) * 1e3;
+        // NOTE: GPU timings trail by FRAME_LATENCY frames; the last few are never read
+        if (scene.gpu_frame >= WARMUP_FRAMES && scene.gpu_frame != last_gpu_frame) {
+            cube_ms[num_gpu] = scene.gpu_ms[0];
+            reproject_ms[num_gpu++] = scene.gpu_ms[1];
+            last_gpu_frame = scene.gpu_frame;
+        }
+    }
+    if (result == 0) {
+        printf("%dx%d, cube path, %s vertices, %d bit indices, %d instances of %d meshes, ", width, height,
+            (scene.vertex_format == VERTEX_PACKED) ? "packed" : "float",
+            (scene.index_type == VK_INDEX_TYPE_UINT16) ? 16 : 32,
+            scene.frame_plan.num_instances, scene.frame_plan.num_meshes);
+        printf("culling %s: %d draws of %d instances, %lld triangles (last frame)\n",
+            scene.frame_plan.culling ? "on" : "off", scene.frame_plan.num_draws, scene.frame_plan.num_entries, (long long)scene.frame_plan.num_triangles);
+        printf("first frame after %.1f ms, scene ready after %.1f ms\n", first_frame_ms, ready_ms);
+        double total = 0.0;
+        for (int i = 0; i < options->num_frames; i++)
+            total += frame_ms[i];
+        printf("%d frames: mean %.2f ms (%.1f fps), %llu waited on the GPU\n", options->num_frames,
+            total / options->num_frames, options->num_frames * 1e3 / total,
+            (unsigned long long)scene.frames.num_waits);
+        print_percentiles("frame", frame_ms, options->num_frames);
+        print_percentiles("submit", submit_ms, options->num_frames);
+        if (num_gpu > 0) {
+            print_percentiles("gpu cube", cube_ms, num_gpu);
+            print_percentiles("gpu reproject", reproject_ms, num_gpu);
+        }
+    }
+
+    if (result == 0 && options->dump_path != NULL) {
+        Image image;
+        result = read_output(&vk, &scene, &image);
+        if (result == 0) {
+            result = write_ppm(options->dump_path, &image);
+            free_image(&image);
+        }
+    }
+
+    free(times);
+    if (vk.device != VK_NULL_HANDLE) {
+        free_scene(&vk, &scene);
+        free_scene_geo(&vk, &scene);
+    }
+    free_vulkan(&vk);
+    return (result == 0) ? 0 : 1;
+}
+
+
+int init_window(int width, int height, SDL_Window **window) {
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
+        fprintf(stderr, "Couldn't initialise SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    *window = SDL_CreateWindow(
+        "Panini Projection Test (SDL3 + Vulkan)",
+        width, height,
+        SDL_WINDOW_VULKAN | SDL_WINDOW_BORDERLESS);
+
+    if (*window == NULL) {
+        fprintf(stderr, "Couldn't make a window: %s\n", SDL_GetError());
+        return 1;
+    }
+
     return 0;
 }
+
+
+// new swapchain for the window's current size; the scene re-records on its next begin_frame
+// NOTE: 0 w/ nothing to do while the window is minimised
+int rebuild_swapchain(VulkanContext *vk, Scene *scene, SDL_Window *window) {
+    int width, height;
+    SDL_GetWindowSizeInPixels(window, &width, &height);
+    free_swapchain(vk, scene->swapchain);
+    scene->recorded = false;
+    if (width == 0 || height == 0)
+        return 0;
+    if (init_swapchain(vk, scene->swapchain, width, height) != 0)
+        return 1;  // init_swapchain prints its own errors
+    scene->width = scene->swapchain->extent.width;
+    scene->height = scene->swapchain->extent.height;
+    return 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    int width  = WIDTH;
+    int height = HEIGHT;
+    bool headless = false;
+    HeadlessOptions headless_options = {.num_frames = 100, .vertex_format = VERTEX_PACKED, .num_segments = 1, .culling = true, .lod_pixels = 1.0f, .dump_path = NULL};
+    int num_positional = 0;
+    bool bad_args = false;
+    for (int i = 1; i < argc && !bad_args; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && has_value) {
+            headless_options.num_frames = atoi(argv[++i]);
+            bad_args = headless_options.num_frames < 1;
+        } else if (strcmp(argv[i], "--size") == 0 && has_value) {
+            bad_args = sscanf(argv[++i], "%dx%d", &width, &height) != 2;
+        } else if (strcmp(argv[i], "--vertex") == 0 && has_value) {
+            i++;
+            if (strcmp(argv[i], "packed") == 0) {
+                headless_options.vertex_format = VERTEX_PACKED;
+            } else if (strcmp(argv[i], "float") == 0) {
+                headless_options.vertex_format = VERTEX_FLOAT;
+            } else {
+                bad_args = true;
+            }
+        } else if (strcmp(argv[i], "--segments") == 0 && has_value) {
+            headless_options.num_segments = atoi(argv[++i]);
+            bad_args = headless_options.num_segments < 1;
+        } else if (strcmp(argv[i], "--cull") == 0 && has_value) {
+            i++;
+            if (strcmp(argv[i], "on") == 0) {
+                headless_options.culling = true;
+            } else if (strcmp(argv[i], "off") == 0) {
+                headless_options.culling = false;
+            } else {
+                bad_args = true;
+            }
+        } else if (strcmp(argv[i], "--lod-pixels") == 0 && has_value) {
+            headless_options.lod_pixels = atof(argv[++i]);
+            bad_args = !(headless_options.lod_pixels >= 0.0f);
+        } else if (strcmp(argv[i], "--dump") == 0 && has_value) {
+            headless_options.dump_path = argv[++i];
+        } else if (argv[i][0] != '-' && num_positional < 2) {
+            // WIDTH HEIGHT
+            if (num_positional == 0) {
+                width = atoi(argv[i]);
+            } else {
+                height = atoi(argv[i]);
+            }
+            num_positional++;
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args || num_positional == 1 || width <= 0 || height <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (headless)
+        return run_headless(width, height, &headless_options);
+
+    SDL_Window *window = NULL;
+    if (init_window(width, height, &window) != 0) {
+        fprintf(stderr, "init_window failed\n");
+        SDL_Quit();
+        return 1;
+    }
+
+    // NOTE: SDL knows which surface extensions this platform needs
+    VulkanContext vk = {0};
+    Uint32 num_extensions = 0;
+    const char* const* extensions = SDL_Vulkan_GetInstanceExtensions(&num_extensions);
+    Swapchain swapchain = {0};
+    int result = 0;
+    if (extensions == NULL) {
+        fprintf(stderr, "SDL_Vulkan_GetInstanceExtensions failed: %s\n", SDL_GetError());
+        result = 1;
+    }
+    if (result == 0)
+        result = init_vulkan(&vk, num_extensions, extensions);
+    if (result == 0 && !SDL_Vulkan_CreateSurface(window, vk.instance, NULL, &swapchain.surface)) {
+        fprintf(stderr, "SDL_Vulkan_CreateSurface failed: %s\n", SDL_GetError());
+        result = 1;
+    }
+    if (result == 0)
+        result = init_vulkan_device(&vk, swapchain.surface);
+
+    Scene scene = {0};
+    scene.swapchain = &swapchain;
+    scene.vertex_format = VERTEX_PACKED;
+    if (result == 0)
+        result = rebuild_swapchain(&vk, &scene, window);
+    if (result == 0)
+        result = init_scene(&vk, &scene, 1);
+    if (result != 0)
+        fprintf(stderr, "init_scene failed\n");
+
+    bool running = result == 0;
+    while (running) {
+        // handle input events
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            switch (event.type) {
+                case SDL_EVENT_QUIT:
+                    running = false;
+                    break;
+                case SDL_EVENT_KEY_DOWN:
+                    if (event.key.key == SDLK_ESCAPE)
+                        running = false;
+                    break;
+                case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                    swapchain.stale = true;
+                    break;
+                default: break;
+            }
+        }
+        if (!running)
+            break;
+
+        // NOTE: a minimised window has no swapchain; nothing to draw to
+        if (swapchain.stale || swapchain.swapchain == VK_NULL_HANDLE) {
+            result = rebuild_swapchain(&vk, &scene, window);
+            if (result != 0)
+                break;
+            if (swapchain.swapchain == VK_NULL_HANDLE) {
+                SDL_Delay(15);
+                continue;
+            }
+        }
+
+        // draw
+        // NOTE: presents too; no separate swap
+        result = begin_frame(&vk, &scene);
+        if (result == 0)
+            result = draw_scene(&vk, &scene);
+        if (result != 0)
+            break;
+    }
+
+    if (vk.device != VK_NULL_HANDLE) {
+        free_scene(&vk, &scene);
+        free_scene_geo(&vk, &scene);
+        free_swapchain(&vk, &swapchain);
+    }
+    if (swapchain.surface != VK_NULL_HANDLE)
+        SDL_Vulkan_DestroySurface(vk.instance, swapchain.surface, NULL);
+    free_vulkan(&vk);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return (result == 0) ? 0 : 1;
+}
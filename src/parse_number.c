@@ -0,0 +1,461 @@
+// Using C23 Standard
+#include <float.h>
+#include <limits.h>
+// Math (-lm)
+#include <math.h>  // INFINITY
+#include <stdlib.h>  // strtof
+#include <string.h>
+
+#include "parse_number.h"
+
+
+// Eisel-Lemire for binary32
+// -- see "Number Parsing at a Gigabyte per Second" (Lemire, 2021)
+// -- & the fast_float library it came from
+#define SMALLEST_POWER_OF_TEN  -64
+#define LARGEST_POWER_OF_TEN    38
+#define MANTISSA_BITS           23  // explicit mantissa bits of a float
+#define MAX_DIGITS              19  // decimal digits that always fit in a uint64_t
+
+
+// 5^q, normalised to 128 bits (truncated; rounded up for q < 0)
+// generated w/ the script from the paper, cropped to the float range
+static const uint64_t power_of_five[][2] = {
+    {0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL},  // 5^-64
+    {0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL},  // 5^-63
+    {0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL},  // 5^-62
+    {0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL},  // 5^-61
+    {0xCDB02555653131B6ULL, 0x3792F412CB06794DULL},  // 5^-60
+    {0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL},  // 5^-59
+    {0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL},  // 5^-58
+    {0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL},  // 5^-57
+    {0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL},  // 5^-56
+    {0x9CED737BB6C4183DULL, 0x55464DD69685606BULL},  // 5^-55
+    {0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL},  // 5^-54
+    {0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL},  // 5^-53
+    {0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL},  // 5^-52
+    {0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL},  // 5^-51
+    {0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL},  // 5^-50
+    {0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL},  // 5^-49
+    {0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL},  // 5^-48
+    {0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL},  // 5^-47
+    {0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL},  // 5^-46
+    {0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL},  // 5^-45
+    {0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL},  // 5^-44
+    {0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL},  // 5^-43
+    {0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL},  // 5^-42
+    {0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL},  // 5^-41
+    {0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL},  // 5^-40
+    {0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL},  // 5^-39
+    {0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL},  // 5^-38
+    {0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL},  // 5^-37
+    {0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL},  // 5^-36
+    {0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL},  // 5^-35
+    {0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL},  // 5^-34
+    {0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL},  // 5^-33
+    {0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL},  // 5^-32
+    {0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL},  // 5^-31
+    {0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL},  // 5^-30
+    {0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL},  // 5^-29
+    {0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL},  // 5^-28
+    {0x9E74D1B791E07E48ULL, 0x775EA264CF55347EULL},  // 5^-27
+    {0xC612062576589DDAULL, 0x95364AFE032A819EULL},  // 5^-26
+    {0xF79687AED3EEC551ULL, 0x3A83DDBD83F52205ULL},  // 5^-25
+    {0x9ABE14CD44753B52ULL, 0xC4926A9672793543ULL},  // 5^-24
+    {0xC16D9A0095928A27ULL, 0x75B7053C0F178294ULL},  // 5^-23
+    {0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6339ULL},  // 5^-22
+    {0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E04ULL},  // 5^-21
+    {0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF585ULL},  // 5^-20
+    {0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E6ULL},  // 5^-19
+    {0x9392EE8E921D5D07ULL, 0x3AFF322E62439FD0ULL},  // 5^-18
+    {0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C3ULL},  // 5^-17
+    {0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B4ULL},  // 5^-16
+    {0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A11ULL},  // 5^-15
+    {0xB424DC35095CD80FULL, 0x538484C19EF38C95ULL},  // 5^-14
+    {0xE12E13424BB40E13ULL, 0x2865A5F206B06FBAULL},  // 5^-13
+    {0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D4ULL},  // 5^-12
+    {0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D749ULL},  // 5^-11
+    {0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1CULL},  // 5^-10
+    {0x89705F4136B4A597ULL, 0x31680A88F8953031ULL},  // 5^-9
+    {0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3EULL},  // 5^-8
+    {0xD6BF94D5E57A42BCULL, 0x3D32907604691B4DULL},  // 5^-7
+    {0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B110ULL},  // 5^-6
+    {0xA7C5AC471B478423ULL, 0x0FCF80DC33721D54ULL},  // 5^-5
+    {0xD1B71758E219652BULL, 0xD3C36113404EA4A9ULL},  // 5^-4
+    {0x83126E978D4FDF3BULL, 0x645A1CAC083126EAULL},  // 5^-3
+    {0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A4ULL},  // 5^-2
+    {0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCDULL},  // 5^-1
+    {0x8000000000000000ULL, 0x0000000000000000ULL},  // 5^0
+    {0xA000000000000000ULL, 0x0000000000000000ULL},  // 5^1
+    {0xC800000000000000ULL, 0x0000000000000000ULL},  // 5^2
+    {0xFA00000000000000ULL, 0x0000000000000000ULL},  // 5^3
+    {0x9C40000000000000ULL, 0x0000000000000000ULL},  // 5^4
+    {0xC350000000000000ULL, 0x0000000000000000ULL},  // 5^5
+    {0xF424000000000000ULL, 0x0000000000000000ULL},  // 5^6
+    {0x9896800000000000ULL, 0x0000000000000000ULL},  // 5^7
+    {0xBEBC200000000000ULL, 0x0000000000000000ULL},  // 5^8
+    {0xEE6B280000000000ULL, 0x0000000000000000ULL},  // 5^9
+    {0x9502F90000000000ULL, 0x0000000000000000ULL},  // 5^10
+    {0xBA43B74000000000ULL, 0x0000000000000000ULL},  // 5^11
+    {0xE8D4A51000000000ULL, 0x0000000000000000ULL},  // 5^12
+    {0x9184E72A00000000ULL, 0x0000000000000000ULL},  // 5^13
+    {0xB5E620F480000000ULL, 0x0000000000000000ULL},  // 5^14
+    {0xE35FA931A0000000ULL, 0x0000000000000000ULL},  // 5^15
+    {0x8E1BC9BF04000000ULL, 0x0000000000000000ULL},  // 5^16
+    {0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL},  // 5^17
+    {0xDE0B6B3A76400000ULL, 0x0000000000000000ULL},  // 5^18
+    {0x8AC7230489E80000ULL, 0x0000000000000000ULL},  // 5^19
+    {0xAD78EBC5AC620000ULL, 0x0000000000000000ULL},  // 5^20
+    {0xD8D726B7177A8000ULL, 0x0000000000000000ULL},  // 5^21
+    {0x878678326EAC9000ULL, 0x0000000000000000ULL},  // 5^22
+    {0xA968163F0A57B400ULL, 0x0000000000000000ULL},  // 5^23
+    {0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL},  // 5^24
+    {0x84595161401484A0ULL, 0x0000000000000000ULL},  // 5^25
+    {0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL},  // 5^26
+    {0xCECB8F27F4200F3AULL, 0x0000000000000000ULL},  // 5^27
+    {0x813F3978F8940984ULL, 0x4000000000000000ULL},  // 5^28
+    {0xA18F07D736B90BE5ULL, 0x5000000000000000ULL},  // 5^29
+    {0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL},  // 5^30
+    {0xFC6F7C4045812296ULL, 0x4D00000000000000ULL},  // 5^31
+    {0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL},  // 5^32
+    {0xC5371912364CE305ULL, 0x6C28000000000000ULL},  // 5^33
+    {0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL},  // 5^34
+    {0x9A130B963A6C115CULL, 0x3C7F400000000000ULL},  // 5^35
+    {0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL},  // 5^36
+    {0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL},  // 5^37
+    {0x96769950B50D88F4ULL, 0x1314448000000000ULL},  // 5^38
+};
+
+
+static const uint64_t power_of_ten[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+    10000000ull, 100000000ull};
+
+
+// exact in single precision; for the fast path
+static const float power_of_ten_f[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+
+static inline int leading_zeros_64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & 0x8000000000000000ull)) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+
+static inline void multiply_64(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *hi = (uint64_t)(product >> 64);
+    *lo = (uint64_t)product;
+#else
+    uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+    uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    *hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    *lo = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+}
+
+
+// SWAR: scan & convert up to 8 digits w/ a few 64-bit ops
+// NOTE: needs 8 readable bytes & a little endian load
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SWAR_DIGITS
+
+static inline uint64_t load_8(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
+// how many of the 8 chars in v are digits before the first non-digit
+static inline int count_digits_8(uint64_t v) {
+    // high bit of each byte is set if the byte is < '0' or > '9'
+    uint64_t non_digit = ((v + 0x4646464646464646ull) | (v - 0x3030303030303030ull)) & 0x8080808080808080ull;
+    if (non_digit == 0)
+        return 8;
+#if defined(__GNUC__)
+    return __builtin_ctzll(non_digit) / 8;
+#else
+    int n = 0;
+    while (!(non_digit & 0x80)) {
+        non_digit >>= 8;
+        n++;
+    }
+    return n;
+#endif
+}
+
+
+// 8 ascii digits (first digit in the low byte) -> integer
+static inline uint32_t convert_digits_8(uint64_t v) {
+    const uint64_t mask = 0x000000FF000000FFull;
+    const uint64_t mul1 = 0x000F424000000064ull;  // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ull;  // 1 + (10000 << 32)
+    v -= 0x3030303030303030ull;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)v;
+}
+#endif
+
+
+// consume a run of up to 8 digits at once
+// -- returns the number of digits read (0 if there aren't 8 bytes to load)
+static inline int read_digits_8(const char *p, const char *end, uint32_t *value) {
+#ifdef SWAR_DIGITS
+    if (end - p < 8)
+        return 0;
+    uint64_t v = load_8(p);
+    int n = count_digits_8(v);
+    if (n == 0)
+        return 0;
+    if (n < 8) {  // right align the digits & pad w/ leading '0's
+        int shift = 8 * (8 - n);
+        v = (v << shift) | (0x3030303030303030ull >> (64 - shift));
+    }
+    *value = convert_digits_8(v);
+    return n;
+#else
+    return 0;
+#endif
+}
+
+
+// w * 10^q -> float, w/o rounding twice
+// -- returns 0 on success, 1 if the slow path is needed
+static int eisel_lemire(uint64_t w, int q, float *dest) {
+    if (q < SMALLEST_POWER_OF_TEN) {
+        *dest = 0.0f;
+        return 0;
+    }
+    if (q > LARGEST_POWER_OF_TEN) {
+        *dest = INFINITY;
+        return 0;
+    }
+    int lz = leading_zeros_64(w);
+    w <<= lz;
+
+    const uint64_t *pow5 = power_of_five[q - SMALLEST_POWER_OF_TEN];
+    uint64_t hi, lo;
+    multiply_64(w, pow5[0], &hi, &lo);
+    const uint64_t precision_mask = UINT64_MAX >> (MANTISSA_BITS + 3);
+    if ((hi & precision_mask) == precision_mask) {  // need more precision
+        uint64_t hi_2, lo_2;
+        multiply_64(w, pow5[1], &hi_2, &lo_2);
+        lo += hi_2;
+        if (hi_2 > lo)
+            hi++;
+    }
+    if (lo == UINT64_MAX)
+        return 1;  // truncated product; can't tell which way to round
+
+    int upper_bit = (int)(hi >> 63);
+    int shift = upper_bit + 64 - MANTISSA_BITS - 3;
+    uint64_t mantissa = hi >> shift;
+    // floor(log2(10^q)) + 63, biased by 127
+    int power_2 = (((152170 + 65536) * q) >> 16) + 63 + upper_bit - lz + 127;
+    if (power_2 <= 0)
+        return 1;  // subnormal
+
+    // exactly halfway between two floats: round to even
+    if (lo <= 1 && q >= -17 && q <= 10 && (mantissa & 3) == 1) {
+        if ((mantissa << shift) == hi)
+            mantissa &= ~(uint64_t)1;
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= ((uint64_t)2 << MANTISSA_BITS)) {  // rounded up to the next power of 2
+        mantissa = (uint64_t)1 << MANTISSA_BITS;
+        power_2++;
+    }
+    mantissa &= ~((uint64_t)1 << MANTISSA_BITS);
+    if (power_2 >= 0xFF) {
+        *dest = INFINITY;
+        return 0;
+    }
+    uint32_t bits = (uint32_t)mantissa | ((uint32_t)power_2 << MANTISSA_BITS);
+    memcpy(dest, &bits, sizeof(bits));
+    return 0;
+}
+
+
+int parse_float(const char **head, const char *end, float *dest) {
+    const char *p = *head;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int  exponent = 0;
+    int  num_digits = 0;  // significant digits in mantissa
+    bool truncated = false;  // more than MAX_DIGITS significant digits
+    bool any_digits = false;
+
+    // integer part
+    while (p < end) {
+        if (mantissa != 0 && num_digits + 8 <= MAX_DIGITS) {
+            uint32_t digits;
+            int n = read_digits_8(p, end, &digits);
+            if (n > 0) {
+                mantissa = mantissa * power_of_ten[n] + digits;
+                num_digits += n;
+                p += n;
+                continue;
+            }
+        }
+        if (!is_digit(*p))
+            break;
+        any_digits = true;
+        int digit = *p - '0';
+        if (num_digits < MAX_DIGITS) {
+            if (mantissa != 0 || digit != 0) {  // skip leading zeros
+                mantissa = mantissa * 10 + digit;
+                num_digits++;
+            }
+        } else {
+            truncated = true;
+            exponent++;
+        }
+        p++;
+    }
+
+    // fractional part
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end) {
+            if (mantissa != 0 && num_digits + 8 <= MAX_DIGITS) {
+                uint32_t digits;
+                int n = read_digits_8(p, end, &digits);
+                if (n > 0) {
+                    mantissa = mantissa * power_of_ten[n] + digits;
+                    num_digits += n;
+                    exponent -= n;
+                    p += n;
+                    continue;
+                }
+            }
+            if (!is_digit(*p))
+                break;
+            any_digits = true;
+            int digit = *p - '0';
+            if (num_digits < MAX_DIGITS) {
+                if (mantissa != 0 || digit != 0) {
+                    mantissa = mantissa * 10 + digit;
+                    num_digits++;
+                }
+                exponent--;
+            } else {
+                truncated = true;
+            }
+            p++;
+        }
+    }
+    if (!any_digits)
+        return 1;  // no digits ("", "-", ".", "abc")
+
+    // exponent
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative_exponent = (*p == '-');
+            p++;
+        }
+        if (p >= end || !is_digit(*p))
+            return 2;  // "1e", "1e+"
+        int e = 0;
+        while (p < end && is_digit(*p)) {
+            if (e < 100000)  // way past the float range either way
+                e = e * 10 + (*p - '0');
+            p++;
+        }
+        exponent += negative_exponent ? -e : e;
+    }
+
+    float value;
+    if (mantissa == 0) {
+        value = 0.0f;
+#if FLT_EVAL_METHOD == 0
+    // Clinger's fast path: both operands are exact, so one rounding
+    } else if (!truncated && mantissa <= (1u << 24) && exponent >= -10 && exponent <= 10) {
+        value = (float)mantissa;
+        if (exponent < 0)
+            value /= power_of_ten_f[-exponent];
+        else
+            value *= power_of_ten_f[exponent];
+#endif
+    } else if (truncated || eisel_lemire(mantissa, exponent, &value) != 0) {
+        // rare: subnormals, ties we can't resolve & > 19 digits
+        // NOTE: strtof is locale sensitive; panini never calls setlocale
+        char token[128];
+        size_t length = p - *head;
+        if (length >= sizeof(token))
+            return 3;  // too long to be a sensible number
+        memcpy(token, *head, length);
+        token[length] = '\0';
+        *dest = strtof(token, NULL);
+        *head = p;
+        return 0;
+    }
+
+    *dest = negative ? -value : value;
+    *head = p;
+    return 0;
+}
+
+
+int parse_int(const char **head, const char *end, int *dest) {
+    const char *p = *head;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    uint64_t value = 0;
+    int num_digits = 0;
+    uint32_t digits;
+    int n = read_digits_8(p, end, &digits);
+    if (n > 0) {
+        value = digits;
+        num_digits = n;
+        p += n;
+    }
+    while (p < end && is_digit(*p)) {
+        value = value * 10 + (*p - '0');
+        num_digits++;
+        p++;
+        if (num_digits > 10)
+            return 2;  // too big
+    }
+    if (num_digits == 0)
+        return 1;  // no digits
+    if (value > (uint64_t)INT_MAX + (negative ? 1 : 0))
+        return 2;  // too big
+
+    *dest = negative ? (int)(-(int64_t)value) : (int)value;
+    *head = p;
+    return 0;
+}
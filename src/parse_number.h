@@ -0,0 +1,15 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdint.h>
+
+
+// number parsing for text formats (.obj etc.)
+// -- not locale sensitive; '.' is always the decimal point
+// -- parse from *head up to end, then advance *head past the number
+// -- return 0 on success, non-zero for malformed numbers (*head untouched)
+// NOTE: callers check what follows the number (whitespace, '/' etc.)
+
+// correctly rounded, same result as strtof
+int parse_float(const char **head, const char *end, float *dest);
+int parse_int(const char **head, const char *end, int *dest);
@@ -1,5 +1,9 @@
 // Using C23 Standard
+// Math (-lm)
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 // SDL2 (`sdl2-config --cflags --libs`)
 #include <SDL2/SDL.h>
@@ -7,182 +11,625 @@
 #include "render_gl.h"
 
 
-void populate(Scene *scene, Geometry *geo) {
+int populate(Scene *scene, SceneDesc *desc) {
+    // instances grouped by mesh, LODs & the culling BVH; see frame_plan.h
+    FramePlan *frame = &scene->frame_plan;
+    Mat4 *transforms = NULL;
+    if (init_frame_plan(frame, desc, &transforms) != 0)
+        return 1;  // init_frame_plan prints its own errors
+
+    // 1 command per LOD of each mesh
+    scene->draws = malloc(sizeof(DrawElementsIndirectCommand) * frame->num_levels);
+    int *base_vertices = malloc(sizeof(int) * desc->num_meshes);
+    int *first_indices = malloc(sizeof(int) * desc->num_meshes);
+    if (scene->draws == NULL || base_vertices == NULL || first_indices == NULL) {
+        fprintf(stderr, "out of memory for %d meshes\n", desc->num_meshes);
+        free(base_vertices);
+        free(first_indices);
+        free(transforms);
+        free_scene_geo(scene);
+        return 1;
+    }
+    int num_vertices = 0;
+    int num_indices = 0;
+    int max_narrowed = 0;  // indices of 1 mesh w/o PackedMesh.indices
+    bool short_indices = true;
+    for (int i = 0; i < desc->num_meshes; i++) {
+        Geometry *geo = &desc->meshes[i];
+        base_vertices[i] = num_vertices;
+        first_indices[i] = num_indices;
+        // NOTE: coarser LODs are later in geo->indices; 1 upload covers them all
+        int base_instances = frame->mesh_instances[i];
+        int level = frame->mesh_levels[i];
+        for (int j = 0; level < frame->mesh_levels[i + 1]; j++, level++) {
+            Geometry lod = geometry_lod(geo, j);
+            DrawElementsIndirectCommand *draw = &scene->draws[level];
+            draw->count = lod.num_indices;
+            draw->first_index = num_indices + (lod.indices - geo->indices);
+            draw->base_vertex = num_vertices;
+            draw->base_instance = base_instances;
+            draw->instance_count = frame->mesh_instances[i + 1] - base_instances;
+        }
+        num_vertices += geo->num_vertices;
+        num_indices += geo->num_indices;
+        // NOTE: indices stay local to each mesh; base_vertex does the rest
+        short_indices = short_indices && geo->num_vertices <= UINT16_MAX + 1;
+        if (desc->packed == NULL || desc->packed[i].indices == NULL)
+            max_narrowed = (geo->num_indices > max_narrowed) ? geo->num_indices : max_narrowed;
+    }
+    uint16_t *narrowed = (short_indices && max_narrowed > 0) ? malloc(sizeof(uint16_t) * max_narrowed) : NULL;
+    short_indices = short_indices && (max_narrowed == 0 || narrowed != NULL);
+    scene->num_indices = num_indices;
+    scene->index_type = short_indices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
     // NOTE: core OpenGL profiles must use a VAO
     // -- this restriction does not apply to compatibility profiles
     glGenVertexArrays(1, &scene->vertex_array);
     glBindVertexArray(scene->vertex_array);
 
     // vertex buffer
+    // -- 1 VertexBounds around every mesh, so 1 decode in the shaders
+    // NOTE: desc->packed (e.g. a mapped mesh cache) goes straight to GL if it was
+    // packed against those bounds; always true w/ 1 mesh. otherwise packed on the fly
+    bool is_prepacked = false;
+    PackedVertex *packed = NULL;
+    if (scene->vertex_format == VERTEX_PACKED) {
+        VertexBounds *bounds = &scene->vertex_bounds;
+        merge_vertex_bounds(desc->num_meshes, desc->meshes, desc->packed, bounds);
+        is_prepacked = prepacked(desc->num_meshes, desc->meshes, desc->packed, bounds);
+        if (!is_prepacked) {
+            packed = malloc(sizeof(PackedVertex) * num_vertices);
+            if (packed == NULL) {
+                fprintf(stderr, "out of memory packing %d vertices; uploading floats\n", num_vertices);
+                scene->vertex_format = VERTEX_FLOAT;
+            }
+        }
+    }
     glGenBuffers(1, &scene->vertex_buffer);
     glBindBuffer(GL_ARRAY_BUFFER, scene->vertex_buffer);
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        sizeof(Vertex) * geo->num_vertices, geo->vertices,
-        GL_STATIC_DRAW);
+    if (is_prepacked) {
+        glBufferData(GL_ARRAY_BUFFER, sizeof(PackedVertex) * num_vertices, NULL, GL_STATIC_DRAW);
+        for (int i = 0; i < desc->num_meshes; i++) {
+            glBufferSubData(
+                GL_ARRAY_BUFFER,
+                sizeof(PackedVertex) * base_vertices[i],
+                sizeof(PackedVertex) * desc->meshes[i].num_vertices, desc->packed[i].vertices);
+        }
+    } else if (packed != NULL) {
+        for (int i = 0; i < desc->num_meshes; i++)
+            pack_vertices(&desc->meshes[i], &scene->vertex_bounds, &packed[base_vertices[i]]);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            sizeof(PackedVertex) * num_vertices, packed,
+            GL_STATIC_DRAW);
+        free(packed);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * num_vertices, NULL, GL_STATIC_DRAW);
+        for (int i = 0; i < desc->num_meshes; i++) {
+            glBufferSubData(
+                GL_ARRAY_BUFFER,
+                sizeof(Vertex) * base_vertices[i],
+                sizeof(Vertex) * desc->meshes[i].num_vertices, desc->meshes[i].vertices);
+        }
+    }
 
     // vertex attribs
+    // NOTE: same locations either way; the shaders decode w/ PACKED_VERTEX
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(
-        0, 3, GL_FLOAT, GL_FALSE,
-        sizeof(Vertex), (void*)offsetof(Vertex, position));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(
-        1, 3, GL_FLOAT, GL_FALSE,
-        sizeof(Vertex), (void*)offsetof(Vertex, normal));
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(
-        2, 2, GL_FLOAT, GL_FALSE,
-        sizeof(Vertex), (void*)offsetof(Vertex, uv));
+    if (scene->vertex_format == VERTEX_PACKED) {
+        glVertexAttribPointer(
+            0, 3, GL_UNSIGNED_SHORT, GL_TRUE,
+            sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+        glVertexAttribPointer(
+            1, 2, GL_SHORT, GL_TRUE,
+            sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+        glVertexAttribPointer(
+            2, 2, GL_HALF_FLOAT, GL_FALSE,
+            sizeof(PackedVertex), (void*)offsetof(PackedVertex, uv));
+    } else {
+        glVertexAttribPointer(
+            0, 3, GL_FLOAT, GL_FALSE,
+            sizeof(Vertex), (void*)offsetof(Vertex, position));
+        glVertexAttribPointer(
+            1, 3, GL_FLOAT, GL_FALSE,
+            sizeof(Vertex), (void*)offsetof(Vertex, normal));
+        glVertexAttribPointer(
+            2, 2, GL_FLOAT, GL_FALSE,
+            sizeof(Vertex), (void*)offsetof(Vertex, uv));
+    }
+
+    // visible instance & its faces; 1 per instance, fetched at base_instance + gl_InstanceID
+    // -- so it picks the instance's transform w/o ARB_shader_draw_parameters
+    // NOTE: binding 3 is the frame's draws in the uniform ring; see write_frame_draws
+    glEnableVertexArrayAttrib(scene->vertex_array, 3);
+    glVertexArrayAttribIFormat(scene->vertex_array, 3, 1, GL_UNSIGNED_INT, 0);
+    glVertexArrayAttribBinding(scene->vertex_array, 3, 3);
+    glVertexArrayBindingDivisor(scene->vertex_array, 3, 1);
+
+    // per instance transforms
+    glCreateBuffers(1, &scene->instance_buffer);
+    glNamedBufferStorage(scene->instance_buffer, sizeof(Mat4) * frame->num_instances, transforms, 0);
+    free(transforms);
+    free(base_vertices);
 
     // index buffer
+    // -- 16 bit indices if every mesh's vertices are reachable w/ them; half the index fetch
     glGenBuffers(1, &scene->index_buffer);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene->index_buffer);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER,
-        sizeof(uint32_t) * geo->num_indices, geo->indices,
-        GL_STATIC_DRAW);
-    scene->num_indices = geo->num_indices;
+    size_t index_size = short_indices ? sizeof(uint16_t) : sizeof(uint32_t);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_size * num_indices, NULL, GL_STATIC_DRAW);
+    for (int i = 0; i < desc->num_meshes; i++) {
+        Geometry *geo = &desc->meshes[i];
+        GLintptr offset = index_size * first_indices[i];
+        if (short_indices) {
+            uint16_t *indices = (desc->packed != NULL) ? desc->packed[i].indices : NULL;
+            if (indices == NULL) {
+                for (int j = 0; j < geo->num_indices; j++)
+                    narrowed[j] = (uint16_t)geo->indices[j];
+                indices = narrowed;
+            }
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, sizeof(uint16_t) * geo->num_indices, indices);
+        } else {
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, sizeof(uint32_t) * geo->num_indices, geo->indices);
+        }
+    }
+    free(narrowed);
+    free(first_indices);
+    return 0;
+}
+
+
+void free_scene_geo(Scene *scene) {
+    GLuint buffers[3] = {scene->vertex_buffer, scene->index_buffer, scene->instance_buffer};
+    glDeleteBuffers(3, buffers);
+    glDeleteVertexArrays(1, &scene->vertex_array);
+    scene->vertex_buffer = scene->index_buffer = scene->instance_buffer = 0;
+    scene->vertex_array = 0;
+    free(scene->draws);
+    scene->draws = NULL;
+    free_frame_plan(&scene->frame_plan);
+}
+
+
+GLsizeiptr scene_draws_size(Scene *scene) {
+    // worst case: every instance in every face
+    return sizeof(DrawElementsIndirectCommand) * scene->frame_plan.num_levels
+         + sizeof(uint32_t) * 6 * scene->frame_plan.num_instances;
 }
 
 
-int read_glsl(char* path, int glsl_length, const GLchar** glsl) {
-    FILE *file = fopen(path, "r");
-    if (file == NULL) {  // most likely file not found
-        fprintf(stderr, "failed to open shader file: %s\n", path);
-        return 0;
+char *scene_defines(VertexFormat format, const char *frame, size_t frame_length) {
+    const char *vertex = (format == VERTEX_PACKED) ? "#define PACKED_VERTEX 1\n" : "";
+    size_t vertex_length = strlen(vertex);
+    char *defines = malloc(vertex_length + frame_length + 2);
+    if (defines == NULL) {
+        fprintf(stderr, "out of memory for scene shader defines\n");
+        return NULL;
     }
+    memcpy(defines, vertex, vertex_length);
+    memcpy(defines + vertex_length, frame, frame_length);
+    // NOTE: frame.glsl might not end in a newline; #line must start its own
+    defines[vertex_length + frame_length] = '\n';
+    defines[vertex_length + frame_length + 1] = '\0';
+    return defines;
+}
 
-    if (fseek(file, 0, SEEK_END) != 0) {
-        fprintf(stderr, "seek failed: %s\n", path);
-        fclose(file);
-        return 0;
+
+int init_uniform_ring(UniformRing *ring, GLsizeiptr draws_size) {
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    // NOTE: indirect commands & vertex attribs want 4 byte alignment; 16 to be safe
+    ring->draws_offset = (sizeof(FrameUniforms) + 15) / 16 * 16;
+    ring->stride = (ring->draws_offset + draws_size + alignment - 1) / alignment * alignment;
+
+    // NOTE: persistent & coherent; writes land w/o glFlushMappedBufferRange
+    // -- the fences are all that keep the CPU off slots the GPU is reading
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &ring->buffer);
+    glNamedBufferStorage(ring->buffer, ring->stride * FRAME_LATENCY, NULL, flags);
+    ring->mapped = glMapNamedBufferRange(ring->buffer, 0, ring->stride * FRAME_LATENCY, flags);
+    if (ring->mapped == NULL) {
+        fprintf(stderr, "failed to map uniform buffer: 0x%04X\n", glGetError());
+        free_uniform_ring(ring);
+        return 1;
     }
-    long file_length = ftell(file);
-    if (file_length == 0) {
-        fprintf(stderr, "shader file is empty: %s", path);
-        fclose(file);
-        return 0;
-    } else if (file_length > glsl_length) {
-        fprintf(stderr, "shader file is too long: %s (%lu > %d)\n", path, file_length, glsl_length);
-        fclose(file);
-        return 0;
+    for (int i = 0; i < FRAME_LATENCY; i++)
+        ring->fences[i] = NULL;
+    ring->slot = 0;
+    ring->num_waits = 0;
+    return 0;
+}
+
+
+void free_uniform_ring(UniformRing *ring) {
+    for (int i = 0; i < FRAME_LATENCY; i++) {
+        glDeleteSync(ring->fences[i]);  // ignores NULL
+        ring->fences[i] = NULL;
     }
+    if (ring->mapped != NULL)
+        glUnmapNamedBuffer(ring->buffer);
+    glDeleteBuffers(1, &ring->buffer);
+    ring->buffer = 0;
+    ring->mapped = NULL;
+}
 
-    rewind(file);
-    int bytes_read = fread(glsl, 1, file_length, file);
-    fclose(file);
 
-    if (bytes_read != file_length) {
-        fprintf(stderr, "failed to read shader: %s\n", path);
-        return 0;
+FrameUniforms *begin_frame_uniforms(UniformRing *ring) {
+    GLsync fence = ring->fences[ring->slot];
+    if (fence != NULL) {
+        // NOTE: FRAME_LATENCY frames ago; almost always signalled already
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            ring->num_waits++;
+            // 1s; a longer stall than that is a lost GPU, not a slow one
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        }
+        if (status == GL_WAIT_FAILED || status == GL_TIMEOUT_EXPIRED)
+            fprintf(stderr, "uniform ring wait failed: 0x%04X\n", status);
+        glDeleteSync(fence);
+        ring->fences[ring->slot] = NULL;
     }
+    return (FrameUniforms*)(ring->mapped + ring->slot * ring->stride);
+}
+
 
-    return file_length;
+void bind_frame_uniforms(UniformRing *ring) {
+    glBindBufferRange(GL_UNIFORM_BUFFER, 0, ring->buffer, ring->slot * ring->stride, sizeof(FrameUniforms));
 }
 
 
-int compile_glsl(GLuint *shader, GLenum shader_type, int glsl_length, const GLchar* glsl) {
-    *shader = glCreateShader(shader_type);
-    glShaderSource(*shader, 1, &glsl, &glsl_length);
-    glCompileShader(*shader);
+void end_frame_uniforms(UniformRing *ring) {
+    ring->fences[ring->slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ring->slot = (ring->slot + 1) % FRAME_LATENCY;
+}
 
-    GLint compiled;
-    glGetShaderiv(*shader, GL_COMPILE_STATUS, &compiled);
-    if (compiled == GL_FALSE) {
-        fprintf(stderr, "shader failed to compile: %d\n", shader_type);
 
-        GLint log_length;
-        glGetShaderiv(*shader, GL_INFO_LOG_LENGTH, &log_length);
-        GLchar log[4096];
-        // NOTE: not checking if log_length > sizeof(log)
-        glGetShaderInfoLog(*shader, sizeof(log), &log_length, log);
-        fprintf(stderr, "%s\n", log);
+CubeMode pick_cube_mode() {
+    if (GLEW_ARB_shader_viewport_layer_array || GLEW_AMD_vertex_shader_layer)
+        return CUBE_VERTEX_LAYER;
+    return CUBE_GEOMETRY_SHADER;
+}
+
 
+int init_cube_target(CubeTarget *cube, int size) {
+    cube->size = size;
+
+    // NOTE: no mips; the cube is re-rendered every frame
+    glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &cube->colour);
+    glTextureStorage2D(cube->colour, 1, GL_RGBA8, size, size);
+    glTextureParameteri(cube->colour, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(cube->colour, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(cube->colour, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(cube->colour, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &cube->depth);
+    glTextureStorage2D(cube->depth, 1, GL_DEPTH_COMPONENT24, size, size);
+
+    // NOTE: attaching the whole cube (no layer) makes the framebuffer layered
+    // -- gl_Layer picks the face
+    glCreateFramebuffers(1, &cube->framebuffer);
+    glNamedFramebufferTexture(cube->framebuffer, GL_COLOR_ATTACHMENT0, cube->colour, 0);
+    glNamedFramebufferTexture(cube->framebuffer, GL_DEPTH_ATTACHMENT, cube->depth, 0);
+    GLenum status = glCheckNamedFramebufferStatus(cube->framebuffer, GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "cube framebuffer is incomplete: 0x%04X\n", status);
+        free_cube_target(cube);
         return 1;
     }
-
     return 0;
 }
 
 
-int link_shader(GLuint vertex_shader, GLuint fragment_shader, GLuint *program) {
-    *program = glCreateProgram();
-    glAttachShader(*program, vertex_shader);
-    glAttachShader(*program, fragment_shader);
-    glLinkProgram(*program);
-    GLint is_linked;
-    glGetProgramiv(*program, GL_LINK_STATUS, &is_linked);
-    if (is_linked != GL_TRUE) {
-        fprintf(stderr, "shader program failed to link\n");
-        GLint log_length;
-        glGetProgramiv(*program, GL_INFO_LOG_LENGTH, &log_length);
-        GLchar log[4096];
-        // NOTE: not checking if log_length > sizeof(log)
-        glGetProgramInfoLog(*program, sizeof(log), &log_length, log);
-        fprintf(stderr, "%s\n", log);
+void free_cube_target(CubeTarget *cube) {
+    glDeleteFramebuffers(1, &cube->framebuffer);
+    glDeleteTextures(1, &cube->colour);
+    glDeleteTextures(1, &cube->depth);
+    cube->framebuffer = 0;
+    cube->colour = 0;
+    cube->depth = 0;
+    cube->size = 0;
+}
+
+
+int init_offscreen_target(OffscreenTarget *target, int width, int height) {
+    target->width = width;
+    target->height = height;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &target->colour);
+    glTextureStorage2D(target->colour, 1, GL_RGBA8, width, height);
+    glCreateRenderbuffers(1, &target->depth);
+    glNamedRenderbufferStorage(target->depth, GL_DEPTH_COMPONENT24, width, height);
+
+    glCreateFramebuffers(1, &target->framebuffer);
+    glNamedFramebufferTexture(target->framebuffer, GL_COLOR_ATTACHMENT0, target->colour, 0);
+    glNamedFramebufferRenderbuffer(target->framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target->depth);
+    GLenum status = glCheckNamedFramebufferStatus(target->framebuffer, GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "offscreen framebuffer is incomplete: 0x%04X\n", status);
+        free_offscreen_target(target);
         return 1;
     }
+    return 0;
+}
+
 
-    glDetachShader(*program, vertex_shader);
-    glDeleteShader(vertex_shader);
-    glDetachShader(*program, fragment_shader);
-    glDeleteShader(fragment_shader);
-
-    glValidateProgram(*program);
-    GLint is_valid;
-    glGetProgramiv(*program, GL_VALIDATE_STATUS, &is_valid);
-    if (is_valid != GL_TRUE) {
-        fprintf(stderr, "invalid shader program\n");
-        GLint log_length;
-        glGetProgramiv(*program, GL_INFO_LOG_LENGTH, &log_length);
-        GLchar log[4096];
-        // NOTE: not checking if log_length > sizeof(log)
-        glGetProgramInfoLog(*program, sizeof(log), &log_length, log);
-        fprintf(stderr, "%s\n", log);
+void free_offscreen_target(OffscreenTarget *target) {
+    glDeleteFramebuffers(1, &target->framebuffer);
+    glDeleteTextures(1, &target->colour);
+    glDeleteRenderbuffers(1, &target->depth);
+    target->framebuffer = 0;
+    target->colour = 0;
+    target->depth = 0;
+}
+
+
+int read_offscreen_target(OffscreenTarget *target, Image *image) {
+    if (init_image(image, target->width, target->height) != 0)
         return 1;
+    glGetTextureImage(target->colour, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+        sizeof(uint32_t) * target->width * target->height, image->pixels);
+
+    // GL rows are bottom to top
+    for (int y = 0; y < image->height / 2; y++) {
+        uint32_t *top = image->pixels + (size_t)y * image->width;
+        uint32_t *bottom = image->pixels + (size_t)(image->height - 1 - y) * image->width;
+        for (int x = 0; x < image->width; x++) {
+            uint32_t swap = top[x];
+            top[x] = bottom[x];
+            bottom[x] = swap;
+        }
     }
-
     return 0;
 }
 
 
-int cache_shader(GLuint *program, char* path) {
-    GLsizei bin_size = 0;
-    GLenum  bin_type = 0;
-    uint8_t bin[8092];
-    // NOTE: even the most basic shader is larger than 4KB
+int update_cube_plan(CubePlan *plan, CubeTarget *cube, int width, int height, PaniniParams *params) {
+    if (cube_plan_current(plan, width, height, params))
+        return (cube == NULL || cube->size == plan->size) ? 0 : 1;  // 1 if the last resize failed
 
-    glGetProgramiv(*program, GL_PROGRAM_BINARY_LENGTH, &bin_size);
-    if (bin_size > sizeof(bin)) {
-        fprintf(stderr, "compiled shader is too large: %d > %lu\n", bin_size, sizeof(bin));
-        return 1;
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_CUBE_MAP_TEXTURE_SIZE, &max_size);
+    plan_cube(plan, max_size, width, height, params);
+
+    // NOTE: a failed resize is remembered; no retrying every frame
+    if (cube != NULL && cube->size != plan->size) {
+        free_cube_target(cube);
+        if (init_cube_target(cube, plan->size) != 0)
+            return 1;  // init_cube_target prints its own errors
     }
+    return 0;
+}
+
+
+int update_panini_lut(PaniniLut *lut, int width, int height, PaniniParams *params, LutBuilder builder, GLuint lut_shader) {
+    bool same_size = lut->texture != 0 && lut->width == width && lut->height == height;
+    if (same_size && same_panini_params(&lut->params, params))
+        return 0;  // up to date
 
-    glGetProgramBinary(*program, sizeof(bin), &bin_size, &bin_type, &bin);
+    if (!same_size) {
+        // NOTE: immutable storage; a new size needs a new texture
+        glDeleteTextures(1, &lut->texture);
+        glCreateTextures(GL_TEXTURE_2D, 1, &lut->texture);
+        glTextureStorage2D(lut->texture, 1, GL_RGBA16F, width, height);
+        // 1 texel per pixel, always fetched w/ texelFetch
+        glTextureParameteri(lut->texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(lut->texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
 
-    FILE *bin_file = fopen(path, "wb");
-    fwrite(bin, sizeof(GLenum), bin_type, bin_file);
-    fwrite(bin, sizeof(GLsizei), bin_size, bin_file);
-    fwrite(bin, 1, bin_size, bin_file);
-    fclose(bin_file);
+    if (builder == LUT_GPU) {
+        float half_width = panini_half_width(params);
+        float half_height = half_width * height / width;
+        glUseProgram(lut_shader);
+        glUniform4f(0, params->d, params->compression, half_width, half_height);
+        glBindImageTexture(0, lut->texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);  // local size is 8x8
+        // NOTE: a current program overrides the bound pipeline; the draws use pipelines
+        glUseProgram(0);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    } else {
+        float *table = malloc(sizeof(float) * 4 * (size_t)width * height);
+        if (table == NULL) {
+            fprintf(stderr, "out of memory for %dx%d panini LUT\n", width, height);
+            free_panini_lut(lut);
+            return 1;
+        }
+        panini_direction_table(params, width, height, table);
+        // NOTE: GL converts to half floats on upload
+        glTextureSubImage2D(lut->texture, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, table);
+        free(table);
+    }
 
+    lut->width = width;
+    lut->height = height;
+    lut->params = *params;
     return 0;
 }
 
 
-void draw_scene(SDL_Window **window, Scene *scene) {
+void free_panini_lut(PaniniLut *lut) {
+    glDeleteTextures(1, &lut->texture);
+    lut->texture = 0;
+    lut->width = 0;
+    lut->height = 0;
+}
+
+
+static void write_frame_uniforms(Scene *scene, FrameViews *views, FrameUniforms *frame) {
+    frame->view = views->view;
+    frame->projection = views->projection;
+    for (int i = 0; i < 6; i++)
+        frame->face_view_projection[i] = views->face_view_projection[i];
+
+    float half_width = panini_half_width(&scene->panini);
+    frame->panini[0] = scene->panini.d;
+    frame->panini[1] = scene->panini.compression;
+    frame->panini[2] = half_width;
+    frame->panini[3] = half_width * scene->height / scene->width;
+
+    VertexBounds *bounds = &scene->vertex_bounds;
+    frame->position_offset[0] = bounds->offset.x;
+    frame->position_offset[1] = bounds->offset.y;
+    frame->position_offset[2] = bounds->offset.z;
+    frame->position_scale[0] = bounds->scale.x;
+    frame->position_scale[1] = bounds->scale.y;
+    frame->position_scale[2] = bounds->scale.z;
+
+    CubePlan *plan = &scene->cube_plan;
+    for (int i = 0; i < 6; i++)
+        frame->faces[i] = (i < plan->num_faces) ? plan->faces[i] : 0;
+    frame->num_faces = plan->num_faces;
+
+    // NOTE: angle per pixel is roughly constant across a panini view
+    float radians_per_pixel = scene->panini.fov * (3.14159265f / 180.0f) / scene->width;
+    frame->tess_angle = radians_per_pixel * scene->tess_pixels;
+}
+
+
+// 1 indirect command per LOD w/ anything visible into this frame's slot
+// (after FrameUniforms), then the entries they draw (attrib 3)
+// -- cull_frame has already counted each LOD's entries
+// NOTE: written straight to the mapping, which is write only; never read back
+static void write_frame_draws(Scene *scene, bool per_face) {
+    FramePlan *frame = &scene->frame_plan;
+    UniformRing *ring = &scene->uniforms;
+    GLintptr slot = ring->slot * ring->stride;
+    DrawElementsIndirectCommand *commands = (DrawElementsIndirectCommand*)(ring->mapped + slot + ring->draws_offset);
+    GLintptr entries_offset = slot + ring->draws_offset + sizeof(DrawElementsIndirectCommand) * frame->num_levels;
+    int num_draws = 0;
+    int first = 0;
+    for (int i = 0; i < frame->num_levels; i++) {
+        int count = frame->level_entries[i];
+        if (count == 0)
+            continue;
+        DrawElementsIndirectCommand draw = scene->draws[i];
+        draw.instance_count = count;
+        draw.base_instance = first;
+        commands[num_draws++] = draw;
+        first += count;
+    }
+    write_frame_entries(frame, per_face, (uint32_t*)(ring->mapped + entries_offset));
+
+    scene->draws_offset = slot + ring->draws_offset;
+    glVertexArrayVertexBuffer(scene->vertex_array, 3, ring->buffer, entries_offset, sizeof(uint32_t));
+}
+
+
+void draw_scene(Scene *scene) {
+    // NOTE: free unless the resolution or params changed since last frame
+    // -- the direct path only plans, for culling; it never samples a cube
+    CubePlan *plan = &scene->cube_plan;
+    if (scene->path == RENDER_CUBE) {
+        if (update_cube_plan(plan, &scene->cube, scene->width, scene->height, &scene->panini) != 0)
+            return;
+    } else {
+        plan = &scene->direct_plan;
+        update_cube_plan(plan, NULL, scene->width, scene->height, &scene->panini);
+    }
+
+    // NOTE: the only uniform upload this frame; coherent, so no flush
+    // -- built on the stack; the mapping is write only & may be uncached
+    FrameViews views;
+    frame_views(&scene->camera, &views);
+    FrameUniforms frame = {0};
+    write_frame_uniforms(scene, &views, &frame);
+    *begin_frame_uniforms(&scene->uniforms) = frame;
+    // culling & LOD picks, then this frame's draws
+    // -- CUBE_VERTEX_LAYER picks each entry's face from it; 1 entry per visible (instance, face)
+    bool per_face = scene->path == RENDER_CUBE && scene->cube_mode == CUBE_VERTEX_LAYER;
+    cull_frame(&scene->frame_plan, &views, plan, &scene->panini, scene->width, per_face);
+    write_frame_draws(scene, per_face);
+    bind_frame_uniforms(&scene->uniforms);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, scene->instance_buffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, scene->uniforms.buffer);
+    if (scene->path == RENDER_DIRECT) {
+        draw_direct_path(scene);
+    } else {
+        draw_cube_path(scene);
+    }
+    end_frame_uniforms(&scene->uniforms);
+}
+
+
+void draw_placeholder(GLuint framebuffer, int width, int height) {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+    glDisable(GL_SCISSOR_TEST);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
 
-    glUseProgram(scene->shader);
-    // TODO: update shader uniforms (view matrix)
-    glDrawElements(GL_TRIANGLES, scene->num_indices, GL_UNSIGNED_INT, NULL);
 
-    // TODO: panini reprojection
-    // -- 6x camera matrices (or some clever shader trick)
-    // -- render each view to a renderbuffer
-    // -- renderbuffer -> cube texture
-    // -- panini reprojection "scene"
+void draw_cube_path(Scene *scene) {
+    // cube pass
+    // -- every used face in 1 draw; the GPU fans triangles out to the faces they touch
+    // NOTE: the plan is updated by draw_scene, w/ the faces in FrameUniforms
+    CubePlan *plan = &scene->cube_plan;
+    gpu_begin_pass(scene->profiler, GPU_PASS_CUBE);
+    glBindFramebuffer(GL_FRAMEBUFFER, scene->cube.framebuffer);
+    glViewport(0, 0, scene->cube.size, scene->cube.size);  // every viewport index
+    glEnable(GL_DEPTH_TEST);
+
+    // only clear what the reprojection samples; glClear would do all 6 faces
+    GLfloat clear_colour[4];
+    GLfloat clear_depth;
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_colour);
+    glGetFloatv(GL_DEPTH_CLEAR_VALUE, &clear_depth);
+    for (int i = 0; i < plan->num_faces; i++) {
+        GLint *scissor = plan->scissors[plan->faces[i]];
+        // NOTE: zoffset is the face for cube maps
+        glClearTexSubImage(scene->cube.colour, 0, scissor[0], scissor[1], plan->faces[i],
+            scissor[2], scissor[3], 1, GL_RGBA, GL_FLOAT, clear_colour);
+        glClearTexSubImage(scene->cube.depth, 0, scissor[0], scissor[1], plan->faces[i],
+            scissor[2], scissor[3], 1, GL_DEPTH_COMPONENT, GL_FLOAT, &clear_depth);
+    }
+
+    // 1 scissor per face; the cube shaders write gl_ViewportIndex = face
+    glEnable(GL_SCISSOR_TEST);
+    glScissorArrayv(0, 6, &plan->scissors[0][0]);
+    if (scene->cube_mode == CUBE_VERTEX_LAYER && !GLEW_ARB_shader_viewport_layer_array)
+        glScissorIndexedv(0, plan->bounds);  // no gl_ViewportIndex; every face uses index 0
+
+    // every visible mesh & instance in 1 draw
+    // -- CUBE_VERTEX_LAYER: 1 instance per visible (instance, face)
+    // -- CUBE_GEOMETRY_SHADER: invocations past num_faces or outside the instance's faces return early
+    glBindProgramPipeline(scene->cube_shader);
+    glBindVertexArray(scene->vertex_array);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, scene->index_type, (void*)scene->draws_offset, scene->frame_plan.num_draws, 0);
+    glDisable(GL_SCISSOR_TEST);
+    gpu_end_pass(scene->profiler, GPU_PASS_CUBE);
+
+    // reprojection pass
+    // NOTE: bilinear within each face, like panini_remap; no GL_TEXTURE_CUBE_MAP_SEAMLESS
+    // NOTE: includes any LUT rebake
+    gpu_begin_pass(scene->profiler, GPU_PASS_REPROJECT);
+    glBindFramebuffer(GL_FRAMEBUFFER, scene->output_framebuffer);
+    glViewport(0, 0, scene->width, scene->height);
+    glDisable(GL_DEPTH_TEST);
+
+    // NOTE: free unless the resolution or params changed since last frame
+    update_panini_lut(&scene->lut, scene->width, scene->height, &scene->panini, scene->lut_builder, scene->lut_shader);
+    glBindProgramPipeline(scene->panini_shader);
+    glBindTextureUnit(0, scene->cube.colour);
+    glBindTextureUnit(1, scene->lut.texture);
+    glBindVertexArray(scene->fullscreen_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    gpu_end_pass(scene->profiler, GPU_PASS_REPROJECT);
+}
 
-    SDL_GL_SwapWindow(*window);
+
+void draw_direct_path(Scene *scene) {
+    // no cube & no reprojection; the tessellation stages project every vertex
+    gpu_begin_pass(scene->profiler, GPU_PASS_DIRECT);
+    glBindFramebuffer(GL_FRAMEBUFFER, scene->output_framebuffer);
+    glViewport(0, 0, scene->width, scene->height);
+    glEnable(GL_DEPTH_TEST);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // NOTE: panini params & tess_angle come from FrameUniforms
+    glBindProgramPipeline(scene->direct_shader);
+    glBindVertexArray(scene->vertex_array);
+    glPatchParameteri(GL_PATCH_VERTICES, 3);
+    glMultiDrawElementsIndirect(GL_PATCHES, scene->index_type, (void*)scene->draws_offset, scene->frame_plan.num_draws, 0);
+    gpu_end_pass(scene->profiler, GPU_PASS_DIRECT);
 }
@@ -10,32 +10,220 @@
 // SDL2 (`sdl2-config --cflags --libs`)
 #include <SDL2/SDL.h>
 
+#include "bvh.h"
+#include "camera.h"
+#include "cull.h"
+#include "frame_plan.h"
 #include "geometry.h"
+#include "gpu_profile.h"
+#include "matrix.h"
+#include "packed_vertex.h"
+#include "panini.h"
+#include "shader_manager.h"
+
+
+// how the cube pass sends each triangle to its cube faces
+typedef enum CubeMode_e {
+    CUBE_VERTEX_LAYER,  // 6 instances, gl_Layer from the vertex shader
+    CUBE_GEOMETRY_SHADER,  // 6 geometry shader invocations; fallback
+} CubeMode;
+
+
+// how the panini view is rendered; switchable at runtime
+typedef enum RenderPath_e {
+    RENDER_CUBE,  // cube pass, then reprojection; any fov
+    RENDER_DIRECT,  // panini in the tessellation stage; 1 pass, moderate fovs
+} RenderPath;
+
+
+// layered cube map render target; all 6 faces in 1 framebuffer
+typedef struct CubeTarget_s {
+    int     size;  // of each face, in pixels
+    GLuint  framebuffer;
+    GLuint  colour;  // GL_TEXTURE_CUBE_MAP, GL_RGBA8
+    GLuint  depth;   // GL_TEXTURE_CUBE_MAP, GL_DEPTH_COMPONENT24
+} CubeTarget;
+
+
+// colour & depth to render into w/o a window
+typedef struct OffscreenTarget_s {
+    int     width;
+    int     height;
+    GLuint  framebuffer;
+    GLuint  colour;  // GL_TEXTURE_2D, GL_RGBA8
+    GLuint  depth;   // renderbuffer, GL_DEPTH_COMPONENT24
+} OffscreenTarget;
+
+
+// where the reprojection LUT is baked
+typedef enum LutBuilder_e {
+    LUT_GPU,  // compute shader, straight into the texture
+    LUT_CPU,  // panini_direction_table & an upload; fallback
+} LutBuilder;
+
+
+// per pixel cube map direction for the reprojection pass
+// -- only rebuilt when the resolution or PaniniParams change
+typedef struct PaniniLut_s {
+    // what texture was baked for; texture == 0 if it never was
+    int           width;
+    int           height;
+    PaniniParams  params;
+    GLuint        texture;  // GL_TEXTURE_2D, GL_RGBA16F; xyz = direction
+} PaniniLut;
+
+
+// per frame shader inputs; uniform block binding 0 in every scene shader
+// NOTE: std140; keep in sync w/ the Frame block in shaders/frame.glsl
+typedef struct FrameUniforms_s {
+    Mat4    view;        // world -> camera, from Scene.camera
+    Mat4    projection;  // 90deg fov on both axes, for cube faces
+    Mat4    face_view_projection[6];  // world -> clip, per CubeFace
+    float   panini[4];   // d, compression, half width & half height
+    GLint   faces[8];    // CubeFace of each used face; the first num_faces
+    GLint   num_faces;
+    float   tess_angle;  // max angle across a subdivided edge, in radians
+    float   padding[2];
+    // PACKED_VERTEX position decode; Scene.vertex_bounds
+    float   position_offset[4];
+    float   position_scale[4];
+} FrameUniforms;
+
+
+// frames the CPU can get ahead of the GPU before begin_frame_uniforms waits
+#define FRAME_LATENCY  3
+
+
+// FRAME_LATENCY copies of FrameUniforms in 1 persistently mapped buffer
+// -- each frame writes the next slot, so the GPU never reads one mid-write
+// -- a fence per slot says when the GPU is done w/ it
+// -- each slot also holds that frame's culled draws: indirect commands, then
+//    visible instances (attrib 3)
+typedef struct UniformRing_s {
+    GLuint      buffer;
+    char       *mapped;  // write only, coherent; no flushes
+    GLsizeiptr  stride;  // between slots; GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    GLsizeiptr  draws_offset;  // within a slot; after FrameUniforms
+    GLsync      fences[FRAME_LATENCY];
+    int         slot;  // being written this frame
+    uint64_t    num_waits;  // frames that had to wait for the GPU
+} UniformRing;
+
+
+// glMultiDrawElementsIndirect's command layout
+typedef struct DrawElementsIndirectCommand_s {
+    GLuint  count;  // indices
+    GLuint  instance_count;
+    GLuint  first_index;
+    GLint   base_vertex;
+    GLuint  base_instance;
+} DrawElementsIndirectCommand;
 
 
 // bucket of opengl state for rendering
 typedef struct Scene_s {
     // data references
-    int     num_indices;
-    // NOTE: assuming GL_TRIANGLE & GL_UNSIGNED_INT for draw calls
+    // -- every mesh shares 1 vertex & 1 index buffer; 1 indirect command per LOD of each mesh
+    // -- each pass is 1 glMultiDrawElementsIndirect, however many meshes & instances
+    int     num_indices;  // every LOD of every mesh, once
+    // NOTE: assuming GL_TRIANGLES for draw calls
+    GLenum  index_type;  // GL_UNSIGNED_SHORT if every mesh's indices fit, else GL_UNSIGNED_INT
+    VertexFormat  vertex_format;  // set before populate & building shaders
+    VertexBounds  vertex_bounds;  // VERTEX_PACKED only; every mesh
+    DrawElementsIndirectCommand  *draws;  // frame_plan.num_levels; every instance, for reference
     // OpenGL object references
     GLuint  vertex_array;
     GLuint  vertex_buffer;
     GLuint  index_buffer;
-    GLuint  shader;
+    GLuint  instance_buffer;  // SSBO binding 1; Mat4 per instance, grouped by mesh
+    // instances, LODs & culling; shared w/ render_vulkan.c
+    // -- what's visible becomes this frame's indirect commands, in the uniform ring
+    FramePlan  frame_plan;
+    GLintptr   draws_offset; // this frame's indirect commands, in uniforms.buffer
+    CubePlan   direct_plan;  // faces the direct path sees; never sized a cube
+    RenderPath  path;
+    // per frame uniforms; the only ones the draw calls read
+    Camera       camera;
+    UniformRing  uniforms;
+    // cube pass; scene -> cube map in 1 draw
+    CubeMode    cube_mode;
+    CubeTarget  cube;
+    CubePlan    cube_plan;
+    GLuint      cube_shader;  // program pipeline
+    // reprojection pass; cube map -> panini view
+    PaniniParams  panini;
+    GLuint        panini_shader;  // program pipeline
+    GLuint        fullscreen_array;  // empty VAO, the triangle comes from gl_VertexID
+    PaniniLut     lut;
+    LutBuilder    lut_builder;
+    GLuint        lut_shader;  // compute program, not a pipeline; LUT_GPU only
+    // direct path; scene -> panini view, subdivided by angle
+    GLuint  direct_shader;  // program pipeline
+    float   tess_pixels;  // max length of a subdivided edge, roughly in pixels
+    // every pass's stages; the fields above are its pipelines & programs
+    ShaderManager  shaders;
+    // output
+    GpuProfiler  *profiler;  // NULL to skip timing
+    GLuint  output_framebuffer;  // 0 for the window
+    int     width;
+    int     height;
 } Scene;
 
 
 // scene geo
-void populate(Scene *scene, Geometry *geo);
+// -- scene->vertex_format picks the vertex layout; indices shrink to 16 bits if they fit
+// -- instances are drawn grouped by mesh; desc can be freed after
+// -- builds a BVH over the instances for culling
+int populate(Scene *scene, SceneDesc *desc);
+void free_scene_geo(Scene *scene);
+// per frame bytes of culled draws, at most; for init_uniform_ring
+GLsizeiptr scene_draws_size(Scene *scene);
+// prefix for every scene shader: a #define to decode scene->vertex_format,
+// then shaders/frame.glsl (the Frame block & vertex decode)
+// -- malloc'd; NULL on failure
+char *scene_defines(VertexFormat format, const char *frame, size_t frame_length);
+
+// per frame uniforms
+// NOTE: needs a current context; GL 4.4 or ARB_buffer_storage
+// -- draws_size is the culled draws' share of each slot; see scene_draws_size
+int init_uniform_ring(UniformRing *ring, GLsizeiptr draws_size);
+void free_uniform_ring(UniformRing *ring);
+// the next slot to fill; waits if the GPU still reads it
+FrameUniforms *begin_frame_uniforms(UniformRing *ring);
+// binds the slot to uniform block binding 0
+void bind_frame_uniforms(UniformRing *ring);
+// fences the slot; call after the last draw that reads it
+void end_frame_uniforms(UniformRing *ring);
+
+// cube pass
+// NOTE: needs a current context to query extensions
+CubeMode pick_cube_mode();
+int init_cube_target(CubeTarget *cube, int size);
+void free_cube_target(CubeTarget *cube);
+// offscreen output; Scene.output_framebuffer = target->framebuffer
+int init_offscreen_target(OffscreenTarget *target, int width, int height);
+void free_offscreen_target(OffscreenTarget *target);
+// colour -> image, flipped to rows top to bottom; image must be unallocated
+int read_offscreen_target(OffscreenTarget *target, Image *image);
+
+// replans if width, height or params changed; resizes cube to match
+// -- cube may be NULL to only plan (for culling)
+int update_cube_plan(CubePlan *plan, CubeTarget *cube, int width, int height, PaniniParams *params);
 
-// shader construction
-int read_glsl(char* path, int glsl_length, const GLchar** glsl);
-int compile_glsl(GLuint *shader, GLenum shader_type, int glsl_length, const GLchar* glsl);
-int link_shader(GLuint vertex_shader, GLuint fragment_shader, GLuint *program);
-int cache_shader(GLuint *program, char* path);
-// int load_shader(GLuint *program, char* path);
-// -- glProgramBinary(*program, *bin_format, bin, sizeof(bin));
+// reprojection LUT
+// -- rebakes if width, height or params differ from what lut was baked for
+// -- lut_shader is only used by LUT_GPU
+int update_panini_lut(PaniniLut *lut, int width, int height, PaniniParams *params, LutBuilder builder, GLuint lut_shader);
+void free_panini_lut(PaniniLut *lut);
 
 // draw
-void draw_scene(SDL_Window **window, Scene *scene);
+// -- scene->path to output_framebuffer
+// -- fills & binds this frame's FrameUniforms from the camera, panini & cube plan
+// NOTE: doesn't swap; that's up to the window owner
+void draw_scene(Scene *scene);
+// clear colour only; stands in for draw_scene while assets are still loading
+void draw_placeholder(GLuint framebuffer, int width, int height);
+// NOTE: both paths use the same PaniniParams, & should match closely
+// NOTE: both read the FrameUniforms draw_scene binds; the cube path its cube plan too
+void draw_cube_path(Scene *scene);
+void draw_direct_path(Scene *scene);
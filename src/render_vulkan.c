@@ -0,0 +1,1484 @@
+// Using C23 Standard
+// Math (-lm)
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "file_io.h"
+#include "render_vulkan.h"
+
+
+// the cube is always RGBA8; the output too, so read_output is a straight copy
+#define CUBE_FORMAT    VK_FORMAT_R8G8B8A8_UNORM
+#define OUTPUT_FORMAT  VK_FORMAT_R8G8B8A8_UNORM
+
+// same as init_OpenGL's glClearColor
+#define CLEAR_COLOUR  {{0.1f, 0.4f, 0.5f, 1.0f}}
+
+
+static bool vk_failed(VkResult result, const char *what) {
+    if (result == VK_SUCCESS)
+        return false;
+    fprintf(stderr, "%s failed: %d\n", what, result);
+    return true;
+}
+
+
+int init_vulkan(VulkanContext *vk, uint32_t num_extensions, const char* const* extensions) {
+    // NOTE: VK_INSTANCE_LAYERS=VK_LAYER_KHRONOS_validation turns on validation w/o a rebuild
+    VkApplicationInfo app = {
+        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+        .pApplicationName = "panini",
+        .apiVersion = VK_API_VERSION_1_2};
+    VkInstanceCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .pApplicationInfo = &app,
+        .enabledExtensionCount = num_extensions,
+        .ppEnabledExtensionNames = extensions};
+    if (vk_failed(vkCreateInstance(&info, NULL, &vk->instance), "vkCreateInstance"))
+        return 1;
+    return 0;
+}
+
+
+// first required feature device is missing; NULL if it has them all
+static const char *missing_feature(VkPhysicalDevice device) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2)
+        return "Vulkan 1.2";
+    VkPhysicalDeviceVulkan12Features features_12 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    VkPhysicalDeviceFeatures2 features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &features_12};
+    vkGetPhysicalDeviceFeatures2(device, &features);
+    if (!features.features.multiDrawIndirect)
+        return "multiDrawIndirect";
+    if (!features.features.multiViewport)
+        return "multiViewport";
+    if (!features.features.shaderCullDistance)
+        return "shaderCullDistance";
+    if (!features_12.shaderOutputLayer)
+        return "shaderOutputLayer";
+    if (!features_12.shaderOutputViewportIndex)
+        return "shaderOutputViewportIndex";
+    return NULL;
+}
+
+
+static bool has_swapchain_extension(VkPhysicalDevice device) {
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(device, NULL, &count, NULL);
+    VkExtensionProperties *extensions = malloc(sizeof(VkExtensionProperties) * count);
+    if (extensions == NULL)
+        return false;
+    vkEnumerateDeviceExtensionProperties(device, NULL, &count, extensions);
+    bool found = false;
+    for (uint32_t i = 0; i < count && !found; i++)
+        found = strcmp(extensions[i].extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0;
+    free(extensions);
+    return found;
+}
+
+
+// 1 family for everything; no queue ownership transfers
+static bool find_queue_family(VkPhysicalDevice device, VkSurfaceKHR surface, uint32_t *family) {
+    uint32_t count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &count, NULL);
+    VkQueueFamilyProperties *families = malloc(sizeof(VkQueueFamilyProperties) * count);
+    if (families == NULL)
+        return false;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &count, families);
+    VkQueueFlags wanted = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+    bool found = false;
+    for (uint32_t i = 0; i < count && !found; i++) {
+        if ((families[i].queueFlags & wanted) != wanted)
+            continue;
+        VkBool32 present = VK_TRUE;
+        if (surface != VK_NULL_HANDLE)
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present);
+        if (present) {
+            *family = i;
+            found = true;
+        }
+    }
+    free(families);
+    return found;
+}
+
+
+int init_vulkan_device(VulkanContext *vk, VkSurfaceKHR surface) {
+    uint32_t count = 0;
+    vkEnumeratePhysicalDevices(vk->instance, &count, NULL);
+    if (count == 0) {
+        fprintf(stderr, "no Vulkan devices; is an ICD installed? (e.g. Mesa's lavapipe)\n");
+        return 1;
+    }
+    VkPhysicalDevice *devices = malloc(sizeof(VkPhysicalDevice) * count);
+    if (devices == NULL) {
+        fprintf(stderr, "out of memory for %u Vulkan devices\n", count);
+        return 1;
+    }
+    vkEnumeratePhysicalDevices(vk->instance, &count, devices);
+
+    // NOTE: first come, first served; VK_ICD_FILENAMES or MESA_VK_DEVICE_SELECT pick another
+    vk->physical_device = VK_NULL_HANDLE;
+    for (uint32_t i = 0; i < count && vk->physical_device == VK_NULL_HANDLE; i++) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(devices[i], &properties);
+        const char *missing = missing_feature(devices[i]);
+        if (missing == NULL && surface != VK_NULL_HANDLE && !has_swapchain_extension(devices[i]))
+            missing = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+        if (missing == NULL && !find_queue_family(devices[i], surface, &vk->queue_family))
+            missing = (surface != VK_NULL_HANDLE) ? "a graphics, compute & present queue" : "a graphics & compute queue";
+        if (missing != NULL) {
+            fprintf(stderr, "skipping %s: no %s\n", properties.deviceName, missing);
+            continue;
+        }
+        vk->physical_device = devices[i];
+        vk->properties = properties;
+    }
+    free(devices);
+    if (vk->physical_device == VK_NULL_HANDLE) {
+        fprintf(stderr, "no usable Vulkan device\n");
+        return 1;
+    }
+    vkGetPhysicalDeviceMemoryProperties(vk->physical_device, &vk->memory);
+
+    // D16 is always there, but D32 & X8_D24 match GL_DEPTH_COMPONENT24 better
+    VkFormat depth_formats[3] = {VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D16_UNORM};
+    for (int i = 0; i < 3; i++) {
+        VkFormatProperties format;
+        vkGetPhysicalDeviceFormatProperties(vk->physical_device, depth_formats[i], &format);
+        if (format.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+            vk->depth_format = depth_formats[i];
+            break;
+        }
+    }
+
+    float priority = 1.0f;
+    VkDeviceQueueCreateInfo queue = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .queueFamilyIndex = vk->queue_family,
+        .queueCount = 1,
+        .pQueuePriorities = &priority};
+    VkPhysicalDeviceVulkan12Features features_12 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .shaderOutputLayer = VK_TRUE,
+        .shaderOutputViewportIndex = VK_TRUE};
+    VkPhysicalDeviceFeatures2 features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &features_12,
+        .features = {
+            .multiDrawIndirect = VK_TRUE,
+            .multiViewport = VK_TRUE,
+            .shaderCullDistance = VK_TRUE}};
+    const char *swapchain_extension = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    VkDeviceCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &features,
+        .queueCreateInfoCount = 1,
+        .pQueueCreateInfos = &queue,
+        .enabledExtensionCount = (surface != VK_NULL_HANDLE) ? 1 : 0,
+        .ppEnabledExtensionNames = &swapchain_extension};
+    if (vk_failed(vkCreateDevice(vk->physical_device, &info, NULL, &vk->device), "vkCreateDevice"))
+        return 1;
+    vkGetDeviceQueue(vk->device, vk->queue_family, 0, &vk->queue);
+
+    VkCommandPoolCreateInfo pool = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = vk->queue_family};
+    if (vk_failed(vkCreateCommandPool(vk->device, &pool, NULL, &vk->pool), "vkCreateCommandPool"))
+        return 1;
+    return 0;
+}
+
+
+void free_vulkan(VulkanContext *vk) {
+    if (vk->device != VK_NULL_HANDLE) {
+        vkDeviceWaitIdle(vk->device);
+        vkDestroyCommandPool(vk->device, vk->pool, NULL);
+        vkDestroyDevice(vk->device, NULL);
+    }
+    vkDestroyInstance(vk->instance, NULL);  // ignores VK_NULL_HANDLE
+    vk->pool = VK_NULL_HANDLE;
+    vk->device = VK_NULL_HANDLE;
+    vk->instance = VK_NULL_HANDLE;
+}
+
+
+// -- memory
+
+static int find_memory_type(VulkanContext *vk, uint32_t type_bits, VkMemoryPropertyFlags flags, uint32_t *type) {
+    for (uint32_t i = 0; i < vk->memory.memoryTypeCount; i++) {
+        if ((type_bits >> i & 1) && (vk->memory.memoryTypes[i].propertyFlags & flags) == flags) {
+            *type = i;
+            return 0;
+        }
+    }
+    fprintf(stderr, "no Vulkan memory type w/ flags 0x%X\n", flags);
+    return 1;
+}
+
+
+static void free_gpu_buffer(VulkanContext *vk, GpuBuffer *buffer) {
+    vkDestroyBuffer(vk->device, buffer->buffer, NULL);
+    vkFreeMemory(vk->device, buffer->memory, NULL);  // unmaps too
+    *buffer = (GpuBuffer){0};
+}
+
+
+// HOST_VISIBLE buffers are mapped for their lifetime
+static int create_gpu_buffer(VulkanContext *vk, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags flags, GpuBuffer *buffer) {
+    *buffer = (GpuBuffer){.size = size};
+    VkBufferCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
+    if (vk_failed(vkCreateBuffer(vk->device, &info, NULL, &buffer->buffer), "vkCreateBuffer"))
+        return 1;
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(vk->device, buffer->buffer, &requirements);
+    VkMemoryAllocateInfo allocate = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = requirements.size};
+    if (find_memory_type(vk, requirements.memoryTypeBits, flags, &allocate.memoryTypeIndex) != 0
+     || vk_failed(vkAllocateMemory(vk->device, &allocate, NULL, &buffer->memory), "vkAllocateMemory")
+     || vk_failed(vkBindBufferMemory(vk->device, buffer->buffer, buffer->memory, 0), "vkBindBufferMemory")) {
+        free_gpu_buffer(vk, buffer);
+        return 1;
+    }
+    if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+     && vk_failed(vkMapMemory(vk->device, buffer->memory, 0, VK_WHOLE_SIZE, 0, &buffer->mapped), "vkMapMemory")) {
+        free_gpu_buffer(vk, buffer);
+        return 1;
+    }
+    return 0;
+}
+
+
+static void free_gpu_image(VulkanContext *vk, GpuImage *image) {
+    vkDestroyImageView(vk->device, image->view, NULL);
+    vkDestroyImage(vk->device, image->image, NULL);
+    vkFreeMemory(vk->device, image->memory, NULL);
+    *image = (GpuImage){0};
+}
+
+
+// device local; view->image is filled in
+static int create_gpu_image(VulkanContext *vk, VkImageCreateInfo *info, VkImageViewCreateInfo *view, GpuImage *image) {
+    *image = (GpuImage){0};
+    if (vk_failed(vkCreateImage(vk->device, info, NULL, &image->image), "vkCreateImage"))
+        return 1;
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(vk->device, image->image, &requirements);
+    VkMemoryAllocateInfo allocate = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = requirements.size};
+    view->image = image->image;
+    if (find_memory_type(vk, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &allocate.memoryTypeIndex) != 0
+     || vk_failed(vkAllocateMemory(vk->device, &allocate, NULL, &image->memory), "vkAllocateMemory")
+     || vk_failed(vkBindImageMemory(vk->device, image->image, image->memory, 0), "vkBindImageMemory")
+     || vk_failed(vkCreateImageView(vk->device, view, NULL, &image->view), "vkCreateImageView")) {
+        free_gpu_image(vk, image);
+        return 1;
+    }
+    return 0;
+}
+
+
+// 1 off command buffers; init & read_output only, never per frame
+static int begin_once(VulkanContext *vk, VkCommandBuffer *commands) {
+    VkCommandBufferAllocateInfo allocate = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = vk->pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1};
+    if (vk_failed(vkAllocateCommandBuffers(vk->device, &allocate, commands), "vkAllocateCommandBuffers"))
+        return 1;
+    VkCommandBufferBeginInfo begin = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+    vkBeginCommandBuffer(*commands, &begin);
+    return 0;
+}
+
+
+// submits & waits for the queue to drain
+static int end_once(VulkanContext *vk, VkCommandBuffer commands) {
+    vkEndCommandBuffer(commands);
+    VkSubmitInfo submit = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commands};
+    int result = 0;
+    if (vk_failed(vkQueueSubmit(vk->queue, 1, &submit, VK_NULL_HANDLE), "vkQueueSubmit")
+     || vk_failed(vkQueueWaitIdle(vk->queue), "vkQueueWaitIdle"))
+        result = 1;
+    vkFreeCommandBuffers(vk->device, vk->pool, 1, &commands);
+    return result;
+}
+
+
+// size bytes of data -> dest at offset, through a staging buffer
+static int upload_buffer(VulkanContext *vk, GpuBuffer *dest, VkDeviceSize offset, const void *data, VkDeviceSize size) {
+    if (size == 0)
+        return 0;
+    GpuBuffer staging;
+    if (create_gpu_buffer(vk, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &staging) != 0)
+        return 1;
+    memcpy(staging.mapped, data, size);
+    VkCommandBuffer commands;
+    int result = begin_once(vk, &commands);
+    if (result == 0) {
+        VkBufferCopy region = {.srcOffset = 0, .dstOffset = offset, .size = size};
+        vkCmdCopyBuffer(commands, staging.buffer, dest->buffer, 1, &region);
+        result = end_once(vk, commands);
+    }
+    free_gpu_buffer(vk, &staging);
+    return result;
+}
+
+
+// -- presentation
+
+int init_swapchain(VulkanContext *vk, Swapchain *swapchain, int width, int height) {
+    VkSurfaceCapabilitiesKHR capabilities;
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vk->physical_device, swapchain->surface, &capabilities);
+    if (!(capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)) {
+        fprintf(stderr, "swapchain images can't be blitted to\n");
+        return 1;
+    }
+
+    // any 8 bit UNORM format; vkCmdBlitImage swizzles RGBA -> BGRA
+    // NOTE: not SRGB; the GL path writes straight to a linear back buffer too
+    uint32_t count = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(vk->physical_device, swapchain->surface, &count, NULL);
+    VkSurfaceFormatKHR *formats = malloc(sizeof(VkSurfaceFormatKHR) * count);
+    if (count == 0 || formats == NULL) {
+        fprintf(stderr, "no surface formats\n");
+        free(formats);
+        return 1;
+    }
+    vkGetPhysicalDeviceSurfaceFormatsKHR(vk->physical_device, swapchain->surface, &count, formats);
+    VkSurfaceFormatKHR format = formats[0];
+    for (uint32_t i = 0; i < count; i++) {
+        if (formats[i].format == VK_FORMAT_B8G8R8A8_UNORM || formats[i].format == VK_FORMAT_R8G8B8A8_UNORM) {
+            format = formats[i];
+            break;
+        }
+    }
+    free(formats);
+
+    // no vsync, like SDL_GL_SetSwapInterval(0); FIFO is the only mode that's always there
+    VkPresentModeKHR modes[8];
+    count = 8;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(vk->physical_device, swapchain->surface, &count, modes);
+    VkPresentModeKHR mode = VK_PRESENT_MODE_FIFO_KHR;
+    for (uint32_t i = 0; i < count; i++) {
+        if (modes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR)
+            mode = modes[i];
+        else if (modes[i] == VK_PRESENT_MODE_MAILBOX_KHR && mode == VK_PRESENT_MODE_FIFO_KHR)
+            mode = modes[i];
+    }
+
+    // NOTE: 0xFFFFFFFF means the surface follows the swapchain
+    VkExtent2D extent = capabilities.currentExtent;
+    if (extent.width == UINT32_MAX) {
+        extent.width = width;
+        extent.height = height;
+    }
+    uint32_t num_images = capabilities.minImageCount + 1;
+    if (capabilities.maxImageCount != 0 && num_images > capabilities.maxImageCount)
+        num_images = capabilities.maxImageCount;
+
+    VkSwapchainKHR old = swapchain->swapchain;
+    VkSwapchainCreateInfoKHR info = {
+        .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+        .surface = swapchain->surface,
+        .minImageCount = num_images,
+        .imageFormat = format.format,
+        .imageColorSpace = format.colorSpace,
+        .imageExtent = extent,
+        .imageArrayLayers = 1,
+        .imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .preTransform = capabilities.currentTransform,
+        .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+        .presentMode = mode,
+        .clipped = VK_TRUE,
+        .oldSwapchain = old};
+    VkResult result = vkCreateSwapchainKHR(vk->device, &info, NULL, &swapchain->swapchain);
+    vkDestroySwapchainKHR(vk->device, old, NULL);  // retired either way
+    if (vk_failed(result, "vkCreateSwapchainKHR")) {
+        swapchain->swapchain = VK_NULL_HANDLE;
+        return 1;
+    }
+    swapchain->format = format.format;
+    swapchain->extent = extent;
+    swapchain->image = 0;
+    swapchain->stale = false;
+
+    vkGetSwapchainImagesKHR(vk->device, swapchain->swapchain, &swapchain->num_images, NULL);
+    swapchain->images = malloc(sizeof(VkImage) * swapchain->num_images);
+    swapchain->rendered = calloc(swapchain->num_images, sizeof(VkSemaphore));
+    swapchain->blits = malloc(sizeof(VkCommandBuffer) * swapchain->num_images);
+    if (swapchain->images == NULL || swapchain->rendered == NULL || swapchain->blits == NULL) {
+        fprintf(stderr, "out of memory for %u swapchain images\n", swapchain->num_images);
+        free_swapchain(vk, swapchain);
+        return 1;
+    }
+    vkGetSwapchainImagesKHR(vk->device, swapchain->swapchain, &swapchain->num_images, swapchain->images);
+    VkSemaphoreCreateInfo semaphore = {.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    for (uint32_t i = 0; i < swapchain->num_images; i++) {
+        if (vk_failed(vkCreateSemaphore(vk->device, &semaphore, NULL, &swapchain->rendered[i]), "vkCreateSemaphore")) {
+            free_swapchain(vk, swapchain);
+            return 1;
+        }
+    }
+    // NOTE: recorded by begin_frame, once the output image exists
+    VkCommandBufferAllocateInfo allocate = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = vk->pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = swapchain->num_images};
+    if (vk_failed(vkAllocateCommandBuffers(vk->device, &allocate, swapchain->blits), "vkAllocateCommandBuffers")) {
+        free(swapchain->blits);
+        swapchain->blits = NULL;
+        free_swapchain(vk, swapchain);
+        return 1;
+    }
+    return 0;
+}
+
+
+void free_swapchain(VulkanContext *vk, Swapchain *swapchain) {
+    vkDeviceWaitIdle(vk->device);
+    if (swapchain->blits != NULL)
+        vkFreeCommandBuffers(vk->device, vk->pool, swapchain->num_images, swapchain->blits);
+    for (uint32_t i = 0; swapchain->rendered != NULL && i < swapchain->num_images; i++)
+        vkDestroySemaphore(vk->device, swapchain->rendered[i], NULL);
+    vkDestroySwapchainKHR(vk->device, swapchain->swapchain, NULL);
+    free(swapchain->images);
+    free(swapchain->rendered);
+    free(swapchain->blits);
+    swapchain->swapchain = VK_NULL_HANDLE;
+    swapchain->images = NULL;
+    swapchain->rendered = NULL;
+    swapchain->blits = NULL;
+    swapchain->num_images = 0;
+}
+
+
+// -- scene geo
+
+int populate(VulkanContext *vk, Scene *scene, SceneDesc *desc) {
+    // instances grouped by mesh, LODs & the culling BVH; see frame_plan.h
+    FramePlan *frame = &scene->frame_plan;
+    Mat4 *transforms = NULL;
+    if (init_frame_plan(frame, desc, &transforms) != 0)
+        return 1;  // init_frame_plan prints its own errors
+
+    // 1 command per LOD of each mesh
+    scene->draws = malloc(sizeof(VkDrawIndexedIndirectCommand) * frame->num_levels);
+    int *base_vertices = malloc(sizeof(int) * desc->num_meshes);
+    int *first_indices = malloc(sizeof(int) * desc->num_meshes);
+    if (scene->draws == NULL || base_vertices == NULL || first_indices == NULL) {
+        fprintf(stderr, "out of memory for %d meshes\n", desc->num_meshes);
+        free(transforms);
+        free(base_vertices);
+        free(first_indices);
+        free_scene_geo(vk, scene);
+        return 1;
+    }
+    int num_vertices = 0;
+    int num_indices = 0;
+    int max_narrowed = 0;  // indices of 1 mesh w/o PackedMesh.indices
+    bool short_indices = true;
+    for (int i = 0; i < desc->num_meshes; i++) {
+        Geometry *geo = &desc->meshes[i];
+        base_vertices[i] = num_vertices;
+        first_indices[i] = num_indices;
+        int base_instances = frame->mesh_instances[i];
+        int level = frame->mesh_levels[i];
+        for (int j = 0; level < frame->mesh_levels[i + 1]; j++, level++) {
+            Geometry lod = geometry_lod(geo, j);
+            VkDrawIndexedIndirectCommand *draw = &scene->draws[level];
+            draw->indexCount = lod.num_indices;
+            draw->firstIndex = num_indices + (lod.indices - geo->indices);
+            draw->vertexOffset = num_vertices;
+            draw->firstInstance = base_instances;
+            draw->instanceCount = frame->mesh_instances[i + 1] - base_instances;
+        }
+        num_vertices += geo->num_vertices;
+        num_indices += geo->num_indices;
+        // NOTE: indices stay local to each mesh; vertexOffset does the rest
+        short_indices = short_indices && geo->num_vertices <= UINT16_MAX + 1;
+        if (desc->packed == NULL || desc->packed[i].indices == NULL)
+            max_narrowed = (geo->num_indices > max_narrowed) ? geo->num_indices : max_narrowed;
+    }
+    uint16_t *narrowed = (short_indices && max_narrowed > 0) ? malloc(sizeof(uint16_t) * max_narrowed) : NULL;
+    short_indices = short_indices && (max_narrowed == 0 || narrowed != NULL);
+    scene->num_indices = num_indices;
+    scene->index_type = short_indices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+    // vertex buffer
+    // NOTE: 1 VertexBounds around every mesh; desc->packed as is if it was packed
+    // against them, otherwise packed on the fly. same as the GL path
+    bool is_prepacked = false;
+    PackedVertex *packed = NULL;
+    if (scene->vertex_format == VERTEX_PACKED) {
+        VertexBounds *bounds = &scene->vertex_bounds;
+        merge_vertex_bounds(desc->num_meshes, desc->meshes, desc->packed, bounds);
+        is_prepacked = prepacked(desc->num_meshes, desc->meshes, desc->packed, bounds);
+        if (!is_prepacked) {
+            packed = malloc(sizeof(PackedVertex) * num_vertices);
+            if (packed == NULL) {
+                fprintf(stderr, "out of memory packing %d vertices; uploading floats\n", num_vertices);
+                scene->vertex_format = VERTEX_FLOAT;
+            }
+        }
+    }
+    size_t vertex_size = (scene->vertex_format == VERTEX_PACKED) ? sizeof(PackedVertex) : sizeof(Vertex);
+    size_t index_size = short_indices ? sizeof(uint16_t) : sizeof(uint32_t);
+    VkMemoryPropertyFlags device_local = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    int result = create_gpu_buffer(vk, vertex_size * num_vertices,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, device_local, &scene->vertex_buffer);
+    if (result == 0)
+        result = create_gpu_buffer(vk, index_size * num_indices,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, device_local, &scene->index_buffer);
+    if (result == 0)
+        result = create_gpu_buffer(vk, sizeof(Mat4) * frame->num_instances,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, device_local, &scene->instance_buffer);
+    if (is_prepacked) {
+        // NOTE: straight from each mesh (e.g. a mapped cache); no copy
+        for (int i = 0; i < desc->num_meshes && result == 0; i++) {
+            result = upload_buffer(vk, &scene->vertex_buffer, sizeof(PackedVertex) * base_vertices[i],
+                desc->packed[i].vertices, sizeof(PackedVertex) * desc->meshes[i].num_vertices);
+        }
+    } else if (result == 0 && packed != NULL) {
+        for (int i = 0; i < desc->num_meshes; i++)
+            pack_vertices(&desc->meshes[i], &scene->vertex_bounds, &packed[base_vertices[i]]);
+        result = upload_buffer(vk, &scene->vertex_buffer, 0, packed, sizeof(PackedVertex) * num_vertices);
+    } else {
+        for (int i = 0; i < desc->num_meshes && result == 0; i++) {
+            result = upload_buffer(vk, &scene->vertex_buffer, sizeof(Vertex) * base_vertices[i],
+                desc->meshes[i].vertices, sizeof(Vertex) * desc->meshes[i].num_vertices);
+        }
+    }
+    free(packed);
+    free(base_vertices);
+
+    // index buffer
+    // -- 16 bit indices if every mesh's vertices are reachable w/ them; half the index fetch
+    for (int i = 0; i < desc->num_meshes && result == 0; i++) {
+        Geometry *geo = &desc->meshes[i];
+        VkDeviceSize offset = index_size * first_indices[i];
+        if (short_indices) {
+            uint16_t *indices = (desc->packed != NULL) ? desc->packed[i].indices : NULL;
+            if (indices == NULL) {
+                for (int j = 0; j < geo->num_indices; j++)
+                    narrowed[j] = (uint16_t)geo->indices[j];
+                indices = narrowed;
+            }
+            result = upload_buffer(vk, &scene->index_buffer, offset, indices, sizeof(uint16_t) * geo->num_indices);
+        } else {
+            result = upload_buffer(vk, &scene->index_buffer, offset, geo->indices, sizeof(uint32_t) * geo->num_indices);
+        }
+    }
+    free(narrowed);
+    free(first_indices);
+
+    // per instance transforms
+    if (result == 0)
+        result = upload_buffer(vk, &scene->instance_buffer, 0, transforms, sizeof(Mat4) * frame->num_instances);
+    free(transforms);
+    if (result != 0) {
+        free_scene_geo(vk, scene);
+        return 1;
+    }
+    return 0;
+}
+
+
+void free_scene_geo(VulkanContext *vk, Scene *scene) {
+    vkDeviceWaitIdle(vk->device);
+    free_gpu_buffer(vk, &scene->vertex_buffer);
+    free_gpu_buffer(vk, &scene->index_buffer);
+    free_gpu_buffer(vk, &scene->instance_buffer);
+    free(scene->draws);
+    scene->draws = NULL;
+    free_frame_plan(&scene->frame_plan);
+}
+
+
+// -- frames
+
+int init_frame_ring(VulkanContext *vk, Scene *scene) {
+    FrameRing *ring = &scene->frames;
+    // worst case: every instance in every face
+    VkDeviceSize alignment = vk->properties.limits.minUniformBufferOffsetAlignment;
+    ring->draws_offset = (sizeof(FrameUniforms) + 15) / 16 * 16;
+    ring->entries_offset = ring->draws_offset + sizeof(VkDrawIndexedIndirectCommand) * scene->frame_plan.num_levels;
+    VkDeviceSize slot_size = ring->entries_offset + sizeof(uint32_t) * 6 * scene->frame_plan.num_instances;
+    ring->stride = (slot_size + alignment - 1) / alignment * alignment;
+
+    // NOTE: coherent; writes land w/o vkFlushMappedMemoryRanges
+    // -- the fences are all that keep the CPU off slots the GPU is reading
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                             | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+                             | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    if (create_gpu_buffer(vk, ring->stride * FRAME_LATENCY, usage,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &ring->buffer) != 0)
+        return 1;
+
+    VkCommandBufferAllocateInfo allocate = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = vk->pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = FRAME_LATENCY};
+    if (vk_failed(vkAllocateCommandBuffers(vk->device, &allocate, ring->commands), "vkAllocateCommandBuffers"))
+        return 1;
+    // signalled, so the 1st begin_frame on each slot doesn't wait
+    VkFenceCreateInfo fence = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .flags = VK_FENCE_CREATE_SIGNALED_BIT};
+    VkSemaphoreCreateInfo semaphore = {.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    for (int i = 0; i < FRAME_LATENCY; i++) {
+        if (vk_failed(vkCreateFence(vk->device, &fence, NULL, &ring->fences[i]), "vkCreateFence")
+         || vk_failed(vkCreateSemaphore(vk->device, &semaphore, NULL, &ring->acquired[i]), "vkCreateSemaphore"))
+            return 1;
+        ring->frames[i] = -1;
+    }
+    ring->slot = 0;
+    ring->frame = 0;
+    ring->num_waits = 0;
+    scene->gpu_frame = -1;
+    scene->recorded = false;
+    return 0;
+}
+
+
+static int load_spirv(VulkanContext *vk, char* path, VkShaderModule *module) {
+    MappedFile file;
+    if (map_file(path, &file) != 0) {
+        fprintf(stderr, "no SPIR-V at %s; build it w/ make (needs glslc)\n", path);
+        return 1;
+    }
+    // NOTE: mapped & malloc'd data are both aligned enough for uint32_t
+    VkShaderModuleCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = file.length,
+        .pCode = (const uint32_t*)file.data};
+    int result = 0;
+    if (file.length == 0 || file.length % 4 != 0) {
+        fprintf(stderr, "not SPIR-V: %s\n", path);
+        result = 1;
+    } else if (vk_failed(vkCreateShaderModule(vk->device, &info, NULL, module), path)) {
+        result = 1;
+    }
+    unmap_file(&file);
+    return result;
+}
+
+
+// 1 subpass; every face cleared in full, then read by the reprojection
+static int init_cube_pass(VulkanContext *vk, Scene *scene) {
+    VkAttachmentDescription attachments[2] = {
+        {   .format = CUBE_FORMAT,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,  // last frame's cube is never read
+            .finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+        {   .format = vk->depth_format,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL}};
+    VkAttachmentReference colour = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    VkAttachmentReference depth = {1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+    VkSubpassDescription subpass = {
+        .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colour,
+        .pDepthStencilAttachment = &depth};
+    // the cube is shared by every frame in flight
+    // -- in: the last frame's reprojection is done reading it & its depth writes are done
+    // -- out: this frame's reprojection waits for the faces
+    VkSubpassDependency dependencies[2] = {
+        {   .srcSubpass = VK_SUBPASS_EXTERNAL,
+            .dstSubpass = 0,
+            .srcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+            .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT},
+        {   .srcSubpass = 0,
+            .dstSubpass = VK_SUBPASS_EXTERNAL,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT}};
+    VkRenderPassCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+        .attachmentCount = 2,
+        .pAttachments = attachments,
+        .subpassCount = 1,
+        .pSubpasses = &subpass,
+        .dependencyCount = 2,
+        .pDependencies = dependencies};
+    if (vk_failed(vkCreateRenderPass(vk->device, &info, NULL, &scene->cube_pass), "vkCreateRenderPass"))
+        return 1;
+    return 0;
+}
+
+
+static int init_cube_pipeline(VulkanContext *vk, Scene *scene, VkShaderModule vertex, VkShaderModule fragment) {
+    VkPipelineShaderStageCreateInfo stages[2] = {
+        {   .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_VERTEX_BIT,
+            .module = vertex,
+            .pName = "main"},
+        {   .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module = fragment,
+            .pName = "main"}};
+
+    // binding 0: vertices; binding 1: this frame's (instance, face) entries, in its ring slot
+    // NOTE: same locations either way; the shaders decode w/ PACKED_VERTEX
+    bool packed = scene->vertex_format == VERTEX_PACKED;
+    VkVertexInputBindingDescription bindings[2] = {
+        {0, packed ? sizeof(PackedVertex) : sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX},
+        {1, sizeof(uint32_t), VK_VERTEX_INPUT_RATE_INSTANCE}};
+    VkVertexInputAttributeDescription attributes[4];
+    if (packed) {
+        // NOTE: position[3] is padding; 3 component 16 bit formats are optional for vertex fetch
+        attributes[0] = (VkVertexInputAttributeDescription){0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(PackedVertex, position)};
+        attributes[1] = (VkVertexInputAttributeDescription){1, 0, VK_FORMAT_R16G16_SNORM, offsetof(PackedVertex, normal)};
+        attributes[2] = (VkVertexInputAttributeDescription){2, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(PackedVertex, uv)};
+    } else {
+        attributes[0] = (VkVertexInputAttributeDescription){0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position)};
+        attributes[1] = (VkVertexInputAttributeDescription){1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal)};
+        attributes[2] = (VkVertexInputAttributeDescription){2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv)};
+    }
+    attributes[3] = (VkVertexInputAttributeDescription){3, 1, VK_FORMAT_R32_UINT, 0};
+    VkPipelineVertexInputStateCreateInfo vertex_input = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = 2,
+        .pVertexBindingDescriptions = bindings,
+        .vertexAttributeDescriptionCount = 4,
+        .pVertexAttributeDescriptions = attributes};
+    VkPipelineInputAssemblyStateCreateInfo input_assembly = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST};
+    // 1 viewport & scissor per face; set when the frames are recorded
+    VkPipelineViewportStateCreateInfo viewport = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 6,
+        .scissorCount = 6};
+    // NOTE: no y flip, so faces land in the same rows as GL's & GL_CW winding
+    //       comes out counter clockwise; Vulkan's polygon area has the opposite sign
+    VkPipelineRasterizationStateCreateInfo rasterisation = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .lineWidth = 1.0f};
+    VkPipelineMultisampleStateCreateInfo multisample = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT};
+    VkPipelineDepthStencilStateCreateInfo depth = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS};
+    VkPipelineColorBlendAttachmentState blend_attachment = {
+        .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
+                        | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT};
+    VkPipelineColorBlendStateCreateInfo blend = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .attachmentCount = 1,
+        .pAttachments = &blend_attachment};
+    VkDynamicState dynamic_states[2] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamic = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = 2,
+        .pDynamicStates = dynamic_states};
+    VkGraphicsPipelineCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .stageCount = 2,
+        .pStages = stages,
+        .pVertexInputState = &vertex_input,
+        .pInputAssemblyState = &input_assembly,
+        .pViewportState = &viewport,
+        .pRasterizationState = &rasterisation,
+        .pMultisampleState = &multisample,
+        .pDepthStencilState = &depth,
+        .pColorBlendState = &blend,
+        .pDynamicState = &dynamic,
+        .layout = scene->scene_layout,
+        .renderPass = scene->cube_pass,
+        .subpass = 0};
+    if (vk_failed(vkCreateGraphicsPipelines(vk->device, VK_NULL_HANDLE, 1, &info, NULL, &scene->cube_pipeline), "cube pipeline"))
+        return 1;
+    return 0;
+}
+
+
+static int init_descriptors(VulkanContext *vk, Scene *scene) {
+    // scene set; frame uniforms at a dynamic offset (the slot) & instance transforms
+    VkDescriptorSetLayoutBinding scene_bindings[2] = {
+        {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT, NULL},
+        {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, NULL}};
+    // panini set; cube in, output out
+    VkDescriptorSetLayoutBinding panini_bindings[2] = {
+        {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL},
+        {1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL}};
+    VkDescriptorSetLayoutCreateInfo scene_set = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 2,
+        .pBindings = scene_bindings};
+    VkDescriptorSetLayoutCreateInfo panini_set = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 2,
+        .pBindings = panini_bindings};
+    if (vk_failed(vkCreateDescriptorSetLayout(vk->device, &scene_set, NULL, &scene->scene_set_layout), "vkCreateDescriptorSetLayout")
+     || vk_failed(vkCreateDescriptorSetLayout(vk->device, &panini_set, NULL, &scene->panini_set_layout), "vkCreateDescriptorSetLayout"))
+        return 1;
+
+    VkPipelineLayoutCreateInfo scene_layout = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &scene->scene_set_layout};
+    VkPushConstantRange panini_params = {VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(float) * 4};
+    VkPipelineLayoutCreateInfo panini_layout = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &scene->panini_set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &panini_params};
+    if (vk_failed(vkCreatePipelineLayout(vk->device, &scene_layout, NULL, &scene->scene_layout), "vkCreatePipelineLayout")
+     || vk_failed(vkCreatePipelineLayout(vk->device, &panini_layout, NULL, &scene->panini_layout), "vkCreatePipelineLayout"))
+        return 1;
+
+    VkDescriptorPoolSize sizes[4] = {
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1}};
+    VkDescriptorPoolCreateInfo pool = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets = 2,
+        .poolSizeCount = 4,
+        .pPoolSizes = sizes};
+    if (vk_failed(vkCreateDescriptorPool(vk->device, &pool, NULL, &scene->descriptor_pool), "vkCreateDescriptorPool"))
+        return 1;
+    VkDescriptorSetLayout layouts[2] = {scene->scene_set_layout, scene->panini_set_layout};
+    VkDescriptorSet sets[2];
+    VkDescriptorSetAllocateInfo allocate = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = scene->descriptor_pool,
+        .descriptorSetCount = 2,
+        .pSetLayouts = layouts};
+    if (vk_failed(vkAllocateDescriptorSets(vk->device, &allocate, sets), "vkAllocateDescriptorSets"))
+        return 1;
+    scene->scene_set = sets[0];
+    scene->panini_set = sets[1];
+
+    // NOTE: the scene set never changes; the panini set follows the cube & output
+    VkDescriptorBufferInfo uniforms = {scene->frames.buffer.buffer, 0, sizeof(FrameUniforms)};
+    VkDescriptorBufferInfo instances = {scene->instance_buffer.buffer, 0, VK_WHOLE_SIZE};
+    VkWriteDescriptorSet writes[2] = {
+        {   .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = scene->scene_set,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .pBufferInfo = &uniforms},
+        {   .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = scene->scene_set,
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &instances}};
+    vkUpdateDescriptorSets(vk->device, 2, writes, 0, NULL);
+    return 0;
+}
+
+
+int init_scene_pipelines(VulkanContext *vk, Scene *scene) {
+    if (init_descriptors(vk, scene) != 0 || init_cube_pass(vk, scene) != 0)
+        return 1;
+
+    // bilinear within & across faces; Vulkan cube maps are always seamless
+    VkSamplerCreateInfo sampler = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .maxLod = 0.0f};
+    if (vk_failed(vkCreateSampler(vk->device, &sampler, NULL, &scene->cube_sampler), "vkCreateSampler"))
+        return 1;
+
+    // NOTE: clay.frag.glsl is the GL path's, as is; the vertex shader differs in
+    //       descriptor sets & gl_Layer w/o a gl_PerVertex redeclaration
+    char *vertex_path = (scene->vertex_format == VERTEX_PACKED)
+        ? "build/vulkan/cube_packed.vert.spv" : "build/vulkan/cube_float.vert.spv";
+    VkShaderModule vertex = VK_NULL_HANDLE;
+    VkShaderModule fragment = VK_NULL_HANDLE;
+    VkShaderModule compute = VK_NULL_HANDLE;
+    int result = 0;
+    if (load_spirv(vk, vertex_path, &vertex) != 0
+     || load_spirv(vk, "build/vulkan/clay.frag.spv", &fragment) != 0
+     || load_spirv(vk, "build/vulkan/panini.comp.spv", &compute) != 0)
+        result = 1;
+    if (result == 0)
+        result = init_cube_pipeline(vk, scene, vertex, fragment);
+    if (result == 0) {
+        VkComputePipelineCreateInfo info = {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = compute,
+                .pName = "main"},
+            .layout = scene->panini_layout};
+        if (vk_failed(vkCreateComputePipelines(vk->device, VK_NULL_HANDLE, 1, &info, NULL, &scene->panini_pipeline), "panini pipeline"))
+            result = 1;
+    }
+    // modules are only needed to make pipelines
+    vkDestroyShaderModule(vk->device, vertex, NULL);
+    vkDestroyShaderModule(vk->device, fragment, NULL);
+    vkDestroyShaderModule(vk->device, compute, NULL);
+    if (result != 0)
+        return 1;
+
+    // GPU timings; skipped quietly if the queue has no timestamps
+    if (vk->properties.limits.timestampComputeAndGraphics) {
+        VkQueryPoolCreateInfo pool = {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = GPU_TIMESTAMPS * FRAME_LATENCY};
+        if (vk_failed(vkCreateQueryPool(vk->device, &pool, NULL, &scene->timestamps), "vkCreateQueryPool"))
+            scene->timestamps = VK_NULL_HANDLE;
+    }
+    return 0;
+}
+
+
+static void free_cube_target(VulkanContext *vk, CubeTarget *cube) {
+    vkDestroyFramebuffer(vk->device, cube->framebuffer, NULL);
+    vkDestroyImageView(vk->device, cube->layers, NULL);
+    free_gpu_image(vk, &cube->colour);
+    free_gpu_image(vk, &cube->depth);
+    *cube = (CubeTarget){0};
+}
+
+
+void free_scene(VulkanContext *vk, Scene *scene) {
+    vkDeviceWaitIdle(vk->device);
+    FrameRing *ring = &scene->frames;
+    for (int i = 0; i < FRAME_LATENCY; i++) {
+        vkDestroyFence(vk->device, ring->fences[i], NULL);
+        vkDestroySemaphore(vk->device, ring->acquired[i], NULL);
+        ring->fences[i] = VK_NULL_HANDLE;
+        ring->acquired[i] = VK_NULL_HANDLE;
+        if (ring->commands[i] != VK_NULL_HANDLE)
+            vkFreeCommandBuffers(vk->device, vk->pool, 1, &ring->commands[i]);
+        ring->commands[i] = VK_NULL_HANDLE;
+    }
+    free_gpu_buffer(vk, &ring->buffer);
+    free_cube_target(vk, &scene->cube);
+    free_gpu_image(vk, &scene->output);
+    vkDestroyQueryPool(vk->device, scene->timestamps, NULL);
+    vkDestroyPipeline(vk->device, scene->cube_pipeline, NULL);
+    vkDestroyPipeline(vk->device, scene->panini_pipeline, NULL);
+    vkDestroyRenderPass(vk->device, scene->cube_pass, NULL);
+    vkDestroySampler(vk->device, scene->cube_sampler, NULL);
+    vkDestroyDescriptorPool(vk->device, scene->descriptor_pool, NULL);  // frees its sets
+    vkDestroyPipelineLayout(vk->device, scene->scene_layout, NULL);
+    vkDestroyPipelineLayout(vk->device, scene->panini_layout, NULL);
+    vkDestroyDescriptorSetLayout(vk->device, scene->scene_set_layout, NULL);
+    vkDestroyDescriptorSetLayout(vk->device, scene->panini_set_layout, NULL);
+    scene->timestamps = VK_NULL_HANDLE;
+    scene->cube_pipeline = scene->panini_pipeline = VK_NULL_HANDLE;
+    scene->cube_pass = VK_NULL_HANDLE;
+    scene->cube_sampler = VK_NULL_HANDLE;
+    scene->descriptor_pool = VK_NULL_HANDLE;
+    scene->scene_set = scene->panini_set = VK_NULL_HANDLE;
+    scene->scene_layout = scene->panini_layout = VK_NULL_HANDLE;
+    scene->scene_set_layout = scene->panini_set_layout = VK_NULL_HANDLE;
+    scene->cube_plan.size = 0;
+    scene->recorded = false;
+}
+
+
+// -- targets
+
+static int init_cube_target(VulkanContext *vk, Scene *scene, int size) {
+    CubeTarget *cube = &scene->cube;
+    cube->size = size;
+
+    // NOTE: no mips; the cube is re-rendered every frame
+    VkImageCreateInfo image = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = CUBE_FORMAT,
+        .extent = {size, size, 1},
+        .mipLevels = 1,
+        .arrayLayers = 6,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED};
+    VkImageViewCreateInfo view = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .viewType = VK_IMAGE_VIEW_TYPE_CUBE,
+        .format = CUBE_FORMAT,
+        .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6}};
+    if (create_gpu_image(vk, &image, &view, &cube->colour) != 0) {
+        free_cube_target(vk, cube);
+        return 1;
+    }
+    view.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    if (vk_failed(vkCreateImageView(vk->device, &view, NULL, &cube->layers), "vkCreateImageView")) {
+        free_cube_target(vk, cube);
+        return 1;
+    }
+
+    // NOTE: only ever an attachment; never stored
+    image.flags = 0;
+    image.format = vk->depth_format;
+    image.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    view.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    view.format = vk->depth_format;
+    view.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    if (create_gpu_image(vk, &image, &view, &cube->depth) != 0) {
+        free_cube_target(vk, cube);
+        return 1;
+    }
+
+    // NOTE: 6 layers makes the framebuffer layered; gl_Layer picks the face
+    VkImageView attachments[2] = {cube->layers, cube->depth.view};
+    VkFramebufferCreateInfo framebuffer = {
+        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+        .renderPass = scene->cube_pass,
+        .attachmentCount = 2,
+        .pAttachments = attachments,
+        .width = size,
+        .height = size,
+        .layers = 6};
+    if (vk_failed(vkCreateFramebuffer(vk->device, &framebuffer, NULL, &cube->framebuffer), "vkCreateFramebuffer")) {
+        free_cube_target(vk, cube);
+        return 1;
+    }
+    return 0;
+}
+
+
+static int init_output(VulkanContext *vk, Scene *scene) {
+    // NOTE: written whole by every reprojection; never cleared or read back into
+    VkImageCreateInfo image = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = OUTPUT_FORMAT,
+        .extent = {scene->width, scene->height, 1},
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED};
+    VkImageViewCreateInfo view = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = OUTPUT_FORMAT,
+        .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}};
+    return create_gpu_image(vk, &image, &view, &scene->output);
+}
+
+
+// false if plan is already up to date
+static bool update_cube_plan(VulkanContext *vk, CubePlan *plan, int width, int height, PaniniParams *params) {
+    if (cube_plan_current(plan, width, height, params))
+        return false;
+    plan_cube(plan, vk->properties.limits.maxImageDimensionCube, width, height, params);
+    return true;
+}
+
+
+// -- recording
+// NOTE: everything below the frame ring's contents is baked into these; only
+//       a new plan, output size or swapchain re-records them (see begin_frame)
+
+static void image_barrier(VkCommandBuffer commands, VkImage image,
+        VkPipelineStageFlags src_stage, VkAccessFlags src_access, VkImageLayout old_layout,
+        VkPipelineStageFlags dst_stage, VkAccessFlags dst_access, VkImageLayout new_layout) {
+    VkImageMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = src_access,
+        .dstAccessMask = dst_access,
+        .oldLayout = old_layout,
+        .newLayout = new_layout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}};
+    vkCmdPipelineBarrier(commands, src_stage, dst_stage, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+
+// cube pass & reprojection, reading slot's uniforms & draws
+static int record_frame(VulkanContext *vk, Scene *scene, int slot) {
+    FrameRing *ring = &scene->frames;
+    VkCommandBuffer commands = ring->commands[slot];
+    VkDeviceSize slot_offset = ring->stride * slot;
+    // NOTE: no ONE_TIME_SUBMIT; resubmitted every FRAME_LATENCY frames, never in 2 frames at once
+    VkCommandBufferBeginInfo begin = {.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    if (vk_failed(vkBeginCommandBuffer(commands, &begin), "vkBeginCommandBuffer"))
+        return 1;
+    uint32_t first_query = GPU_TIMESTAMPS * slot;
+    if (scene->timestamps != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commands, scene->timestamps, first_query, GPU_TIMESTAMPS);
+        vkCmdWriteTimestamp(commands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, scene->timestamps, first_query);
+    }
+
+    // cube pass
+    // -- every used face in 1 indirect draw; the vertex shader picks each entry's face
+    // -- the render area is every face, in full; draws are still scissored per face
+    // NOTE: Vulkan cube sampling is always seamless, so bilinear taps at a face's
+    //       edge read its neighbour's edge texels too, whatever the plan's bounds;
+    //       an UNDEFINED cube must have those cleared, not left as garbage
+    CubePlan *plan = &scene->cube_plan;
+    VkClearValue clears[2] = {{.color = CLEAR_COLOUR}, {.depthStencil = {1.0f, 0}}};
+    VkRenderPassBeginInfo pass = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .renderPass = scene->cube_pass,
+        .framebuffer = scene->cube.framebuffer,
+        .renderArea = {{0, 0}, {plan->size, plan->size}},
+        .clearValueCount = 2,
+        .pClearValues = clears};
+    vkCmdBeginRenderPass(commands, &pass, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(commands, VK_PIPELINE_BIND_POINT_GRAPHICS, scene->cube_pipeline);
+    // 1 scissor per face; the vertex shader writes gl_ViewportIndex = face
+    // NOTE: unused faces get an empty scissor; nothing is drawn to them anyway
+    VkViewport viewports[6];
+    VkRect2D scissors[6];
+    for (int i = 0; i < 6; i++) {
+        int *scissor = plan->scissors[i];
+        viewports[i] = (VkViewport){0.0f, 0.0f, (float)plan->size, (float)plan->size, 0.0f, 1.0f};
+        scissors[i] = (VkRect2D){{scissor[0], scissor[1]}, {scissor[2], scissor[3]}};
+    }
+    vkCmdSetViewport(commands, 0, 6, viewports);
+    vkCmdSetScissor(commands, 0, 6, scissors);
+    uint32_t uniforms_offset = (uint32_t)slot_offset;
+    vkCmdBindDescriptorSets(commands, VK_PIPELINE_BIND_POINT_GRAPHICS, scene->scene_layout,
+        0, 1, &scene->scene_set, 1, &uniforms_offset);
+    VkBuffer buffers[2] = {scene->vertex_buffer.buffer, ring->buffer.buffer};
+    VkDeviceSize offsets[2] = {0, slot_offset + ring->entries_offset};
+    vkCmdBindVertexBuffers(commands, 0, 2, buffers, offsets);
+    vkCmdBindIndexBuffer(commands, scene->index_buffer.buffer, 0, scene->index_type);
+    // NOTE: 1 command per LOD, always; LODs w/ nothing visible have 0 instances,
+    //       so the draw count never has to change after recording
+    vkCmdDrawIndexedIndirect(commands, ring->buffer.buffer, slot_offset + ring->draws_offset,
+        scene->frame_plan.num_levels, sizeof(VkDrawIndexedIndirectCommand));
+    vkCmdEndRenderPass(commands);
+    if (scene->timestamps != VK_NULL_HANDLE)
+        vkCmdWriteTimestamp(commands, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, scene->timestamps, first_query + 1);
+
+    // reprojection
+    // -- 1 invocation per output pixel, straight into the storage image; no LUT & no raster
+    // -- the last frame's blit or copy must be done reading the output first
+    image_barrier(commands, scene->output.image,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    float half_width = panini_half_width(&scene->panini);
+    float panini[4] = {scene->panini.d, scene->panini.compression, half_width, half_width * scene->height / scene->width};
+    vkCmdBindPipeline(commands, VK_PIPELINE_BIND_POINT_COMPUTE, scene->panini_pipeline);
+    vkCmdBindDescriptorSets(commands, VK_PIPELINE_BIND_POINT_COMPUTE, scene->panini_layout,
+        0, 1, &scene->panini_set, 0, NULL);
+    vkCmdPushConstants(commands, scene->panini_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(panini), panini);
+    vkCmdDispatch(commands, (scene->width + 7) / 8, (scene->height + 7) / 8, 1);  // local size is 8x8
+    image_barrier(commands, scene->output.image,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    if (scene->timestamps != VK_NULL_HANDLE)
+        vkCmdWriteTimestamp(commands, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, scene->timestamps, first_query + 2);
+
+    if (vk_failed(vkEndCommandBuffer(commands), "vkEndCommandBuffer"))
+        return 1;
+    return 0;
+}
+
+
+// output -> 1 swapchain image, left ready to present
+static int record_blit(VulkanContext *vk, Scene *scene, uint32_t image) {
+    Swapchain *swapchain = scene->swapchain;
+    VkCommandBuffer commands = swapchain->blits[image];
+    VkCommandBufferBeginInfo begin = {.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    if (vk_failed(vkBeginCommandBuffer(commands, &begin), "vkBeginCommandBuffer"))
+        return 1;
+    // NOTE: the acquire semaphore is waited on at TRANSFER; the transition comes after it
+    image_barrier(commands, swapchain->images[image],
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    VkImageBlit region = {
+        .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+        .srcOffsets = {{0, 0, 0}, {scene->width, scene->height, 1}},
+        .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+        .dstOffsets = {{0, 0, 0}, {swapchain->extent.width, swapchain->extent.height, 1}}};
+    vkCmdBlitImage(commands,
+        scene->output.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        swapchain->images[image], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1, &region, VK_FILTER_NEAREST);
+    image_barrier(commands, swapchain->images[image],
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    if (vk_failed(vkEndCommandBuffer(commands), "vkEndCommandBuffer"))
+        return 1;
+    return 0;
+}
+
+
+// new cube & output targets for the plan, & every command buffer re-recorded
+// NOTE: the device must be idle; pending frames read all of these
+static int rebuild_frames(VulkanContext *vk, Scene *scene) {
+    if (scene->cube.size != scene->cube_plan.size) {
+        free_cube_target(vk, &scene->cube);
+        if (init_cube_target(vk, scene, scene->cube_plan.size) != 0)
+            return 1;  // init_cube_target prints its own errors
+    }
+    free_gpu_image(vk, &scene->output);
+    if (init_output(vk, scene) != 0)
+        return 1;
+
+    VkDescriptorImageInfo cube = {scene->cube_sampler, scene->cube.colour.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    VkDescriptorImageInfo output = {VK_NULL_HANDLE, scene->output.view, VK_IMAGE_LAYOUT_GENERAL};
+    VkWriteDescriptorSet writes[2] = {
+        {   .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = scene->panini_set,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .pImageInfo = &cube},
+        {   .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = scene->panini_set,
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .pImageInfo = &output}};
+    vkUpdateDescriptorSets(vk->device, 2, writes, 0, NULL);
+
+    for (int i = 0; i < FRAME_LATENCY; i++) {
+        if (record_frame(vk, scene, i) != 0)
+            return 1;
+    }
+    for (uint32_t i = 0; scene->swapchain != NULL && i < scene->swapchain->num_images; i++) {
+        if (record_blit(vk, scene, i) != 0)
+            return 1;
+    }
+    scene->recorded = true;
+    return 0;
+}
+
+
+// -- per frame
+
+int begin_frame(VulkanContext *vk, Scene *scene) {
+    FrameRing *ring = &scene->frames;
+    VkFence fence = ring->fences[ring->slot];
+    if (vkGetFenceStatus(vk->device, fence) == VK_NOT_READY) {
+        ring->num_waits++;
+        // 1s; a longer stall than that is a lost GPU, not a slow one
+        VkResult result = vkWaitForFences(vk->device, 1, &fence, VK_TRUE, 1000000000);
+        if (vk_failed(result, "frame fence wait"))
+            return 1;
+    }
+
+    // NOTE: the slot's last frame is done, so its timestamps are in; no stall
+    if (scene->timestamps != VK_NULL_HANDLE && ring->frames[ring->slot] > scene->gpu_frame) {
+        uint64_t ticks[GPU_TIMESTAMPS];
+        VkResult result = vkGetQueryPoolResults(vk->device, scene->timestamps,
+            GPU_TIMESTAMPS * ring->slot, GPU_TIMESTAMPS, sizeof(ticks), ticks,
+            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        if (result == VK_SUCCESS) {
+            double ms_per_tick = vk->properties.limits.timestampPeriod * 1e-6;
+            scene->gpu_ms[0] = (ticks[1] - ticks[0]) * ms_per_tick;
+            scene->gpu_ms[1] = (ticks[2] - ticks[1]) * ms_per_tick;
+            scene->gpu_frame = ring->frames[ring->slot];
+        }
+    }
+
+    // NOTE: free unless the resolution or params changed since last frame
+    if (update_cube_plan(vk, &scene->cube_plan, scene->width, scene->height, &scene->panini))
+        scene->recorded = false;
+    if (!scene->recorded) {
+        vkDeviceWaitIdle(vk->device);
+        if (rebuild_frames(vk, scene) != 0) {
+            scene->cube_plan.size = 0;  // retry next frame
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+// GL clip z ([-w, +w]) -> Vulkan's ([0, w]); z' = (z + w) / 2
+static const Mat4 vulkan_clip = {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 0.5f, 0}, {0, 0, 0.5f, 1}}};
+
+
+// every LOD's indirect command into this frame's slot (after FrameUniforms),
+// then the (instance, face) entries they draw (vertex binding 1)
+// -- cull_frame has already counted each LOD's entries
+// NOTE: written straight to the mapping, which may be uncached; never read back
+static void write_frame_draws(Scene *scene) {
+    FramePlan *frame = &scene->frame_plan;
+    FrameRing *ring = &scene->frames;
+    char *slot = (char*)ring->buffer.mapped + ring->stride * ring->slot;
+    VkDrawIndexedIndirectCommand *commands = (VkDrawIndexedIndirectCommand*)(slot + ring->draws_offset);
+    int first = 0;
+    for (int i = 0; i < frame->num_levels; i++) {
+        VkDrawIndexedIndirectCommand draw = scene->draws[i];
+        draw.instanceCount = frame->level_entries[i];
+        draw.firstInstance = first;
+        commands[i] = draw;
+        first += frame->level_entries[i];
+    }
+    write_frame_entries(frame, true, (uint32_t*)(slot + ring->entries_offset));
+}
+
+
+int draw_scene(VulkanContext *vk, Scene *scene) {
+    FrameRing *ring = &scene->frames;
+    Swapchain *swapchain = scene->swapchain;
+    // acquire first; a stale swapchain skips the frame w/o touching the slot
+    if (swapchain != NULL) {
+        VkResult result = vkAcquireNextImageKHR(vk->device, swapchain->swapchain, UINT64_MAX,
+            ring->acquired[ring->slot], VK_NULL_HANDLE, &swapchain->image);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            swapchain->stale = true;
+            return 0;
+        } else if (result == VK_SUBOPTIMAL_KHR) {
+            swapchain->stale = true;  // still presentable; rebuilt after this frame
+        } else if (vk_failed(result, "vkAcquireNextImageKHR")) {
+            return 1;
+        }
+    }
+
+    // NOTE: the only per frame writes; coherent, so no flush
+    // -- built on the stack; the mapping is write only & may be uncached
+    FrameViews views;
+    frame_views(&scene->camera, &views);
+    FrameUniforms frame = {0};
+    for (int i = 0; i < 6; i++)
+        frame.face_view_projection[i] = Mat4_multiply(&vulkan_clip, &views.face_view_projection[i]);
+    VertexBounds *bounds = &scene->vertex_bounds;
+    frame.position_offset[0] = bounds->offset.x;
+    frame.position_offset[1] = bounds->offset.y;
+    frame.position_offset[2] = bounds->offset.z;
+    frame.position_scale[0] = bounds->scale.x;
+    frame.position_scale[1] = bounds->scale.y;
+    frame.position_scale[2] = bounds->scale.z;
+    char *slot = (char*)ring->buffer.mapped + ring->stride * ring->slot;
+    memcpy(slot, &frame, sizeof(FrameUniforms));
+    // culling & LOD picks, then this frame's draws
+    // -- the vertex shader picks each entry's face from it; 1 entry per visible (instance, face)
+    cull_frame(&scene->frame_plan, &views, &scene->cube_plan, &scene->panini, scene->width, true);
+    write_frame_draws(scene);
+
+    // the slot's pre-recorded commands, then the blit to whichever image was acquired
+    // -- the blit waits for the image at TRANSFER; the cube pass & reprojection don't
+    VkCommandBuffer commands[2] = {ring->commands[ring->slot], VK_NULL_HANDLE};
+    VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    VkSubmitInfo submit = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = commands};
+    if (swapchain != NULL) {
+        commands[1] = swapchain->blits[swapchain->image];
+        submit.commandBufferCount = 2;
+        submit.waitSemaphoreCount = 1;
+        submit.pWaitSemaphores = &ring->acquired[ring->slot];
+        submit.pWaitDstStageMask = &wait_stage;
+        submit.signalSemaphoreCount = 1;
+        submit.pSignalSemaphores = &swapchain->rendered[swapchain->image];
+    }
+    VkFence fence = ring->fences[ring->slot];
+    vkResetFences(vk->device, 1, &fence);
+    if (vk_failed(vkQueueSubmit(vk->queue, 1, &submit, fence), "vkQueueSubmit"))
+        return 1;
+    ring->frames[ring->slot] = ring->frame++;
+    ring->slot = (ring->slot + 1) % FRAME_LATENCY;
+
+    if (swapchain != NULL) {
+        VkPresentInfoKHR present = {
+            .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &swapchain->rendered[swapchain->image],
+            .swapchainCount = 1,
+            .pSwapchains = &swapchain->swapchain,
+            .pImageIndices = &swapchain->image};
+        VkResult result = vkQueuePresentKHR(vk->queue, &present);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+            swapchain->stale = true;
+        } else if (vk_failed(result, "vkQueuePresentKHR")) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+int read_output(VulkanContext *vk, Scene *scene, Image *image) {
+    vkDeviceWaitIdle(vk->device);
+    if (scene->output.image == VK_NULL_HANDLE || scene->frames.frame == 0) {
+        fprintf(stderr, "no frame to read back\n");
+        return 1;
+    }
+    VkDeviceSize size = sizeof(uint32_t) * (VkDeviceSize)scene->width * scene->height;
+    GpuBuffer readback;
+    if (create_gpu_buffer(vk, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &readback) != 0)
+        return 1;
+
+    // NOTE: every frame leaves the output in TRANSFER_SRC_OPTIMAL
+    VkCommandBuffer commands;
+    int result = begin_once(vk, &commands);
+    if (result == 0) {
+        VkBufferImageCopy region = {
+            .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .imageExtent = {scene->width, scene->height, 1}};
+        vkCmdCopyImageToBuffer(commands, scene->output.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            readback.buffer, 1, &region);
+        VkMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT};
+        vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+            0, 1, &barrier, 0, NULL, 0, NULL);
+        result = end_once(vk, commands);
+    }
+    // R8G8B8A8 is already Image's byte order & rows top to bottom
+    if (result == 0)
+        result = init_image(image, scene->width, scene->height);
+    if (result == 0)
+        memcpy(image->pixels, readback.mapped, size);
+    free_gpu_buffer(vk, &readback);
+    return result;
+}
@@ -0,0 +1,202 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdint.h>
+
+// Vulkan (-lvulkan)
+#include <vulkan/vulkan.h>
+
+#include "bvh.h"
+#include "camera.h"
+#include "cull.h"
+#include "frame_plan.h"
+#include "geometry.h"
+#include "image.h"
+#include "matrix.h"
+#include "packed_vertex.h"
+#include "panini.h"
+
+
+// Vulkan 1.2 w/ a graphics & compute queue; no GPU needed, Mesa's lavapipe will do
+// -- every feature below is required; lavapipe has them all
+//    multiDrawIndirect: 1 indirect draw per LOD of every mesh, in 1 call
+//    multiViewport & shaderOutputViewportIndex: 1 scissor per cube face
+//    shaderOutputLayer: cube face from the vertex shader; no geometry shader
+//    shaderCullDistance: per face frustum culling, like the GL cube pass
+typedef struct VulkanContext_s {
+    VkInstance        instance;
+    VkPhysicalDevice  physical_device;
+    VkDevice          device;
+    uint32_t          queue_family;  // graphics & compute; & present, w/ a surface
+    VkQueue           queue;
+    VkPhysicalDeviceProperties        properties;
+    VkPhysicalDeviceMemoryProperties  memory;
+    VkCommandPool     pool;  // reset per command buffer; frames are re-recorded on resize
+    VkFormat          depth_format;
+} VulkanContext;
+
+
+// 1 allocation per buffer; there are only a handful
+typedef struct GpuBuffer_s {
+    VkBuffer        buffer;
+    VkDeviceMemory  memory;
+    VkDeviceSize    size;
+    void           *mapped;  // host visible buffers only; mapped for their lifetime
+} GpuBuffer;
+
+
+typedef struct GpuImage_s {
+    VkImage         image;
+    VkDeviceMemory  memory;
+    VkImageView     view;
+} GpuImage;
+
+
+// layered cube map render target; all 6 faces in 1 framebuffer
+typedef struct CubeTarget_s {
+    int            size;  // of each face, in pixels
+    GpuImage       colour;  // R8G8B8A8_UNORM; view is VK_IMAGE_VIEW_TYPE_CUBE, for sampling
+    VkImageView    layers;  // 2D_ARRAY view of colour, for the framebuffer
+    GpuImage       depth;   // 6 layers of VulkanContext.depth_format
+    VkFramebuffer  framebuffer;  // 6 layers; gl_Layer picks the face
+} CubeTarget;
+
+
+// per frame shader inputs; uniform binding 0 of the scene set
+// NOTE: std140; keep in sync w/ the Frame block in shaders/vulkan/cube.vert.glsl
+typedef struct FrameUniforms_s {
+    // world -> clip, per CubeFace
+    // NOTE: Vulkan clip z ([0, w]); cube_frusta still takes FrameViews' GL ones
+    Mat4   face_view_projection[6];
+    // PACKED_VERTEX position decode; Scene.vertex_bounds
+    float  position_offset[4];
+    float  position_scale[4];
+} FrameUniforms;
+
+
+// frames the CPU can get ahead of the GPU before begin_frame waits
+#define FRAME_LATENCY  3
+
+
+// everything 1 frame writes on the CPU, FRAME_LATENCY times over
+// -- each slot: FrameUniforms, then 1 indirect command per LOD, then the
+//    visible (instance, face) entries those commands draw (vertex binding 1)
+// -- a fence per slot says when the GPU is done w/ it & its command buffer
+// NOTE: every slot's command buffer is recorded once & only ever resubmitted;
+//       frames change what's in the slot, never the commands
+typedef struct FrameRing_s {
+    GpuBuffer        buffer;  // host visible & coherent; no flushes
+    VkDeviceSize     stride;  // between slots; minUniformBufferOffsetAlignment
+    VkDeviceSize     draws_offset;    // within a slot; after FrameUniforms
+    VkDeviceSize     entries_offset;  // within a slot; after the draws
+    VkCommandBuffer  commands[FRAME_LATENCY];
+    VkFence          fences[FRAME_LATENCY];  // signalled once the slot's frame is done
+    VkSemaphore      acquired[FRAME_LATENCY];  // swapchain image ready; windowed only
+    int64_t          frames[FRAME_LATENCY];  // number of the frame in each slot; -1 if none yet
+    int              slot;  // being written this frame
+    int64_t          frame;  // from 0; the next frame draw_scene submits
+    uint64_t         num_waits;  // frames that had to wait for the GPU
+} FrameRing;
+
+
+// presentation; the reprojection's output is blitted to whichever image is acquired
+typedef struct Swapchain_s {
+    VkSurfaceKHR     surface;  // owned by the window; not destroyed w/ the swapchain
+    VkSwapchainKHR   swapchain;
+    VkFormat         format;
+    VkExtent2D       extent;
+    uint32_t         num_images;
+    VkImage         *images;
+    VkSemaphore     *rendered;  // per image; the blit to it is done
+    VkCommandBuffer *blits;     // per image, pre-recorded; output -> image, ready to present
+    uint32_t         image;     // acquired this frame
+    bool             stale;     // out of date or suboptimal; rebuild before the next frame
+} Swapchain;
+
+
+// timestamps per slot: frame start, cube pass done & reprojection done
+#define GPU_TIMESTAMPS  3
+
+
+// bucket of Vulkan state for rendering
+// NOTE: the cube path only; the direct (tessellated) path is GL only for now
+typedef struct Scene_s {
+    // data references
+    // -- every mesh shares 1 vertex & 1 index buffer; 1 indirect command per LOD
+    int           num_indices;  // every LOD of every mesh, once
+    VkIndexType   index_type;   // UINT16 if every mesh's indices fit, else UINT32
+    VertexFormat  vertex_format;  // set before populate & init_scene_pipelines
+    VertexBounds  vertex_bounds;  // VERTEX_PACKED only; every mesh
+    VkDrawIndexedIndirectCommand  *draws;  // frame_plan.num_levels; every instance, for reference
+    // device buffers
+    GpuBuffer  vertex_buffer;
+    GpuBuffer  index_buffer;
+    GpuBuffer  instance_buffer;  // storage binding 1; Mat4 per instance, grouped by mesh
+    // instances, LODs & culling; shared w/ render_gl.c
+    FramePlan  frame_plan;
+    // per frame
+    Camera     camera;
+    FrameRing  frames;
+    // cube pass; scene -> cube map in 1 indirect draw
+    CubeTarget    cube;
+    CubePlan      cube_plan;
+    VkRenderPass  cube_pass;
+    VkPipeline    cube_pipeline;
+    VkPipelineLayout       scene_layout;
+    VkDescriptorSetLayout  scene_set_layout;
+    VkDescriptorSet        scene_set;  // frame uniforms (dynamic offset per slot) & instances
+    // reprojection pass; cube map -> output, 1 compute invocation per pixel
+    PaniniParams  panini;
+    GpuImage      output;  // R8G8B8A8_UNORM storage image; rows top to bottom
+    VkSampler     cube_sampler;
+    VkPipeline    panini_pipeline;
+    VkPipelineLayout       panini_layout;  // + push constant: d, compression, half width & height
+    VkDescriptorSetLayout  panini_set_layout;
+    VkDescriptorSet        panini_set;  // cube & output
+    VkDescriptorPool       descriptor_pool;
+    // GPU timings; GPU_TIMESTAMPS per slot, read once the slot's fence is signalled
+    VkQueryPool  timestamps;  // VK_NULL_HANDLE if the queue can't time
+    int64_t      gpu_frame;   // frame gpu_ms belongs to; -1 until the 1st is read
+    double       gpu_ms[2];   // cube & reprojection
+    // output
+    Swapchain  *swapchain;  // NULL to render offscreen only
+    int         width;
+    int         height;
+    bool        recorded;  // frames.commands match the cube plan, output & swapchain
+} Scene;
+
+
+// instance w/ the surface extensions the window needs; none for headless
+int init_vulkan(VulkanContext *vk, uint32_t num_extensions, const char* const* extensions);
+// picks the first device w/ every feature above; surface may be VK_NULL_HANDLE
+int init_vulkan_device(VulkanContext *vk, VkSurfaceKHR surface);
+// NOTE: destroy the surface before this; the device & instance go w/ it
+void free_vulkan(VulkanContext *vk);
+
+int init_swapchain(VulkanContext *vk, Swapchain *swapchain, int width, int height);
+// keeps swapchain->surface; waits for the device to go idle first
+void free_swapchain(VulkanContext *vk, Swapchain *swapchain);
+
+// scene geo
+// -- scene->vertex_format picks the vertex layout; indices shrink to 16 bits if they fit
+// -- uploads through a staging buffer & waits for it; desc can be freed after
+int populate(VulkanContext *vk, Scene *scene, SceneDesc *desc);
+void free_scene_geo(VulkanContext *vk, Scene *scene);
+
+// per frame slots, their command buffers & sync; after populate
+int init_frame_ring(VulkanContext *vk, Scene *scene);
+// render pass, pipelines & descriptors; after init_frame_ring
+// -- SPIR-V from build/vulkan/; see the Makefile
+int init_scene_pipelines(VulkanContext *vk, Scene *scene);
+// everything the init_* above made, & the cube & output targets
+void free_scene(VulkanContext *vk, Scene *scene);
+
+// waits for this frame's slot (FRAME_LATENCY frames ago) & reads its GPU timings
+// -- re-records every slot if the resolution, PaniniParams or swapchain changed
+int begin_frame(VulkanContext *vk, Scene *scene);
+// culls, writes the slot & submits its pre-recorded commands; presents if windowed
+// -- sets swapchain->stale instead of failing if the window changed under it
+int draw_scene(VulkanContext *vk, Scene *scene);
+// the last frame's output; waits for the device to go idle
+// -- image must be unallocated; rows top to bottom
+int read_output(VulkanContext *vk, Scene *scene, Image *image);
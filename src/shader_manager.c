@@ -0,0 +1,522 @@
+// Using C23 Standard
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "file_io.h"
+#include "shader_manager.h"
+
+
+int read_glsl(char* path, GLchar **glsl) {
+    *glsl = NULL;
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {  // most likely file not found
+        fprintf(stderr, "failed to open shader file: %s\n", path);
+        return 0;
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0) {
+        fprintf(stderr, "seek failed: %s\n", path);
+        fclose(file);
+        return 0;
+    }
+    long file_length = ftell(file);
+    if (file_length <= 0) {
+        fprintf(stderr, "shader file is empty: %s\n", path);
+        fclose(file);
+        return 0;
+    } else if (file_length > INT32_MAX) {
+        fprintf(stderr, "shader file is too long: %s (%ld bytes)\n", path, file_length);
+        fclose(file);
+        return 0;
+    }
+
+    rewind(file);
+    *glsl = malloc(file_length);
+    if (*glsl == NULL) {
+        fprintf(stderr, "out of memory reading shader: %s (%ld bytes)\n", path, file_length);
+        fclose(file);
+        return 0;
+    }
+    size_t bytes_read = fread(*glsl, 1, file_length, file);
+    fclose(file);
+
+    if (bytes_read != (size_t)file_length) {
+        fprintf(stderr, "failed to read shader: %s\n", path);
+        free(*glsl);
+        *glsl = NULL;
+        return 0;
+    }
+
+    return (int)file_length;
+}
+
+
+// defines go after the #version line, which must come first
+// -- & after any #extension lines right below it; those can't follow code
+// -- then #line, so compile errors still point at the file's own lines
+// -- *glsl is malloc'd; returns its length, or 0 on failure
+// NOTE: the cache key hashes the injected source, so defines key it too
+static int inject_defines(const GLchar *source, int source_length, char* defines, GLchar **glsl) {
+    const GLchar *version_end = memchr(source, '\n', source_length);
+    if (version_end == NULL || source_length < 8 || strncmp(source, "#version", 8) != 0) {
+        fprintf(stderr, "shader doesn't start w/ #version\n");
+        return 0;
+    }
+    int head_length = version_end + 1 - source;
+    int head_lines = 1;
+    while (source_length - head_length > 10 && strncmp(source + head_length, "#extension", 10) == 0) {
+        const GLchar *extension_end = memchr(source + head_length, '\n', source_length - head_length);
+        if (extension_end == NULL)
+            break;  // no code after it; nothing to go ahead of
+        head_length = extension_end + 1 - source;
+        head_lines++;
+    }
+    char line[32];
+    int line_length = snprintf(line, sizeof(line), "#line %d\n", head_lines + 1);
+    int defines_length = strlen(defines);
+    int length = source_length + defines_length + line_length;
+    *glsl = malloc(length);
+    if (*glsl == NULL) {
+        fprintf(stderr, "out of memory for shader defines\n");
+        return 0;
+    }
+    memcpy(*glsl, source, head_length);
+    memcpy(*glsl + head_length, defines, defines_length);
+    memcpy(*glsl + head_length + defines_length, line, line_length);
+    memcpy(*glsl + head_length + defines_length + line_length, source + head_length, source_length - head_length);
+    return length;
+}
+
+
+static void print_shader_log(GLuint shader) {
+    GLint log_length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+    GLchar *log = (log_length > 0) ? malloc(log_length) : NULL;
+    if (log != NULL) {
+        glGetShaderInfoLog(shader, log_length, NULL, log);
+        fprintf(stderr, "%s\n", log);
+        free(log);
+    }
+}
+
+
+static void print_program_log(GLuint program) {
+    GLint log_length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
+    GLchar *log = (log_length > 0) ? malloc(log_length) : NULL;
+    if (log != NULL) {
+        glGetProgramInfoLog(program, log_length, NULL, log);
+        fprintf(stderr, "%s\n", log);
+        free(log);
+    }
+}
+
+
+int init_shader_manager(ShaderManager *manager, char* cache_dir) {
+    *manager = (ShaderManager){0};
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_separate_shader_objects) {
+        fprintf(stderr, "no separable programs (GL 4.1 or ARB_separate_shader_objects)\n");
+        return 1;
+    }
+    // NOTE: 0xFFFFFFFF lets the driver pick how many threads
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        manager->parallel = true;
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        manager->parallel = true;
+    }
+    // NOTE: drivers w/o any binary formats can't cache at all
+    GLint num_formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+    manager->cache_dir = (num_formats > 0) ? cache_dir : NULL;
+    return 0;
+}
+
+
+void free_shader_manager(ShaderManager *manager) {
+    for (int i = 0; i < manager->num_pipelines; i++)
+        glDeleteProgramPipelines(1, &manager->pipelines[i].pipeline);
+    for (int i = 0; i < manager->num_programs; i++) {
+        glDeleteShader(manager->programs[i].shader);
+        glDeleteProgram(manager->programs[i].program);
+    }
+    free(manager->programs);
+    free(manager->pipelines);
+    *manager = (ShaderManager){0};
+}
+
+
+// GL_*_SHADER_BIT for glUseProgramStages
+static GLbitfield stage_bit(GLenum type) {
+    switch (type) {
+        case GL_VERTEX_SHADER:           return GL_VERTEX_SHADER_BIT;
+        case GL_TESS_CONTROL_SHADER:     return GL_TESS_CONTROL_SHADER_BIT;
+        case GL_TESS_EVALUATION_SHADER:  return GL_TESS_EVALUATION_SHADER_BIT;
+        case GL_GEOMETRY_SHADER:         return GL_GEOMETRY_SHADER_BIT;
+        case GL_FRAGMENT_SHADER:         return GL_FRAGMENT_SHADER_BIT;
+        case GL_COMPUTE_SHADER:          return GL_COMPUTE_SHADER_BIT;
+        default:                         return 0;
+    }
+}
+
+
+// queues 1 stage; returns its index in manager->programs, or -1
+// -- a cached binary is ready at once, anything else starts compiling
+static int add_program(ShaderManager *manager, ShaderStage *stage, char* defines) {
+    GLchar *read = NULL;
+    const GLchar *source = stage->source;
+    int length = stage->length;
+    if (source == NULL) {
+        length = read_glsl(stage->path, &read);
+        if (length == 0)
+            return -1;  // read_glsl prints its own errors
+        source = read;
+    } else if (length <= 0) {
+        fprintf(stderr, "shader source is empty: %s\n", stage->path);
+        return -1;
+    }
+    GLchar *injected = NULL;
+    if (defines != NULL) {
+        length = inject_defines(source, length, defines, &injected);
+        free(read);
+        read = NULL;
+        if (length == 0) {
+            fprintf(stderr, "failed to add defines to shader: %s\n", stage->path);
+            return -1;
+        }
+        source = injected;
+    }
+
+    uint64_t key = shader_cache_key(1, &source, &length);
+    for (int i = 0; i < manager->num_programs; i++) {
+        if (manager->programs[i].key == key && manager->programs[i].type == stage->type) {
+            free(read);
+            free(injected);
+            return i;  // already queued
+        }
+    }
+    if (manager->num_programs == manager->max_programs) {
+        int max_programs = (manager->max_programs > 0) ? manager->max_programs * 2 : 16;
+        ShaderProgram *programs = realloc(manager->programs, sizeof(ShaderProgram) * max_programs);
+        if (programs == NULL) {
+            fprintf(stderr, "out of memory for %d shader programs\n", max_programs);
+            free(read);
+            free(injected);
+            return -1;
+        }
+        manager->programs = programs;
+        manager->max_programs = max_programs;
+    }
+    int index = manager->num_programs++;
+    ShaderProgram *program = &manager->programs[index];
+    *program = (ShaderProgram){
+        .type = stage->type, .path = stage->path, .key = key,
+        .shader = 0, .program = 0, .state = SHADER_COMPILING};
+
+    char cache_path[4096];
+    if (manager->cache_dir != NULL) {
+        snprintf(cache_path, sizeof(cache_path), "%s/%016llX.glbin", manager->cache_dir, (unsigned long long)key);
+        if (load_shader(&program->program, cache_path, key) == 0) {
+            program->state = SHADER_READY;
+            free(read);
+            free(injected);
+            return index;
+        }
+    }
+
+    // cache miss; compile from source
+    // NOTE: w/ parallel compile this returns at once; see poll_shaders
+    program->shader = glCreateShader(stage->type);
+    glShaderSource(program->shader, 1, &source, &length);
+    glCompileShader(program->shader);
+    free(read);
+    free(injected);
+    return index;
+}
+
+
+int add_shader_stage(ShaderManager *manager, ShaderStage *stage, char* defines) {
+    return add_program(manager, stage, defines);
+}
+
+
+int add_shader_pipeline(ShaderManager *manager, int num_stages, ShaderStage *stages, char* defines) {
+    if (num_stages < 1 || num_stages > MAX_SHADER_STAGES) {
+        fprintf(stderr, "pipelines take 1 to %d stages, not %d\n", MAX_SHADER_STAGES, num_stages);
+        return -1;
+    }
+    ShaderPipeline pipeline = {.num_stages = num_stages, .pipeline = 0, .state = SHADER_COMPILING};
+    for (int i = 0; i < num_stages; i++) {
+        pipeline.programs[i] = add_program(manager, &stages[i], defines);
+        if (pipeline.programs[i] == -1)
+            return -1;  // add_program prints its own errors
+    }
+    if (manager->num_pipelines == manager->max_pipelines) {
+        int max_pipelines = (manager->max_pipelines > 0) ? manager->max_pipelines * 2 : 8;
+        ShaderPipeline *pipelines = realloc(manager->pipelines, sizeof(ShaderPipeline) * max_pipelines);
+        if (pipelines == NULL) {
+            fprintf(stderr, "out of memory for %d shader pipelines\n", max_pipelines);
+            return -1;
+        }
+        manager->pipelines = pipelines;
+        manager->max_pipelines = max_pipelines;
+    }
+    manager->pipelines[manager->num_pipelines] = pipeline;
+    return manager->num_pipelines++;
+}
+
+
+// true if the driver is done w/ object; always true w/o parallel compile
+// -- the status queries after this would block otherwise
+static bool shader_done(ShaderManager *manager, GLuint shader) {
+    GLint done = GL_TRUE;
+    if (manager->parallel)
+        glGetShaderiv(shader, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+
+static bool program_done(ShaderManager *manager, GLuint program) {
+    GLint done = GL_TRUE;
+    if (manager->parallel)
+        glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+
+static void poll_program(ShaderManager *manager, ShaderProgram *program) {
+    if (program->state == SHADER_COMPILING) {
+        if (!shader_done(manager, program->shader))
+            return;
+        GLint compiled;
+        glGetShaderiv(program->shader, GL_COMPILE_STATUS, &compiled);
+        if (compiled == GL_FALSE) {
+            fprintf(stderr, "shader failed to compile: %s\n", program->path);
+            print_shader_log(program->shader);
+            program->state = SHADER_FAILED;
+            return;
+        }
+        program->program = glCreateProgram();
+        glProgramParameteri(program->program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        // NOTE: some drivers only keep the binary around if asked before linking
+        glProgramParameteri(program->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glAttachShader(program->program, program->shader);
+        glLinkProgram(program->program);
+        program->state = SHADER_LINKING;
+    }
+    if (program->state == SHADER_LINKING) {
+        if (!program_done(manager, program->program))
+            return;
+        GLint is_linked;
+        glGetProgramiv(program->program, GL_LINK_STATUS, &is_linked);
+        if (is_linked != GL_TRUE) {
+            fprintf(stderr, "shader program failed to link: %s\n", program->path);
+            print_program_log(program->program);
+            program->state = SHADER_FAILED;
+            return;
+        }
+        glDetachShader(program->program, program->shader);
+        glDeleteShader(program->shader);
+        program->shader = 0;
+        program->state = SHADER_READY;
+
+        // NOTE: a failed cache write only costs us the next cold start
+        if (manager->cache_dir != NULL) {
+            char cache_path[4096];
+            snprintf(cache_path, sizeof(cache_path), "%s/%016llX.glbin", manager->cache_dir, (unsigned long long)program->key);
+            cache_shader(&program->program, cache_path, program->key);
+        }
+    }
+}
+
+
+static void poll_pipeline(ShaderManager *manager, ShaderPipeline *pipeline) {
+    for (int i = 0; i < pipeline->num_stages; i++) {
+        ShaderState state = manager->programs[pipeline->programs[i]].state;
+        if (state == SHADER_FAILED) {
+            pipeline->state = SHADER_FAILED;
+            return;
+        } else if (state != SHADER_READY) {
+            return;  // still compiling or linking
+        }
+    }
+    // NOTE: not glCreateProgramPipelines; that's GL 4.5 (ARB_direct_state_access)
+    // -- glUseProgramStages creates the pipeline object behind a generated name
+    glGenProgramPipelines(1, &pipeline->pipeline);
+    for (int i = 0; i < pipeline->num_stages; i++) {
+        ShaderProgram *program = &manager->programs[pipeline->programs[i]];
+        glUseProgramStages(pipeline->pipeline, stage_bit(program->type), program->program);
+    }
+    // NOTE: catches stages whose interfaces don't match
+    glValidateProgramPipeline(pipeline->pipeline);
+    GLint is_valid;
+    glGetProgramPipelineiv(pipeline->pipeline, GL_VALIDATE_STATUS, &is_valid);
+    if (is_valid != GL_TRUE) {
+        fprintf(stderr, "invalid shader pipeline: %s ...\n", manager->programs[pipeline->programs[0]].path);
+        GLint log_length = 0;
+        glGetProgramPipelineiv(pipeline->pipeline, GL_INFO_LOG_LENGTH, &log_length);
+        GLchar *log = (log_length > 0) ? malloc(log_length) : NULL;
+        if (log != NULL) {
+            glGetProgramPipelineInfoLog(pipeline->pipeline, log_length, NULL, log);
+            fprintf(stderr, "%s\n", log);
+            free(log);
+        }
+        glDeleteProgramPipelines(1, &pipeline->pipeline);
+        pipeline->pipeline = 0;
+        pipeline->state = SHADER_FAILED;
+        return;
+    }
+    pipeline->state = SHADER_READY;
+}
+
+
+int poll_shaders(ShaderManager *manager) {
+    for (int i = 0; i < manager->num_programs; i++)
+        poll_program(manager, &manager->programs[i]);
+    int num_pending = 0;
+    for (int i = 0; i < manager->num_pipelines; i++) {
+        ShaderPipeline *pipeline = &manager->pipelines[i];
+        if (pipeline->state == SHADER_COMPILING)
+            poll_pipeline(manager, pipeline);
+        num_pending += pipeline->state == SHADER_COMPILING;
+    }
+    return num_pending;
+}
+
+
+GLuint shader_pipeline(ShaderManager *manager, int pipeline) {
+    if (pipeline < 0 || pipeline >= manager->num_pipelines)
+        return 0;
+    return manager->pipelines[pipeline].pipeline;
+}
+
+
+GLuint shader_program(ShaderManager *manager, int pipeline, GLenum type) {
+    if (shader_pipeline(manager, pipeline) == 0)
+        return 0;
+    ShaderPipeline *p = &manager->pipelines[pipeline];
+    for (int i = 0; i < p->num_stages; i++) {
+        ShaderProgram *program = &manager->programs[p->programs[i]];
+        if (program->type == type)
+            return program->program;
+    }
+    return 0;
+}
+
+
+uint64_t shader_cache_key(int num_sources, const GLchar** sources, const int* lengths) {
+    uint64_t key = FNV_OFFSET_BASIS;
+    for (int i = 0; i < num_sources; i++) {
+        key = fnv1a_64(sources[i], lengths[i], key);
+        key = fnv1a_64("\0", 1, key);  // "ab" + "c" != "a" + "bc"
+    }
+    // binaries are only valid for the driver that made them
+    GLenum driver_strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    for (int i = 0; i < 3; i++) {
+        const char *string = (const char*)glGetString(driver_strings[i]);
+        if (string != NULL)
+            key = fnv1a_64(string, strlen(string), key);
+        key = fnv1a_64("\0", 1, key);
+    }
+    return key;
+}
+
+
+int cache_shader(GLuint *program, char* path, uint64_t key) {
+    GLint bin_size = 0;
+    glGetProgramiv(*program, GL_PROGRAM_BINARY_LENGTH, &bin_size);
+    if (bin_size <= 0) {
+        fprintf(stderr, "driver has no binary for this program\n");
+        return 1;
+    }
+
+    uint8_t *bin = malloc(bin_size);
+    if (bin == NULL) {
+        fprintf(stderr, "out of memory caching shader: %d bytes\n", bin_size);
+        return 2;
+    }
+    ShaderCacheHeader header = {
+        .magic = SHADER_CACHE_MAGIC,
+        .version = SHADER_CACHE_VERSION,
+        .key = key,
+        .format = 0,
+        .length = 0};
+    glGetProgramBinary(*program, bin_size, &header.length, &header.format, bin);
+
+    if (header.length <= 0) {
+        fprintf(stderr, "glGetProgramBinary failed\n");
+        free(bin);
+        return 1;
+    }
+
+    // write to a temp file & rename, so a crash never leaves a torn binary
+    char temp_path[4096];
+    if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", path) >= (int)sizeof(temp_path)) {
+        fprintf(stderr, "shader cache path is too long: %s\n", path);
+        free(bin);
+        return 3;
+    }
+    FILE *bin_file = fopen(temp_path, "wb");
+    if (bin_file == NULL) {
+        fprintf(stderr, "failed to open shader cache for writing: %s\n", temp_path);
+        free(bin);
+        return 3;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, bin_file) == 1
+        && fwrite(bin, 1, header.length, bin_file) == (size_t)header.length;
+    if (fclose(bin_file) != 0)
+        written = false;
+    free(bin);
+
+    if (!written || rename(temp_path, path) != 0) {
+        fprintf(stderr, "failed to write shader cache: %s\n", path);
+        remove(temp_path);
+        return 4;
+    }
+    return 0;
+}
+
+
+int load_shader(GLuint *program, char* path, uint64_t key) {
+    int64_t  mtime;
+    uint64_t size;
+    if (file_info(path, &mtime, &size) != 0)
+        return 1;  // not cached yet
+
+    MappedFile file;
+    if (map_file(path, &file) != 0)
+        return 1;
+
+    ShaderCacheHeader header;
+    if (file.length < sizeof(header)) {
+        unmap_file(&file);
+        return 2;  // truncated
+    }
+    memcpy(&header, file.data, sizeof(header));
+    if (header.magic != SHADER_CACHE_MAGIC
+     || header.version != SHADER_CACHE_VERSION
+     || header.key != key
+     || header.length <= 0
+     || (size_t)header.length != file.length - sizeof(header)) {
+        unmap_file(&file);
+        return 3;  // stale or corrupt
+    }
+
+    // NOTE: set before the binary, in case the driver doesn't keep it
+    *program = glCreateProgram();
+    glProgramParameteri(*program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glProgramBinary(*program, header.format, file.data + sizeof(header), header.length);
+    unmap_file(&file);
+
+    // NOTE: drivers can reject binaries for any reason (e.g. updates)
+    GLint is_linked = GL_FALSE;
+    glGetProgramiv(*program, GL_LINK_STATUS, &is_linked);
+    if (is_linked != GL_TRUE) {
+        glDeleteProgram(*program);
+        *program = 0;
+        return 4;  // rejected by the driver
+    }
+    return 0;
+}
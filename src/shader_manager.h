@@ -0,0 +1,120 @@
+// Using C23 Standard
+#pragma once
+
+#include <stdint.h>
+
+// GLEW (-lGLEW)
+#include <GL/glew.h>
+
+// OpenGL (-lGL)
+#include <GL/gl.h>
+
+
+// program binary cache file
+// -- ShaderCacheHeader, then length bytes of driver specific binary
+// NOTE: 1 file per stage; every cached program is separable
+#define SHADER_CACHE_MAGIC    0x42535050  // "PPSB"
+#define SHADER_CACHE_VERSION  2
+
+
+typedef struct ShaderCacheHeader_s {
+    uint32_t  magic;
+    uint32_t  version;
+    uint64_t  key;  // see shader_cache_key
+    GLenum    format;
+    GLsizei   length;
+} ShaderCacheHeader;
+
+
+#define MAX_SHADER_STAGES  5
+
+
+typedef struct ShaderStage_s {
+    GLenum  type;  // GL_VERTEX_SHADER etc.
+    char   *path;
+    // already in memory (e.g. from a Loader); NULL to read path
+    // -- path still names the stage in errors
+    const GLchar  *source;
+    int            length;
+} ShaderStage;
+
+
+// shader manager
+// -- every stage is its own separable program (ARB_separate_shader_objects),
+//    compiled & linked once, then shared by any number of program pipelines;
+//    e.g. 1 clay.frag.glsl behind the cube, geometry shader & direct paths
+// -- every compile is submitted up front; w/ KHR or ARB_parallel_shader_compile
+//    the driver compiles on its own threads & poll_shaders never blocks
+// NOTE: stages redeclare gl_PerVertex & give every varying a location,
+//       so stages linked apart still match
+typedef enum ShaderState_e {
+    SHADER_COMPILING,
+    SHADER_LINKING,
+    SHADER_READY,
+    SHADER_FAILED,
+} ShaderState;
+
+
+// 1 separable, single stage program
+typedef struct ShaderProgram_s {
+    GLenum       type;
+    char        *path;  // for errors
+    uint64_t     key;   // shader_cache_key of the source, defines & all
+    GLuint       shader;  // until linked
+    GLuint       program;
+    ShaderState  state;
+} ShaderProgram;
+
+
+typedef struct ShaderPipeline_s {
+    int          num_stages;
+    int          programs[MAX_SHADER_STAGES];  // into ShaderManager.programs
+    GLuint       pipeline;  // 0 until every program is ready
+    ShaderState  state;
+} ShaderPipeline;
+
+
+typedef struct ShaderManager_s {
+    bool   parallel;   // poll GL_COMPLETION_STATUS_KHR instead of blocking
+    char  *cache_dir;  // NULL if not caching binaries
+    int    num_programs;
+    int    max_programs;
+    ShaderProgram   *programs;
+    int    num_pipelines;
+    int    max_pipelines;
+    ShaderPipeline  *pipelines;
+} ShaderManager;
+
+
+// cache_dir may be NULL to always compile
+// NOTE: needs a current context; GL 4.1 or ARB_separate_shader_objects
+// -- nothing in here needs more; e.g. pipelines come from glGenProgramPipelines
+int init_shader_manager(ShaderManager *manager, char* cache_dir);
+// deletes every program & pipeline
+void free_shader_manager(ShaderManager *manager);
+// queues num_stages stages as 1 pipeline; returns its index, or -1
+// -- stages w/ the same source & defines as 1 already queued share its program
+// -- defines are extra lines put after each stage's #version (& #extensions);
+//    NULL for none
+int add_shader_pipeline(ShaderManager *manager, int num_stages, ShaderStage *stages, char* defines);
+// queues 1 stage ahead of its pipeline, e.g. as soon as its source is loaded
+// -- returns its index in manager->programs, or -1
+// -- add_shader_pipeline picks it up again w/ the same source & defines
+int add_shader_stage(ShaderManager *manager, ShaderStage *stage, char* defines);
+// moves compiles, links & pipelines along w/o waiting on the driver
+// -- returns how many pipelines are still pending; 0 once all are ready or failed
+int poll_shaders(ShaderManager *manager);
+// 0 if pipeline failed or isn't ready yet
+GLuint shader_pipeline(ShaderManager *manager, int pipeline);
+// the program behind pipeline's type stage; for glProgramUniform* etc.
+GLuint shader_program(ShaderManager *manager, int pipeline, GLenum type);
+
+// GLSL source
+// -- *glsl is malloc'd; returns its length, or 0 on failure
+int read_glsl(char* path, GLchar **glsl);
+// program binary cache
+// -- keyed on the GLSL sources & GL_VENDOR, GL_RENDERER & GL_VERSION
+uint64_t shader_cache_key(int num_sources, const GLchar** sources, const int* lengths);
+int cache_shader(GLuint *program, char* path, uint64_t key);
+// NOTE: the loaded program is separable
+int load_shader(GLuint *program, char* path, uint64_t key);
@@ -0,0 +1,620 @@
+// Using C23 Standard
+// Math (-lm)
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "simplify.h"
+
+
+// NOTE: marks a missing vertex / open edge
+#define NO_VERTEX  UINT32_MAX
+
+
+// -- quadrics --
+
+// sum of w * (n . p + d)^2 over planes; p^T A p + 2 b . p + c
+// NOTE: doubles; long collapse chains sum many nearly cancelling planes
+typedef struct Quadric_s {
+    double  a00, a11, a22, a10, a20, a21;
+    double  b0, b1, b2;
+    double  c;
+    double  weight;  // sum of w; errors are averaged over it
+} Quadric;
+
+
+static void add_plane(Quadric *q, Vec3 n, double d, double w) {
+    q->a00 += w * n.x * n.x;
+    q->a11 += w * n.y * n.y;
+    q->a22 += w * n.z * n.z;
+    q->a10 += w * n.y * n.x;
+    q->a20 += w * n.z * n.x;
+    q->a21 += w * n.z * n.y;
+    q->b0 += w * n.x * d;
+    q->b1 += w * n.y * d;
+    q->b2 += w * n.z * d;
+    q->c += w * d * d;
+    q->weight += w;
+}
+
+
+static void add_quadric(Quadric *q, const Quadric *other) {
+    q->a00 += other->a00;
+    q->a11 += other->a11;
+    q->a22 += other->a22;
+    q->a10 += other->a10;
+    q->a20 += other->a20;
+    q->a21 += other->a21;
+    q->b0 += other->b0;
+    q->b1 += other->b1;
+    q->b2 += other->b2;
+    q->c += other->c;
+    q->weight += other->weight;
+}
+
+
+// unweighted sum of squared distances
+static double quadric_error(const Quadric *q, Vec3 p) {
+    double x = p.x, y = p.y, z = p.z;
+    double error = q->a00 * x * x + q->a11 * y * y + q->a22 * z * z
+                 + 2.0 * (q->a10 * x * y + q->a20 * x * z + q->a21 * y * z)
+                 + 2.0 * (q->b0 * x + q->b1 * y + q->b2 * z) + q->c;
+    return (error > 0.0) ? error : 0.0;  // rounding
+}
+
+
+// NOTE: vector.c isn't in OBJSRC; see optimise.c
+static Vec3 sub3(Vec3 a, Vec3 b) {
+    return (Vec3){a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+
+static Vec3 cross3(Vec3 a, Vec3 b) {
+    return (Vec3){a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+
+static float dot3(Vec3 a, Vec3 b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+
+// -- vertex classes --
+
+// what a position may collapse onto; see can_collapse
+typedef enum VertexKind_e {
+    KIND_MANIFOLD,  // 1 vertex, no open edges; anywhere
+    KIND_BORDER,    // 1 vertex on 1 open border; only along the border
+    KIND_SEAM,      // 2 vertices w/ 1 seam between them; only along the seam
+    KIND_LOCKED,    // corners, seam junctions & anything non-manifold; never
+} VertexKind;
+
+
+typedef struct Simplifier_s {
+    Geometry  *geo;
+    int        num_vertices;
+    uint32_t  *position_ids;  // first vertex w/ the same position
+    uint32_t  *wedges;  // next vertex w/ the same position; a ring
+    uint8_t   *kinds;   // VertexKind, per vertex
+    uint32_t  *open_out;  // v -> w w/ no w -> v, if v has exactly 1; else NO_VERTEX
+    uint32_t  *open_in;   // w -> v w/ no v -> w, ditto
+    Quadric   *quadrics;  // per position id
+    // rebuilt every pass; triangles & outgoing edges around each vertex
+    int       *offsets;  // num_vertices + 1
+    int       *counts;
+    uint32_t  *triangles;  // triangle index per corner
+    uint32_t  *edges;  // next vertex around each corner's triangle
+} Simplifier;
+
+
+static Vec3 position(Simplifier *s, uint32_t v) {
+    return s->geo->vertices[v].position;
+}
+
+
+static bool has_edge(Simplifier *s, uint32_t a, uint32_t b) {
+    for (int i = s->offsets[a]; i < s->offsets[a + 1]; i++) {
+        if (s->edges[i] == b)
+            return true;
+    }
+    return false;
+}
+
+
+// a -> b in position space; any vertex at a to any vertex at b
+static bool has_position_edge(Simplifier *s, uint32_t a, uint32_t b) {
+    uint32_t b_id = s->position_ids[b];
+    uint32_t w = a;
+    do {
+        for (int i = s->offsets[w]; i < s->offsets[w + 1]; i++) {
+            if (s->position_ids[s->edges[i]] == b_id)
+                return true;
+        }
+        w = s->wedges[w];
+    } while (w != a);
+    return false;
+}
+
+
+static void build_adjacency(Simplifier *s, uint32_t *indices, int num_indices) {
+    memset(s->counts, 0, sizeof(int) * s->num_vertices);
+    for (int i = 0; i < num_indices; i++)
+        s->counts[indices[i]]++;
+    s->offsets[0] = 0;
+    for (int v = 0; v < s->num_vertices; v++)
+        s->offsets[v + 1] = s->offsets[v] + s->counts[v];
+    // NOTE: counts doubles as the fill cursor
+    memcpy(s->counts, s->offsets, sizeof(int) * s->num_vertices);
+    for (int i = 0; i < num_indices; i++) {
+        uint32_t v = indices[i];
+        int corner = s->counts[v]++;
+        int t = i / 3;
+        s->triangles[corner] = t;
+        s->edges[corner] = indices[t * 3 + (i + 1) % 3];
+    }
+}
+
+
+// NOTE: bitwise; -0.0 & +0.0 are different positions, like welding in read_obj
+static uint32_t hash_position(Vec3 p) {
+    uint32_t bits[3];
+    memcpy(bits, &p, sizeof(bits));
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 3; i++)
+        hash = (hash ^ bits[i]) * 16777619u;
+    return hash;
+}
+
+
+static int find_positions(Simplifier *s, Arena *scratch) {
+    int num_slots = 1;
+    while (num_slots < s->num_vertices * 2)
+        num_slots <<= 1;
+    uint32_t *slots = arena_alloc(scratch, sizeof(uint32_t) * num_slots);
+    if (slots == NULL)
+        return 1;
+    memset(slots, 0xFF, sizeof(uint32_t) * num_slots);
+    for (int v = 0; v < s->num_vertices; v++) {
+        Vec3 p = position(s, v);
+        uint32_t slot = hash_position(p) & (num_slots - 1);
+        while (slots[slot] != NO_VERTEX && memcmp(&s->geo->vertices[slots[slot]].position, &p, sizeof(Vec3)) != 0)
+            slot = (slot + 1) & (num_slots - 1);
+        if (slots[slot] == NO_VERTEX) {
+            slots[slot] = v;
+            s->position_ids[v] = v;
+            s->wedges[v] = v;
+        } else {
+            // insert after the first vertex in the ring
+            uint32_t first = slots[slot];
+            s->position_ids[v] = first;
+            s->wedges[v] = s->wedges[first];
+            s->wedges[first] = v;
+        }
+    }
+    return 0;
+}
+
+
+static void classify_vertices(Simplifier *s) {
+    // open edges per vertex
+    for (int v = 0; v < s->num_vertices; v++)
+        s->open_out[v] = s->open_in[v] = NO_VERTEX;
+    int *num_open_in = s->counts;  // NOTE: free until the next build_adjacency
+    memset(num_open_in, 0, sizeof(int) * s->num_vertices);
+    uint8_t *num_open_out = s->kinds;  // NOTE: overwritten below
+    memset(num_open_out, 0, s->num_vertices);
+    for (int v = 0; v < s->num_vertices; v++) {
+        for (int i = s->offsets[v]; i < s->offsets[v + 1]; i++) {
+            uint32_t w = s->edges[i];
+            if (has_edge(s, w, v))
+                continue;
+            s->open_out[v] = w;
+            s->open_in[w] = v;
+            num_open_out[v] = (num_open_out[v] < 255) ? num_open_out[v] + 1 : 255;
+            num_open_in[w]++;
+        }
+    }
+    for (int v = 0; v < s->num_vertices; v++) {
+        if (num_open_out[v] != 1)
+            s->open_out[v] = NO_VERTEX;
+        if (num_open_in[v] != 1)
+            s->open_in[v] = NO_VERTEX;
+    }
+
+    // per position; every vertex at a position gets the same kind
+    for (int v = 0; v < s->num_vertices; v++) {
+        if (s->position_ids[v] != (uint32_t)v)
+            continue;
+        uint32_t wedge = s->wedges[v];
+        int num_wedges = 1;
+        for (uint32_t w = wedge; w != (uint32_t)v; w = s->wedges[w])
+            num_wedges++;
+        VertexKind kind = KIND_LOCKED;
+        if (num_wedges == 1) {
+            if (num_open_out[v] == 0 && num_open_in[v] == 0) {
+                kind = KIND_MANIFOLD;
+            } else if (s->open_out[v] != NO_VERTEX && s->open_in[v] != NO_VERTEX
+                    && !has_position_edge(s, s->open_out[v], v)
+                    && !has_position_edge(s, v, s->open_in[v])) {
+                kind = KIND_BORDER;
+            }
+        } else if (num_wedges == 2) {
+            // both sides of 1 seam; each open edge has a twin on the other side
+            bool seam = true;
+            uint32_t w = v;
+            do {
+                seam = seam && s->open_out[w] != NO_VERTEX && s->open_in[w] != NO_VERTEX
+                    && has_position_edge(s, s->open_out[w], w)
+                    && has_position_edge(s, w, s->open_in[w]);
+                w = s->wedges[w];
+            } while (w != (uint32_t)v);
+            kind = seam ? KIND_SEAM : KIND_LOCKED;
+        }
+        uint32_t w = v;
+        do {
+            s->kinds[w] = kind;
+            w = s->wedges[w];
+        } while (w != (uint32_t)v);
+    }
+}
+
+
+static void build_quadrics(Simplifier *s, uint32_t *indices, int num_indices) {
+    memset(s->quadrics, 0, sizeof(Quadric) * s->num_vertices);
+    for (int t = 0; t < num_indices; t += 3) {
+        Vec3 p[3];
+        for (int i = 0; i < 3; i++)
+            p[i] = position(s, indices[t + i]);
+        Vec3 n = cross3(sub3(p[1], p[0]), sub3(p[2], p[0]));
+        float length = sqrtf(dot3(n, n));
+        if (length == 0.0f)
+            continue;
+        n = (Vec3){n.x / length, n.y / length, n.z / length};
+        double area = 0.5 * length;
+        for (int i = 0; i < 3; i++)
+            add_plane(&s->quadrics[s->position_ids[indices[t + i]]], n, -dot3(n, p[0]), area);
+
+        // open edges (borders & seams) hold on to the plane through them,
+        // perpendicular to the surface
+        for (int i = 0; i < 3; i++) {
+            uint32_t a = indices[t + i];
+            uint32_t b = indices[t + (i + 1) % 3];
+            if (has_edge(s, b, a))
+                continue;
+            Vec3 edge = sub3(p[(i + 1) % 3], p[i]);
+            Vec3 side = cross3(edge, n);
+            float side_length = sqrtf(dot3(side, side));
+            if (side_length == 0.0f)
+                continue;
+            side = (Vec3){side.x / side_length, side.y / side_length, side.z / side_length};
+            double w = SIMPLIFY_BORDER_WEIGHT * dot3(edge, edge);
+            add_plane(&s->quadrics[s->position_ids[a]], side, -dot3(side, p[i]), w);
+            add_plane(&s->quadrics[s->position_ids[b]], side, -dot3(side, p[i]), w);
+        }
+    }
+}
+
+
+// -- collapses --
+
+typedef struct Collapse_s {
+    uint32_t  from;  // removed
+    uint32_t  to;
+    float     cost;  // mean squared distance
+} Collapse;
+
+
+static int compare_collapses(const void *a, const void *b) {
+    const Collapse *x = a;
+    const Collapse *y = b;
+    if (x->cost != y->cost)
+        return (x->cost < y->cost) ? -1 : 1;
+    return (x->from < y->from) ? -1 : (x->from > y->from);
+}
+
+
+// edge between 2 vertices on the same border or seam, in either direction
+static bool on_open_edge(Simplifier *s, uint32_t a, uint32_t b) {
+    return s->open_out[a] == b || s->open_in[a] == b;
+}
+
+
+// the vertex on the other side of a's seam that b's twin is
+static uint32_t seam_twin(Simplifier *s, uint32_t a, uint32_t b) {
+    uint32_t twin = s->wedges[a];
+    uint32_t b_id = s->position_ids[b];
+    if (s->open_out[twin] != NO_VERTEX && s->position_ids[s->open_out[twin]] == b_id)
+        return s->open_out[twin];
+    if (s->open_in[twin] != NO_VERTEX && s->position_ids[s->open_in[twin]] == b_id)
+        return s->open_in[twin];
+    return NO_VERTEX;
+}
+
+
+static bool can_collapse(Simplifier *s, uint32_t from, uint32_t to) {
+    VertexKind from_kind = s->kinds[from];
+    VertexKind to_kind = s->kinds[to];
+    switch (from_kind) {
+        case KIND_MANIFOLD:
+            return true;
+        case KIND_BORDER:
+            return (to_kind == KIND_BORDER || to_kind == KIND_LOCKED) && on_open_edge(s, from, to);
+        case KIND_SEAM:
+            return (to_kind == KIND_SEAM || to_kind == KIND_LOCKED) && on_open_edge(s, from, to)
+                && seam_twin(s, from, to) != NO_VERTEX;
+        default:
+            return false;
+    }
+}
+
+
+static float collapse_cost(Simplifier *s, uint32_t from, uint32_t to) {
+    Quadric q = s->quadrics[s->position_ids[from]];
+    add_quadric(&q, &s->quadrics[s->position_ids[to]]);
+    return (q.weight > 0.0) ? (float)(quadric_error(&q, position(s, to)) / q.weight) : 0.0f;
+}
+
+
+// would moving from onto to turn any triangle around from over (or close to it)?
+// -- collapse_remap has this pass's earlier collapses
+static bool flips_triangles(Simplifier *s, uint32_t *indices, uint32_t *collapse_remap, uint32_t from, uint32_t to) {
+    uint32_t to_id = s->position_ids[to];
+    Vec3 to_position = position(s, to);
+    uint32_t w = from;
+    do {
+        for (int i = s->offsets[w]; i < s->offsets[w + 1]; i++) {
+            uint32_t *triangle = &indices[s->triangles[i] * 3];
+            Vec3 before[3];
+            Vec3 after[3];
+            bool removed = false;
+            for (int j = 0; j < 3; j++) {
+                uint32_t v = collapse_remap[triangle[j]];
+                removed = removed || s->position_ids[v] == to_id;
+                before[j] = position(s, v);
+                after[j] = (s->position_ids[v] == s->position_ids[from]) ? to_position : before[j];
+            }
+            if (removed)
+                continue;  // has the collapsed edge; gone after
+            Vec3 n0 = cross3(sub3(before[1], before[0]), sub3(before[2], before[0]));
+            Vec3 n1 = cross3(sub3(after[1], after[0]), sub3(after[2], after[0]));
+            // NOTE: also rejects turns of more than ~75deg; slivers on their way to flipping
+            if (dot3(n0, n1) <= 0.25f * sqrtf(dot3(n0, n0) * dot3(n1, n1)))
+                return true;
+        }
+        w = s->wedges[w];
+    } while (w != from);
+    return false;
+}
+
+
+// link condition (Dey et al. 1999); from & to may only share the neighbours
+// opposite their edge. otherwise the collapse folds the surface onto itself
+// -- marks: per position id; stamps must be new for every call
+static bool breaks_link(Simplifier *s, uint32_t *indices, uint32_t *collapse_remap, uint32_t from, uint32_t to,
+                        uint32_t *marks, uint32_t stamp) {
+    uint32_t from_id = s->position_ids[from];
+    uint32_t to_id = s->position_ids[to];
+    // stamp: around from
+    uint32_t w = from;
+    do {
+        for (int i = s->offsets[w]; i < s->offsets[w + 1]; i++) {
+            uint32_t *triangle = &indices[s->triangles[i] * 3];
+            for (int j = 0; j < 3; j++)
+                marks[s->position_ids[collapse_remap[triangle[j]]]] = stamp;
+        }
+        w = s->wedges[w];
+    } while (w != from);
+    // stamp + 1: around both; counted once each
+    int num_shared = 0;
+    int num_edge_triangles = 0;
+    w = to;
+    do {
+        for (int i = s->offsets[w]; i < s->offsets[w + 1]; i++) {
+            uint32_t *triangle = &indices[s->triangles[i] * 3];
+            bool has_from = false;
+            for (int j = 0; j < 3; j++)
+                has_from = has_from || s->position_ids[collapse_remap[triangle[j]]] == from_id;
+            num_edge_triangles += has_from;
+            for (int j = 0; j < 3; j++) {
+                uint32_t id = s->position_ids[collapse_remap[triangle[j]]];
+                if (id == from_id || id == to_id || marks[id] != stamp)
+                    continue;
+                marks[id] = stamp + 1;
+                num_shared++;
+            }
+        }
+        w = s->wedges[w];
+    } while (w != to);
+    return num_shared > num_edge_triangles;
+}
+
+
+int simplify_mesh(Geometry *geo, uint32_t *indices, int num_indices, int target_indices,
+                  uint32_t *dest, int *num_dest, float *error) {
+    *num_dest = 0;
+    *error = 0.0f;
+    if (num_indices % 3 != 0) {
+        fprintf(stderr, "not a triangle list: %d indices\n", num_indices);
+        return 2;
+    }
+    for (int i = 0; i < num_indices; i++) {
+        if (indices[i] >= (uint32_t)geo->num_vertices) {
+            fprintf(stderr, "index %d out of range: %u >= %d\n", i, indices[i], geo->num_vertices);
+            return 3;
+        }
+    }
+    memcpy(dest, indices, sizeof(uint32_t) * num_indices);
+    *num_dest = num_indices;
+    if (num_indices <= target_indices)
+        return 0;
+
+    int num_vertices = geo->num_vertices;
+    Arena scratch;
+    init_arena(&scratch, 0);
+    Simplifier s = {
+        .geo = geo,
+        .num_vertices = num_vertices,
+        .position_ids = arena_alloc(&scratch, sizeof(uint32_t) * num_vertices),
+        .wedges = arena_alloc(&scratch, sizeof(uint32_t) * num_vertices),
+        .kinds = arena_alloc(&scratch, sizeof(uint8_t) * num_vertices),
+        .open_out = arena_alloc(&scratch, sizeof(uint32_t) * num_vertices),
+        .open_in = arena_alloc(&scratch, sizeof(uint32_t) * num_vertices),
+        .quadrics = arena_alloc(&scratch, sizeof(Quadric) * num_vertices),
+        .offsets = arena_alloc(&scratch, sizeof(int) * (num_vertices + 1)),
+        .counts = arena_alloc(&scratch, sizeof(int) * num_vertices),
+        .triangles = arena_alloc(&scratch, sizeof(uint32_t) * num_indices),
+        .edges = arena_alloc(&scratch, sizeof(uint32_t) * num_indices)};
+    // NOTE: each triangle has 3 edges; at most 1 collapse is kept per edge
+    Collapse *collapses = arena_alloc(&scratch, sizeof(Collapse) * num_indices);
+    uint32_t *collapse_remap = arena_alloc(&scratch, sizeof(uint32_t) * num_vertices);
+    bool *locked = arena_alloc(&scratch, sizeof(bool) * num_vertices);
+    uint32_t *marks = arena_alloc(&scratch, sizeof(uint32_t) * num_vertices);
+    if (s.position_ids == NULL || s.wedges == NULL || s.kinds == NULL || s.open_out == NULL
+     || s.open_in == NULL || s.quadrics == NULL || s.offsets == NULL || s.counts == NULL
+     || s.triangles == NULL || s.edges == NULL || collapses == NULL || collapse_remap == NULL
+     || locked == NULL || marks == NULL || find_positions(&s, &scratch) != 0) {
+        free_arena(&scratch);
+        return 1;  // arena_alloc prints its own errors
+    }
+
+    // NOTE: classified once, on the input; collapses keep kinds valid
+    build_adjacency(&s, dest, num_indices);
+    classify_vertices(&s);
+    build_quadrics(&s, dest, num_indices);
+
+    memset(marks, 0, sizeof(uint32_t) * num_vertices);
+    uint32_t stamp = 1;
+    float max_cost = 0.0f;
+    int count = num_indices;
+    while (count > target_indices) {
+        build_adjacency(&s, dest, count);
+
+        // cheapest legal direction of every edge
+        int num_collapses = 0;
+        for (int i = 0; i < count; i++) {
+            uint32_t a = dest[i];
+            uint32_t b = dest[i - i % 3 + (i + 1) % 3];
+            // NOTE: interior edges show up once per side; keep 1
+            if (a > b && has_edge(&s, b, a))
+                continue;
+            bool ab = can_collapse(&s, a, b);
+            bool ba = can_collapse(&s, b, a);
+            if (!ab && !ba)
+                continue;
+            float cost_ab = ab ? collapse_cost(&s, a, b) : INFINITY;
+            float cost_ba = ba ? collapse_cost(&s, b, a) : INFINITY;
+            collapses[num_collapses++] = (cost_ab <= cost_ba)
+                ? (Collapse){a, b, cost_ab}
+                : (Collapse){b, a, cost_ba};
+        }
+        if (num_collapses == 0)
+            break;
+        qsort(collapses, num_collapses, sizeof(Collapse), compare_collapses);
+
+        // cheapest first; each position takes part in 1 collapse per pass
+        // -- ~2 triangles go per collapse, so stop before overshooting much
+        int goal = (count - target_indices) / 6 + 1;
+        for (int v = 0; v < num_vertices; v++) {
+            collapse_remap[v] = v;
+            locked[v] = false;
+        }
+        int num_done = 0;
+        for (int i = 0; i < num_collapses && num_done < goal; i++) {
+            Collapse *c = &collapses[i];
+            uint32_t from_id = s.position_ids[c->from];
+            uint32_t to_id = s.position_ids[c->to];
+            if (locked[from_id] || locked[to_id])
+                continue;
+            if (flips_triangles(&s, dest, collapse_remap, c->from, c->to))
+                continue;
+            stamp += 2;
+            if (breaks_link(&s, dest, collapse_remap, c->from, c->to, marks, stamp))
+                continue;
+            collapse_remap[c->from] = c->to;
+            if (s.kinds[c->from] == KIND_SEAM) {
+                uint32_t twin = s.wedges[c->from];
+                collapse_remap[twin] = seam_twin(&s, c->from, c->to);
+            }
+            locked[from_id] = locked[to_id] = true;
+            add_quadric(&s.quadrics[to_id], &s.quadrics[from_id]);
+            max_cost = fmaxf(max_cost, c->cost);
+            num_done++;
+        }
+        if (num_done == 0)
+            break;
+
+        // drop triangles w/ a collapsed edge
+        int num_kept = 0;
+        for (int t = 0; t < count; t += 3) {
+            uint32_t a = collapse_remap[dest[t]];
+            uint32_t b = collapse_remap[dest[t + 1]];
+            uint32_t c = collapse_remap[dest[t + 2]];
+            uint32_t a_id = s.position_ids[a];
+            uint32_t b_id = s.position_ids[b];
+            uint32_t c_id = s.position_ids[c];
+            if (a_id == b_id || b_id == c_id || c_id == a_id)
+                continue;
+            dest[num_kept++] = a;
+            dest[num_kept++] = b;
+            dest[num_kept++] = c;
+        }
+        count = num_kept;
+
+        // borders & seams close up over collapsed vertices
+        // NOTE: v == r if the collapse went against the edge's direction
+        for (int v = 0; v < num_vertices; v++) {
+            uint32_t out = s.open_out[v];
+            if (out != NO_VERTEX) {
+                uint32_t r = collapse_remap[out];
+                s.open_out[v] = (r == (uint32_t)v) ? s.open_out[out] : r;
+            }
+            uint32_t in = s.open_in[v];
+            if (in != NO_VERTEX) {
+                uint32_t r = collapse_remap[in];
+                s.open_in[v] = (r == (uint32_t)v) ? s.open_in[in] : r;
+            }
+        }
+    }
+
+    *num_dest = count;
+    *error = sqrtf(max_cost);
+    free_arena(&scratch);
+    return 0;
+}
+
+
+int build_lods(Geometry *geo, int max_lods) {
+    max_lods = (max_lods < MAX_LODS) ? max_lods : MAX_LODS;
+    geo->num_lods = 1;
+    geo->lods[0] = (GeometryLod){.first_index = 0, .num_indices = geo->num_indices, .error = 0.0f};
+    for (int level = 1; level < max_lods; level++) {
+        GeometryLod *last = &geo->lods[level - 1];
+        int target = (int)(last->num_indices / 3 * LOD_REDUCTION) * 3;
+        if (target < 3)
+            break;
+        // NOTE: simplify_mesh copies its input to dest first; room for all of it
+        if (reserve_geometry(geo, 0, last->num_indices) != 0) {
+            fprintf(stderr, "no room for LOD %d: %d indices\n", level, last->num_indices);
+            return 1;
+        }
+        // NOTE: from the last level, not the full mesh; each level halves the work
+        // -- so errors stack up; the sum bounds the distance from the full mesh
+        int num_indices;
+        float error;
+        uint32_t *source = &geo->indices[last->first_index];
+        uint32_t *dest = &geo->indices[geo->num_indices];
+        int result = simplify_mesh(geo, source, last->num_indices, target, dest, &num_indices, &error);
+        if (result != 0)
+            return result;
+        if (num_indices > last->num_indices * LOD_MIN_REDUCTION)
+            break;  // not worth a level
+        geo->lods[level] = (GeometryLod){
+            .first_index = geo->num_indices,
+            .num_indices = num_indices,
+            .error = last->error + error};
+        geo->num_indices += num_indices;
+        geo->num_lods++;
+    }
+    return 0;
+}
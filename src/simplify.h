@@ -0,0 +1,33 @@
+// Using C23 Standard
+#pragma once
+
+#include "geometry.h"
+
+
+// quadric error edge collapse (Garland & Heckbert 1997) & LOD chains
+// -- half edge collapses; vertices are never moved or added, so every level
+//    shares geo's vertex array & keeps its normals & uvs exactly
+// -- UV & normal seams (split vertices at 1 position) & open borders only
+//    collapse along themselves, so they never tear or shrink inwards
+// NOTE: geo must be a triangle list in writeable memory (not a mapped cache)
+
+// each level aims for this fraction of the last level's triangles
+#define LOD_REDUCTION  0.5f
+// a level w/ more than this fraction of the last level's triangles ends the chain
+#define LOD_MIN_REDUCTION  0.8f
+// border & seam planes weigh this much more than surface planes
+#define SIMPLIFY_BORDER_WEIGHT  10.0f
+
+
+// collapse edges of indices[num_indices] until target_indices or fewer are left
+// -- dest gets the triangles left; it must hold num_indices (may not alias indices)
+// -- *error: how far the result strays from the input, in model space units (roughly)
+// NOTE: stops early if every edge left would tear a seam or flip a triangle
+int simplify_mesh(Geometry *geo, uint32_t *indices, int num_indices, int target_indices,
+                  uint32_t *dest, int *num_dest, float *error);
+
+// appends up to max_lods - 1 simplified copies of geo's indices to geo->indices
+// & fills in geo->lods; geo->lods[0] is the full mesh
+// -- each level is simplified from the one before it
+// NOTE: geo->num_indices covers every level after this; draw w/ geo->lods
+int build_lods(Geometry *geo, int max_lods);
@@ -1,28 +1,153 @@
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "file_io.h"
 #include "geometry.h"
+#include "optimise.h"
+
+
+void print_usage(char* argv_0) {
+    printf("usage: %s [--weld] [--optimise] [--lods N] [--threads N] [--checksum] folder/file.obj\n", argv_0);
+    printf("    --weld        deduplicate (v, vt, vn) corners\n");
+    printf("    --optimise    reorder for the GPU; prints ACMR, ATVR & overdraw before & after\n");
+    printf("    --lods N      build N levels of detail; prints each level's triangles & error\n");
+    printf("    --threads N   parser threads (0 = 1 per core, 1 = serial)\n");
+    printf("    --checksum    print counts & a hash of geo instead of every vertex\n");
+}
+
+
+// FNV-1a over the raw vertex & index arrays
+// NOTE: bitwise; -0.0 != +0.0, any change to parsed floats is caught
+uint64_t checksum_geometry(Geometry *geo) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = fnv1a_64(geo->vertices, sizeof(Vertex) * geo->num_vertices, hash);
+    hash = fnv1a_64(geo->indices, sizeof(uint32_t) * geo->num_indices, hash);
+    return hash;
+}
 
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        printf("usage: %s folder/file.obj\n", argv[0]);
+    ObjOptions options = {.weld = false, .optimise = false, .lods = 0, .num_threads = 0, .stats = NULL, .cancel = NULL};
+    bool checksum = false;
+    char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--weld") == 0) {
+            options.weld = true;
+        } else if (strcmp(argv[i], "--optimise") == 0) {
+            options.optimise = true;
+        } else if (strcmp(argv[i], "--checksum") == 0) {
+            checksum = true;
+        } else if (strcmp(argv[i], "--lods") == 0 && i + 1 < argc) {
+            options.lods = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.num_threads = atoi(argv[++i]);
+        } else if (path == NULL && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL) {
+        print_usage(argv[0]);
         return 1;
     }
 
-    Vertex    vertices[512];
-    uint32_t  indices[512];
+    // NOTE: geo grows into the arena; free_arena releases the whole load
+    Arena arena;
+    init_arena(&arena, 0);
 
     Geometry geo = {
         .num_vertices = 0,
-        .max_vertices = sizeof(vertices) / sizeof(Vertex),
+        .max_vertices = 0,
         .num_indices = 0,
-        .max_indices = sizeof(indices) / sizeof(uint32_t),
-        .vertices = vertices,
-        .indices = indices};
+        .max_indices = 0,
+        .vertices = NULL,
+        .indices = NULL,
+        .arena = &arena,
+        .num_lods = 0};
 
-    if (read_obj(argv[1], &geo) != 0) {
+    if (read_obj_options(path, &options, &geo) != 0) {
         printf("!!! parse failed !!!\n");
+        if (checksum) {
+            free_arena(&arena);
+            return 1;
+        }
+    }
+
+    if (options.weld) {
+        // parse again w/o welding for comparison
+        Arena unwelded_arena;
+        init_arena(&unwelded_arena, 0);
+        Geometry unwelded = {
+            .num_vertices = 0,
+            .max_vertices = 0,
+            .num_indices = 0,
+            .max_indices = 0,
+            .vertices = NULL,
+            .indices = NULL,
+            .arena = &unwelded_arena,
+            .num_lods = 0};
+        ObjOptions unwelded_options = {.weld = false, .num_threads = options.num_threads, .stats = NULL};
+        if (read_obj_options(path, &unwelded_options, &unwelded) != 0) {
+            printf("!!! parse failed (unwelded) !!!\n");
+        }
+        printf("welded: %d -> %d vertices (%.1f%%)\n\n",
+            unwelded.num_vertices, geo.num_vertices,
+            100.0 * geo.num_vertices / (unwelded.num_vertices > 0 ? unwelded.num_vertices : 1));
+        free_arena(&unwelded_arena);
+    }
+
+    if (options.optimise) {
+        // parse again w/o optimising for comparison
+        Arena unoptimised_arena;
+        init_arena(&unoptimised_arena, 0);
+        Geometry unoptimised = {
+            .num_vertices = 0,
+            .max_vertices = 0,
+            .num_indices = 0,
+            .max_indices = 0,
+            .vertices = NULL,
+            .indices = NULL,
+            .arena = &unoptimised_arena,
+            .num_lods = 0};
+        ObjOptions unoptimised_options = {.weld = options.weld, .optimise = false, .num_threads = options.num_threads, .stats = NULL};
+        if (read_obj_options(path, &unoptimised_options, &unoptimised) != 0) {
+            printf("!!! parse failed (unoptimised) !!!\n");
+        }
+        // NOTE: the full mesh only, if there are LODs
+        MeshStats before, after;
+        Geometry full = geometry_lod(&geo, 0);
+        if (analyse_mesh(&unoptimised, VERTEX_CACHE_SIZE, &before) != 0
+         || analyse_mesh(&full, VERTEX_CACHE_SIZE, &after) != 0) {
+            printf("!!! analyse failed !!!\n");
+        }
+        printf("optimised (FIFO %d):\n", VERTEX_CACHE_SIZE);
+        printf("    ACMR     %.3f -> %.3f\n", before.acmr, after.acmr);
+        printf("    ATVR     %.3f -> %.3f\n", before.atvr, after.atvr);
+        printf("    overdraw %.3f -> %.3f\n\n", before.overdraw, after.overdraw);
+        free_arena(&unoptimised_arena);
+    }
+
+    if (geo.num_lods > 0) {
+        printf("LODs:\n");
+        for (int i = 0; i < geo.num_lods; i++) {
+            GeometryLod *lod = &geo.lods[i];
+            printf("    %d: %8d triangles (%5.1f%%), error %g\n", i, lod->num_indices / 3,
+                100.0 * lod->num_indices / geo.lods[0].num_indices, lod->error);
+        }
+        printf("\n");
+    }
+
+    // NOTE: compare runs w/ diff; e.g. --threads 1 vs the default
+    if (checksum) {
+        printf("%s: %d vertices, %d indices, checksum %016llX\n",
+            path, geo.num_vertices, geo.num_indices,
+            (unsigned long long)checksum_geometry(&geo));
+        free_arena(&arena);
+        return 0;
     }
 
     printf("geo = {\n");
@@ -45,9 +170,11 @@ int main(int argc, char* argv[]) {
     };
     printf("\n");
 
-    for (i = 0; i < geo.num_vertices; i++) {
+    // NOTE: welded geo has fewer vertices than indices
+    for (i = 0; i < geo.num_indices; i++) {
         printf("geo.indices[%02d] = %d;\n", i, geo.indices[i]);
     };
 
+    free_arena(&arena);
     return 0;
 }
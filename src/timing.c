@@ -0,0 +1,38 @@
+// Using C23 Standard
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "timing.h"
+
+
+double seconds() {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+void sort_times(double *times, int count) {
+    qsort(times, count, sizeof(double), compare_doubles);
+}
+
+
+double percentile(const double *sorted, int count, double p) {
+    return sorted[(int)(p * (count - 1) + 0.5)];
+}
+
+
+void print_percentiles(const char *name, double *times, int count) {
+    sort_times(times, count);
+    printf("    %-13s p50 %.2f  p90 %.2f  p99 %.2f  max %.2f ms\n", name,
+        percentile(times, count, 0.50), percentile(times, count, 0.90),
+        percentile(times, count, 0.99), times[count - 1]);
+}
@@ -0,0 +1,15 @@
+// Using C23 Standard
+#pragma once
+
+
+// timing helpers for the --headless, --repeat & bench runs
+
+
+// wall clock, in seconds; only differences mean anything
+double seconds();
+// ascending, in place
+void sort_times(double *times, int count);
+// nearest rank; sorted must be in ascending order
+double percentile(const double *sorted, int count, double p);
+// 1 line of p50, p90, p99 & max, in ms; sorts times in place
+void print_percentiles(const char *name, double *times, int count);
@@ -46,7 +46,7 @@ float Vec3_magnitude(Vec3 v) {
 }
 
 
-void normalise_Vec3(Vec3 *v) {
+void Vec3_normalise(Vec3 *v) {
     float magnitude = Vec3_magnitude(*v);
     v->x = v->x / magnitude;
     v->y = v->y / magnitude;
@@ -68,8 +68,8 @@ int rotate(Vec3 *v, int axis, float degrees) {
             break;
         case 1:
             float z = v->z;
+            v->z = z * cos_ - v->x * sin_;  // before v->x changes
             v->x = v->x * cos_ + z * sin_;
-            v->z = z * cos_ + v->x * sin_;
             break;
         case 2:
             float x = v->x;
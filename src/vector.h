@@ -15,6 +15,15 @@ typedef struct Vec3_s {
 } Vec3;
 
 
+// NOTE: 16 byte aligned; 1 SSE register
+typedef struct Vec4_s {
+    alignas(16) float x;
+    float y;
+    float z;
+    float w;
+} Vec4;
+
+
 Vec3 cross(Vec3 a, Vec3 b);
 float dot(Vec3 a, Vec3 b);
 
@@ -26,5 +35,6 @@ float Vec3_sqrmagnitude(Vec3 v);
 float Vec3_magnitude(Vec3 v);
 void Vec3_normalise(Vec3 *v);
 
+// right-handed; axis 0, 1 or 2 is x, y or z
 int rotate(Vec3 *v, int axis, float degrees);
-// TODO: matrix multiplication
+// NOTE: matrices are in matrix.h